@@ -15,39 +15,28 @@
 #include <stdint.h>
 
 
-#define MAX_COMMAND_ARGS 4 ///< każde polecenie zawiera max. 4 argumenty liczbowe
+#define MAX_COMMAND_ARGS 5 ///< każde polecenie zawiera max. 5 argumentów liczbowych
+
+#define GAME_PARAMETERS 4 ///< polecenie tworzące grę zawiera 4 parametry gry
+
+#define BATCH_COMMAND_ARGS 3 ///< polecenie trybu wsadowego zawiera max. 3 argumenty
 
 
 /**
  * Struktura przechowująca jedno polecenie z wejścia.
  */
 typedef struct command {
-	char name; ///< nazwa polecenia, litera ze zbioru {B, I, m, g, b, f, q, p}
-	int args_length; ///< liczba argumentów polecenia, liczba od 0 do 4
+	char name; /**< nazwa polecenia, litera ze zbioru
+ * 				{B, I, M, X, m, g, b, f, q, w, p, e, r, n, d, l, F, Q,
+ * 				s} */
+	int args_length; ///< liczba argumentów polecenia, liczba od 0 do 5
 	uint32_t args[MAX_COMMAND_ARGS]; ///< tablica argumentów liczbowych polecenia
+	uint32_t *list; /**< zaalokowana tablica argumentów polecenia l, które
+ * 				może mieć dowolnie wiele argumentów, lub NULL */
+	size_t list_length; ///< liczba argumentów w tablicy list
 } command_t;
 
 
-/** @brief Inicjalizuje nową planszę dowolnego typu.
- * @param[in] size_of_type 	- rozmiar typu, którego mają być pola planszy,
- * @param[in] width 		- szerokość planszy,
- * @param[in] height 		- wysokość planszy.
- * @return Zainicjalizowana plansza lub NULL, jeśli zabrakło pamięci.
- */
-void** init_board(size_t size_of_type, uint32_t width, uint32_t height);
-
-/** @brief Usuwa planszę.
- * @param[in,out] array - usuwana plansza,
- * @param[in] width 	- szerokość planszy.
- */
-void delete_board(void **array, uint32_t width);
-
-/** @brief Inicjalizuje tablice typu bool na wartość true.
- * @param[in,out] array - tablica, która ma zostać zainicjalizowana,
- * @param[in] size 		- rozmiar tablicy.
- */
-void init_boolean_array(bool *array, uint32_t size);
-
 /** @brief Liczy ilość cyfr liczby.
  * @param[in] num - liczba, której ilość cyfr chcemy policzyć.
  * @return Ilość cyfr liczy, wartość od 0 do 10 (@p UINT_LIMIT).
@@ -59,19 +48,23 @@ int number_of_digits(uint32_t num);
  */
 command_t init_command();
 
-/** @brief Inicjalizuje tablicę dowolnego typu.
- * Alokuje pamięć na tablicę o bazowej długości i wypełnia ją zerami.
- * @param[in] type_size 	- rozmiar typu, którego ma być tablica.
- * @return Zainicjalizowana tablica.
+/** @brief Pomija białe znaki.
+ * @param[in] position 	- wskaźnik na pierwszy sprawdzany znak,
+ * @param[in] end 		- wskaźnik za ostatnim znakiem napisu.
+ * @return Wskaźnik na pierwszy znak niebędący białym znakiem lub @p end.
  */
-void* init_array(size_t type_size);
+const char* skip_white_chars(const char *position, const char *end);
 
-/** @brief Realokuje tablicę znaków.
- * @param[in,out] array 	- tablica, której pamięć ma być realokowana,
- * @param[in,out] length 	- obecna długość tablicy, zwiększana dwukrotnie
- * 							podczas realokacji pamięci.
- * @return Wskaźnik na pamięć, w której znajduje się realokowana tablica znaków.
+/** @brief Konwertuje ciąg cyfr na liczbę.
+ * Czyta wszystkie kolejne cyfry, zaczynając od znaku wskazywanego przez
+ * @p position. Zachowuje się jak funkcja strtoul: pomija wiodące białe znaki,
+ * a po zakończeniu @p position wskazuje na pierwszy znak za ostatnią cyfrą.
+ * @param[in,out] position 	- wskaźnik na wskaźnik na pierwszy czytany znak,
+ * @param[in] end 			- wskaźnik za ostatnim znakiem napisu,
+ * @param[out] value 		- wskaźnik, pod który zostaje zapisana liczba.
+ * @return Wartość @p true, jeśli liczba mieści się w zakresie typu uint32_t
+ * lub @p false w przeciwnym przypadku.
  */
-char* realloc_char_array(char *array, size_t *length);
+bool read_number(const char **position, const char *end, uint32_t *value);
 
 #endif /* MEMORY_AND_INIT_H */
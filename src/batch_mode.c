@@ -10,134 +10,268 @@
 #include <errno.h>
 #include "batch_mode.h"
 #include "auxiliary_functions.h"
+#include "output.h"
+#include "move_log.h"
+#include "spectator.h"
+#include "image.h"
+#include "pipeline.h"
+#include "tokenizer.h"
 
 
-#define BASIC_ARRAY_LENGTH 10 ///< Ustalamy bazową długość tablicy na polecenie
+#define BOARD_BAND_ROWS 64 ///< liczba wierszy planszy wypisywanych naraz, gdy cała plansza nie mieści się w pamięci
 
+#define QUERY_CHUNK_SIZE 4096 ///< rozmiar fragmentu odpowiedzi na polecenie B, F lub Q
 
-bool batch_mode_active = false; /**< Zmienna globalna posiadająca informację czy
- * tryb wsadowy (batch mode) jest uruchomiony. Jest konieczna ponieważ funkcja
- * @ref read_one_line może być wywołana przed uruchomieniem batch mode.
+
+reading_mode_t reading_mode = FIRST_COMMAND_READING; /**< Zmienna globalna
+ * posiadająca informację, w jakim trybie czytane są linijki. Jest konieczna
+ * ponieważ funkcja @ref read_command może być wywołana przed uruchomieniem
+ * batch mode.
  */
 
 
-static command_t parse_command(char *command, size_t length, bool *correct_command);
+static int max_args_in_mode(reading_mode_t mode);
+
+static bool check_number_of_args(command_t command, reading_mode_t mode);
+
+static void select_function_to_call_and_print_answer(command_t command,
+                                                     gamma_t *g, int line,
+                                                     bool quiet);
+
+static void manage_gamma_board_call(char name, gamma_t *g);
 
-static bool check_number_of_args(command_t command);
+static bool print_board_in_bands(gamma_t *g);
 
-static void select_function_to_call_and_print_answer(command_t command, gamma_t *g);
+static void manage_bulk_call(command_t command, gamma_t *g);
 
-static void manage_gamma_board_call(gamma_t *g);
+static char* play_move_list(command_t command, gamma_t *g, size_t *length);
 
-static uint64_t call_function(command_t command, gamma_t *g);
+static bool legal_name_in_game(char c);
 
 static bool legal_name_in_batch(char c);
 
-static bool choose_condition_depending_on_mode(int c);
-
-static void check_char(int c, size_t *i, char **command, size_t *array_length,
-					   bool *prev_was_white_char, bool *error);
-
-
-/** @brief Konwertuje linijkę z wejścia.
- * Funkcja przepisuje daną linijkę (o ile jest prawidłowa)
- * do struktury @ref command_t. Linijka jest prawidłowa jeśli:
- * a) zawiera nie więcej niż 3 wartości liczbowe (@ref MAX_COMMAND_ARGS - 1),
- * b) nieprzekraczające zakresu typu uint32_t.
- * @param[in] command 			- wskaźnik na pamięć zawierającą niepustą
- * 								linijkę z poleceniem,
- * @param[in] length 			- długość linijki zawierającej polecenie,
- * @param[out] correct_command 	- po zakończeniu wykonania funkcji będzie zawierać
- * 								informację czy podana linijka była prawidłowa i
- * 								czy została skonwertowana.
- * @return Struktura zawierająca polecenie do wykonania. Jeśli parsowana linijka
- * została uznana za nieprawidłową - zwracana struktura również jest nieprawidłowa.
+static bool legal_name_in_multi_game(char c);
+
+static bool choose_condition_depending_on_mode(int c, reading_mode_t mode);
+
+static bool check_name(const char *line, size_t length, reading_mode_t mode);
+
+
+/** @brief Podaje maksymalną liczbę argumentów polecenia.
+ * Polecenie trybu wsadowego ma nie więcej niż 3 argumenty
+ * (@ref BATCH_COMMAND_ARGS), w trybie wielu gier nie więcej niż 5
+ * (@ref MAX_COMMAND_ARGS), a pierwsze polecenie nie więcej niż 4
+ * (@ref GAME_PARAMETERS).
+ * @param[in] mode 				- tryb, w którym czytana jest linijka.
+ * @return Maksymalna liczba argumentów.
  */
-command_t parse_command(char *command, size_t length, bool *correct_command) {
-	command_t parsed_command;
-	parsed_command.name = command[0];
-	char *endptr = &command[1];
-	int i = 0;
-	while(i < MAX_COMMAND_ARGS - 1 && *endptr != command[length - 1]) {
-		unsigned long value = strtoul(endptr, &endptr, 10);
-		if(value > UINT32_MAX || errno == ERANGE) {
-			errno = 0;
-			break;
-		}
-		parsed_command.args[i] = (uint32_t)value;
-		i++;
+int max_args_in_mode(reading_mode_t mode) {
+	if(mode == MULTI_GAME_READING) {
+		return MAX_COMMAND_ARGS;
 	}
-	parsed_command.args_length = i;
-	if(*endptr == command[length - 1]) {
-		*correct_command = true;
+	else if(mode == FIRST_COMMAND_READING) {
+		return GAME_PARAMETERS;
 	}
-	return parsed_command;
+	return BATCH_COMMAND_ARGS;
 }
 
 /** @brief Sprawdza poprawność liczby argumentów dla poszczególnych poleceń.
- * @param[in] command 			- struktura zawierająca linijkę z poleceniem.
+ * W trybie wielu gier pierwszym argumentem każdego polecenia jest numer gry.
+ * Polecenie M zadające tryb wielu gier ma jeden argument, a pozostałe
+ * polecenia zadające tryb rozgrywki - parametry gry.
+ * @param[in] command 			- struktura zawierająca linijkę z poleceniem,
+ * @param[in] mode 				- tryb, w którym przeczytano linijkę.
  * @return Wartość @p true, jeśli liczba argumentów dla danego polecenia jest
  * poprawna lub @p false w przeciwnym wypadku.
  */
-bool check_number_of_args(command_t command) {
+bool check_number_of_args(command_t command, reading_mode_t mode) {
+	int game_id_args = (mode == MULTI_GAME_READING ? 1 : 0);
+	if(mode == FIRST_COMMAND_READING) {
+		return command.args_length == (command.name == 'M' ? 1 : GAME_PARAMETERS);
+	}
 	switch(command.name) {
+		case 'n':
+			return game_id_args && command.args_length == 1 + GAME_PARAMETERS;
 		case 'm':
 		case 'g':
-			if(command.args_length == 3) {
-				return true;
-			}
-			break;
+			return command.args_length == game_id_args + 3;
 		case 'b':
 		case 'f':
 		case 'q':
-			if(command.args_length == 1) {
-				return true;
-			}
-			break;
+		case 'w':
+			return command.args_length == game_id_args + 1;
 		case 'p':
-			if(command.args_length == 0) {
-				return true;
-			}
-			break;
+		case 'r':
+			return command.args_length == game_id_args;
+		case 'e':
+			return command.args_length == game_id_args + 2;
+		case 'd':
+			return game_id_args && command.args_length == 1;
+		case 'l':
+			return command.list_length >= 3 && command.list_length % 2 == 1;
+		case 'B':
+		case 'F':
+		case 'Q':
+			return command.args_length == 2;
+		case 's':
+			return command.args_length == 1;
 	}
 	return false;
 }
 
 /** @brief Wywołuje odpowiednią funkcję dla danego polecenia.
+ * W bloku cichym (polecenie s) wykonany ruch m lub g nie ma odpowiedzi,
+ * a odrzucony ma odpowiedź "REJECTED n".
  * @param[in] command 			- struktura zawierająca linijkę z poleceniem,
  * @param[in] g 				- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] line 				- numer linijki z poleceniem,
+ * @param[in] quiet 			- informacja czy linijka należy do bloku
+ * 								cichego.
  */
-void select_function_to_call_and_print_answer(command_t command, gamma_t *g) {
-	if(command.name == 'p') {
-		manage_gamma_board_call(g);
+void select_function_to_call_and_print_answer(command_t command, gamma_t *g,
+                                              int line, bool quiet) {
+	if(command.name == 'p' || command.name == 'r') {
+		manage_gamma_board_call(command.name, g);
+	}
+	else if(player_query(command.name)) {
+		write_player_query(command, g, print_data, NULL);
+	}
+	else if(bulk_command(command.name)) {
+		manage_bulk_call(command, g);
+	}
+	else if(command.name == 'e') {
+		if(!export_image(g, command.args[0], command.args[1], print_data, NULL)) {
+			print_number(0);
+		}
 	}
 	else {
 		uint64_t answer = call_function(command, g);
-		fprintf(stdout, "%lu\n", answer);
+		if(answer) {
+			record_move(g, command.name, command.args[0], command.args[1],
+			            command.args[2]);
+			publish_move(command.name, command.args[0], command.args[1],
+			             command.args[2]);
+		}
+		if(!quiet || (command.name != 'm' && command.name != 'g')) {
+			print_number(answer);
+		}
+		else if(!answer) {
+			print_rejected(line);
+		}
 	}
 }
 
-/** @brief Obsługuje polecenie p wywołujące @ref gamma_board.
+/** @brief Obsługuje polecenie p wywołujące @ref gamma_board lub polecenie r
+ * wywołujące @ref gamma_board_rle.
+ * Jeśli cała plansza nie zmieści się w pamięci lub w limicie pamięci gry,
+ * polecenie p wypisuje ją pasami wierszy.
+ * @param[in] name 				- nazwa polecenia, p lub r,
  * @param[in] g 			 	- wskaźnik na strukturę przechowującą stan gry,
  */
-void manage_gamma_board_call(gamma_t *g) {
-	char *board = gamma_board(g);
+void manage_gamma_board_call(char name, gamma_t *g) {
+	size_t length;
+	char *board = call_board_function(name, g, &length);
 	if(board == NULL) {
-		fprintf(stdout, "0\n");
+		if(name != 'p' || !print_board_in_bands(g)) {
+			print_number(0);
+		}
 	}
 	else {
-		printf("%s", board);
+		print_text(board, length);
 		free(board);
 	}
 }
 
-/** @brief Wywołuje odpowiednią funkcję, zadaną poleceniem z wejścia.
- * Wywołuje jedną z pięciu funkcji z modułu silnika gry, w zależności od
- * wartości pola name w strukturze @ref command_t.
+/** @brief Wypisuje planszę pasami po @ref BOARD_BAND_ROWS wierszy.
+ * Każdy pas jest tworzony przez @ref gamma_board_rows i zwalniany przed
+ * utworzeniem kolejnego, więc naraz w pamięci jest tylko jeden pas.
+ * @param[in] g 			 	- wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli udało się wypisać pierwszy pas lub
+ * @p false w przeciwnym wypadku. Jeśli zabraknie pamięci na któryś
+ * z kolejnych pasów, plansza zostaje ucięta.
+ */
+bool print_board_in_bands(gamma_t *g) {
+	uint32_t height = gamma_height(g);
+	for(uint32_t row = 0; row < height; row += BOARD_BAND_ROWS) {
+		size_t length;
+		char *band = gamma_board_rows(g, row, BOARD_BAND_ROWS, &length);
+		if(band == NULL) {
+			return row != 0;
+		}
+		print_text(band, length);
+		free(band);
+	}
+	return true;
+}
+
+/** @brief Obsługuje polecenie zbiorcze l.
  * @param[in] command 			- struktura zawierająca linijkę z poleceniem,
- * @param[in] g 				- wskaźnik na strukturę przechowującą stan gry.
- * @return Wartość zwrócona przez wywołaną funkcję z modułu silnika gry.
+ * @param[in] g 			 	- wskaźnik na strukturę przechowującą stan gry,
  */
+void manage_bulk_call(command_t command, gamma_t *g) {
+	size_t length;
+	char *answer = call_bulk_function(command, g, &length);
+	if(answer == NULL) {
+		print_number(0);
+	}
+	else {
+		print_text(answer, length);
+		free(answer);
+	}
+}
+
+/** @brief Wykonuje polecenie l, czyli serię ruchów jednego gracza.
+ * Ruchy są wykonywane przez @ref gamma_move_batch w częściach nie dłuższych
+ * niż liczba ruchów do kolejnej sumy kontrolnej dziennika, dzięki czemu
+ * suma kontrolna opisuje stan gry tuż po ruchu, po którym jest zapisana.
+ * @param[in] command 			- struktura zawierająca linijkę z poleceniem,
+ * @param[in] g 			 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] length 			- wskaźnik, pod który zostaje zapisana długość
+ * 								odpowiedzi.
+ * @return Wskaźnik na zaalokowaną odpowiedź: znak 1 dla każdego wykonanego
+ * ruchu i 0 dla odrzuconego, lub NULL, jeśli zabrakło pamięci.
+ */
+char* play_move_list(command_t command, gamma_t *g, size_t *length) {
+	uint32_t player = command.list[0];
+	size_t count = (command.list_length - 1) / 2;
+	gamma_move_t *moves = malloc(count * sizeof(gamma_move_t));
+	uint64_t *results = malloc((count + 63) / 64 * sizeof(uint64_t));
+	char *answer = malloc(count + 1);
+	if(moves == NULL || results == NULL || answer == NULL) {
+		free(moves);
+		free(results);
+		free(answer);
+		return NULL;
+	}
+
+	for(size_t i = 0; i < count; i++) {
+		moves[i] = (gamma_move_t){player, command.list[2 * i + 1],
+		                          command.list[2 * i + 2], false};
+	}
+	size_t done = 0;
+	while(done < count) {
+		size_t part = count - done;
+		if(part > moves_before_checksum()) {
+			part = moves_before_checksum();
+		}
+		gamma_move_batch(g, moves + done, part, results);
+		for(size_t i = 0; i < part; i++) {
+			bool made = (results[i / 64] >> (i % 64)) & 1;
+			answer[done + i] = made ? '1' : '0';
+			if(made) {
+				record_move(g, 'm', player, moves[done + i].x, moves[done + i].y);
+				publish_move('m', player, moves[done + i].x, moves[done + i].y);
+			}
+		}
+		done += part;
+	}
+	answer[count] = '\n';
+	*length = count + 1;
+	free(moves);
+	free(results);
+	return answer;
+}
+
 uint64_t call_function(command_t command, gamma_t *g) {
 	uint32_t *args = command.args;
 	switch(command.name) {
@@ -151,147 +285,216 @@ uint64_t call_function(command_t command, gamma_t *g) {
 			return gamma_free_fields(g, args[0]);
 		case 'q':
 			return gamma_golden_possible(g, args[0]);
+		case 'w':
+			return gamma_next_player_with_move(g, args[0]);
 	}
 	return 0;
 }
 
-/** @brief Sprawdza czy podany znak jest legalną nazwą polecenia.
+bool bulk_command(char name) {
+	return name == 'l';
+}
+
+char* call_bulk_function(command_t command, gamma_t *g, size_t *length) {
+	return play_move_list(command, g, length);
+}
+
+bool player_query(char name) {
+	return name == 'B' || name == 'F' || name == 'Q';
+}
+
+void write_player_query(command_t command, gamma_t *g, image_writer_t *writer,
+                        void *context) {
+	uint64_t first = command.args[0];
+	uint64_t last = command.args[1];
+	if(last > gamma_players(g)) {
+		last = gamma_players(g);
+	}
+
+	char chunk[QUERY_CHUNK_SIZE];
+	size_t position = 0;
+	for(uint64_t player = first; player <= last; player++) {
+		uint64_t value;
+		if(command.name == 'B') {
+			value = gamma_busy_fields(g, (uint32_t)player);
+		}
+		else if(command.name == 'F') {
+			value = gamma_free_fields(g, (uint32_t)player);
+		}
+		else {
+			value = gamma_golden_possible(g, (uint32_t)player);
+		}
+		if(position + UINT64_LIMIT + 2 > QUERY_CHUNK_SIZE) {
+			writer(context, chunk, position);
+			position = 0;
+		}
+		if(player != first) {
+			chunk[position++] = ' ';
+		}
+		position += format_number(chunk + position, value);
+	}
+	chunk[position++] = '\n';
+	writer(context, chunk, position);
+}
+
+bool quiet_line(uint32_t *quiet_lines) {
+	if(*quiet_lines == 0) {
+		return false;
+	}
+	(*quiet_lines)--;
+	return true;
+}
+
+char* call_board_function(char name, gamma_t *g, size_t *length) {
+	if(name == 'r') {
+		return gamma_board_rle(g, length);
+	}
+	char *board = gamma_board(g);
+	if(board != NULL) {
+		*length = strlen(board);
+	}
+	return board;
+}
+
+/** @brief Sprawdza czy podany znak jest nazwą polecenia dotyczącego gry.
  * @param[in] c 		- sprawdzany znak.
- * @return Wartość @p true, jeśli sprawdzany znak jest legalną nazwą polecenia w
- * trybie wsadowym lub @p false w przeciwnym przypadku.
+ * @return Wartość @p true, jeśli sprawdzany znak jest nazwą polecenia
+ * wykonywanego na jednej grze zarówno w trybie wsadowym, jak i w trybie wielu
+ * gier lub @p false w przeciwnym przypadku.
  */
-bool legal_name_in_batch(char c) {
-	if (c == 'm' || c == 'g' || c == 'b' || c == 'f' || c == 'q' || c == 'p') {
+bool legal_name_in_game(char c) {
+	if (c == 'm' || c == 'g' || c == 'b' || c == 'f' || c == 'q' || c == 'p'
+	    || c == 'e' || c == 'r' || c == 'w') {
 		return true;
 	} else {
 		return false;
 	}
 }
 
+/** @brief Sprawdza czy podany znak jest legalną nazwą polecenia.
+ * Polecenia zbiorcze (l, B, F, Q, s) są dostępne tylko w trybie wsadowym.
+ * @param[in] c 		- sprawdzany znak.
+ * @return Wartość @p true, jeśli sprawdzany znak jest legalną nazwą polecenia w
+ * trybie wsadowym lub @p false w przeciwnym przypadku.
+ */
+bool legal_name_in_batch(char c) {
+	return legal_name_in_game(c) || c == 'l' || c == 'B' || c == 'F'
+	       || c == 'Q' || c == 's';
+}
+
+/** @brief Sprawdza czy podany znak jest legalną nazwą polecenia w trybie
+ * wielu gier.
+ * @param[in] c 		- sprawdzany znak.
+ * @return Wartość @p true, jeśli sprawdzany znak jest legalną nazwą polecenia w
+ * trybie wielu gier lub @p false w przeciwnym przypadku.
+ */
+bool legal_name_in_multi_game(char c) {
+	return legal_name_in_game(c) || c == 'n' || c == 'd';
+}
+
 /** @brief Wybiera warunek do sprawdzenia w zależności od trybu.
  *
- * @param[in] c 	- znak, który chcemy sprawdzić pod kątem spełniania warunku.
+ * @param[in] c 	- znak, który chcemy sprawdzić pod kątem spełniania warunku,
+ * @param[in] mode 	- tryb, w którym czytana jest linijka.
  * @return Wartość @p true, jeśli znak spełnia wybrany warunek lub @p false
  * w przeciwnym wypadku.
  */
-bool choose_condition_depending_on_mode(int c) {
-	if(batch_mode_active) {
-		return legal_name_in_batch((char)c);
-	}
-	else {
-		return (c == 'B' || c == 'I');
+bool choose_condition_depending_on_mode(int c, reading_mode_t mode) {
+	switch(mode) {
+		case BATCH_READING:
+			return legal_name_in_batch((char)c);
+		case MULTI_GAME_READING:
+			return legal_name_in_multi_game((char)c);
+		default:
+			return (c == 'B' || c == 'I' || c == 'M' || c == 'X');
 	}
 }
 
-/** @brief Sprawdza znak z wejścia i wpisuje do tablicy, jeśli jest prawidłowy.
- *
- * @param[in] c 				- sprawdzany znak,
- * @param[in,out] i				- wskaźnik na licznik znaków w tablicy,
- * @param[in,out] command		- wskaźnik na tablicę, do której wpisujemy polecenie
- * 								z wejścia,
- * @param[in,out] array_length	- wskaźnik na długość tablicy z poleceniem,
- * @param[in,out] prev_was_white_char - wskaźnik na zmienną zapisującą informację
- * 								czy poprzedni znak z wejścia był biały,
- * @param[out] error			- wskaźnik zapisujący informację czy wczytywana
- * 								linijka z poleceniem jest poprawna lub czy
- * 								wystąpił błąd podczas jej wczytywania.
+/** @brief Sprawdza nazwę polecenia.
+ * Nazwa jest prawidłowa, jeśli pierwszy znak linijki jest poprawną nazwą
+ * polecenia, a drugi (o ile istnieje) jest białym znakiem. Pozostałe znaki
+ * sprawdza @ref tokenize_arguments.
+ * @param[in] line 				- wskaźnik na początek niepustej linijki,
+ * @param[in] length 			- długość linijki,
+ * @param[in] mode 				- tryb, w którym czytana jest linijka.
+ * @return Wartość @p true, jeśli nazwa jest prawidłowa lub @p false
+ * w przeciwnym wypadku.
  */
-void check_char(int c, size_t *i, char **command, size_t *array_length,
-				bool *prev_was_white_char, bool *error) {
-	bool condition = choose_condition_depending_on_mode(c);
-	if((*i == 0 && condition)
-	   || ((*i == 1) && (isspace(c)))
-	   || ((*i > 1) && (isdigit(c) || isspace(c)))) {
-		if(!isspace(c) || !(*prev_was_white_char)) {
-			(*command)[*i] = (char)c;
-			(*i)++;
-		}
-		if(*i >= *array_length) {
-			*command = realloc_char_array(*command, array_length);
-			if(!(*command)) {
-				*error = true;
-				errno = ENOMEM;
-			}
-		}
-		if(isspace(c) && !(*prev_was_white_char)) {
-			*prev_was_white_char = true;
-		}
-		else if(!isspace(c) && *prev_was_white_char) {
-			*prev_was_white_char = false;
-		}
+bool check_name(const char *line, size_t length, reading_mode_t mode) {
+	return choose_condition_depending_on_mode((unsigned char)line[0], mode)
+	       && (length == 1 || isspace((unsigned char)line[1]));
+}
+
+
+line_type_t parse_line(const char *line, size_t length, reading_mode_t mode,
+                       command_t *command) {
+	if(length == 0 || line[0] == '#') {
+		return EMPTY_LINE;
+	}
+	if(!check_name(line, length, mode)) {
+		return INVALID_LINE;
+	}
+	*command = init_command();
+	command->name = line[0];
+	bool correct;
+	if(command->name == 'l') {
+		correct = tokenize_list(line + 1, line + length, &command->list,
+		                        &command->list_length);
 	}
 	else {
-		*error = true;
+		correct = tokenize_arguments(line + 1, line + length,
+		                             max_args_in_mode(mode), command);
+	}
+	if(correct && check_number_of_args(*command, mode)) {
+		return COMMAND_LINE;
 	}
+	free(command->list);
+	command->list = NULL;
+	return INVALID_LINE;
 }
 
-
-char* read_one_line(size_t *command_length, bool *eof, bool *error) {
-	bool prev_was_white_char = false,
-			comment = false,
-			newline = false;
-	char *command = init_array(sizeof(char));
-	if(!command) {
-		errno = ENOMEM;
-		*error = true;
-		return NULL;
+line_type_t read_command(input_t *input, command_t *command, bool *eof) {
+	const char *line = NULL;
+	size_t length = 0;
+	bool terminated = false;
+	if(!next_line(input, &line, &length, &terminated)) {
+		*eof = true;
+		return (errno == ENOMEM ? INVALID_LINE : EMPTY_LINE);
 	}
-	size_t array_length = BASIC_ARRAY_LENGTH;
-	size_t i = 0;
-	int c;
-	*error = false;
-	while(!newline && !(*eof) && errno != ENOMEM) {
-		c = getchar();
-		if(c == EOF) {
-			if(i != 0) {
-				*error = true;
-			}
-			*eof = true;
-		}
-		else if(c == '\n') {
-			newline = true;
-		}
-		else if(c == '#' && i == 0) {
-			comment = true;
+	if(!terminated) {
+		*eof = true;
+		if(length != 0 && line[0] != '#') {
+			return INVALID_LINE;
 		}
-		else if(!comment && !(*error)) {
-			check_char(c, &i, &command, &array_length, &prev_was_white_char, error);
-		}
-	}
-	
-	if(prev_was_white_char) {
-		--i;
 	}
-	command[i] = '\0';
-	*command_length = i + 1;
-	return command;
+	return parse_line(line, length, reading_mode, command);
 }
 
-int batch_mode(gamma_t *g, int counter) {
-	batch_mode_active = true;
-	bool error = false, eof = false;
-	size_t command_length = 0;
-	bool correct_command;
+int batch_mode(gamma_t *g, input_t *input, int counter, bool pipelined) {
+	reading_mode = BATCH_READING;
+	if(pipelined) {
+		return pipelined_batch_mode(g, input, counter);
+	}
+	bool eof = false;
+	uint32_t quiet_lines = 0;
 	command_t parsed_command;
 	while(!eof && errno != ENOMEM) {
-		char *command = read_one_line(&command_length, &eof, &error);
+		line_type_t type = read_command(input, &parsed_command, &eof);
 		counter++;
-		if(error) {
-			fprintf(stderr, "ERROR %d\n", counter);
+		bool quiet = (type != EMPTY_LINE && quiet_line(&quiet_lines));
+		if(type == INVALID_LINE) {
+			print_error(counter);
 		}
-		else if(command[0] != '\0' && command[0] != '#' && !eof) {
-			correct_command = false;
-			parsed_command = parse_command(command, command_length, &correct_command);
-			bool correct_num_of_args = check_number_of_args(parsed_command);
-			if(correct_command && correct_num_of_args) {
-				select_function_to_call_and_print_answer(parsed_command, g);
-			}
-			else {
-				fprintf(stderr, "ERROR %d\n", counter);
-			}
+		else if(type == COMMAND_LINE && parsed_command.name == 's') {
+			quiet_lines = parsed_command.args[0];
+		}
+		else if(type == COMMAND_LINE) {
+			select_function_to_call_and_print_answer(parsed_command, g, counter,
+			                                         quiet);
+			free(parsed_command.list);
 		}
-		free(command);
+		end_of_command();
 	}
+	flush_output();
 	return (errno == ENOMEM);
 }
-
@@ -8,33 +8,136 @@
 #define BATCH_MODE_H
 
 #include "gamma.h"
+#include "input.h"
+#include "auxiliary_functions.h"
+#include "image.h"
 
 
-/** @brief Czyta jedną linijkę z wejścia.
- * Czyta po kolei znaki i zapisuje je w tablicy aż do wystąpienia znaku nowej lini
- * lub pojawienia się błędu.
- * Pomija komentarze oraz białe
- * @param[out] command_length 	- wskaźnik, pod który, na koniec działania
- * 								funkcji zostaje zapisana długość zapisanej linijki,
- * 								w przypadku wykrycia błędu, wartość ta może być
- * 								nieprawidłowa,
- * @param[in,out] eof 			- wskaźnik na zmienną zapisującą informację o
- * 								końcu danych wejściowych,
- * @param[in,out] error 		- wskaźnik na zmienną zapisującą informację o
- * 								błędzie w danych wejściowych, dane wejściowe są
- * 								błędne jeśli:
- * 								a) pierwszy znak nie jest poprawną literą, czyli
- * 								poprawną nazwą polecenia w trybie wsadowym,
- * 								b) któryś z kolejnych znaków nie jest liczbą ani
- * 								białym znakiem.
- * @return Linijka z poleceniem. Prawidłowa linijka z poleceniem zwracana przez
- * funkcję zaczyna się od litery, po której następuje biały znak. Potem
- * następują argumenty liczbowe oddzielone od siebie dokładnie jednym białym
- * znakiem przeczytanym z wejścia. Po ostatnim argumencie występuje jeden znak '\0'.
- * Jeśli w czytanych danych wejściowych wykryto błąd lub wystąpił znak EOF,
- * zwracana linijka również nie będzie prawidłowa.
- */
-char* read_one_line(size_t *command_length, bool *eof, bool *error);
+/**
+ * Tryby, w których mogą być czytane linijki z wejścia. Od trybu zależy zbiór
+ * poprawnych nazw poleceń i liczba ich argumentów.
+ */
+typedef enum reading_mode {
+	FIRST_COMMAND_READING, 	///< czytanie polecenia zadającego tryb rozgrywki
+	BATCH_READING, 			///< czytanie poleceń trybu wsadowego
+	MULTI_GAME_READING 		///< czytanie poleceń trybu wielu gier
+} reading_mode_t;
+
+extern reading_mode_t reading_mode; ///< tryb, w którym czytane są linijki
+
+/**
+ * Rodzaje linijek czytanych w trybie wsadowym.
+ */
+typedef enum line_type {
+	EMPTY_LINE, 	///< pusta linijka lub komentarz, nie wymaga odpowiedzi
+	COMMAND_LINE, 	///< prawidłowe polecenie do wykonania
+	INVALID_LINE 	///< nieprawidłowa linijka, wymaga komunikatu o błędzie
+} line_type_t;
+
+
+/** @brief Konwertuje jedną linijkę z poleceniem.
+ * Sprawdza poprawność znaków linijki, a następnie, jeśli zawiera ona
+ * polecenie, konwertuje ją do struktury @ref command_t i sprawdza liczbę
+ * argumentów. Funkcja nie korzysta ze zmiennej @ref reading_mode, dzięki
+ * czemu może być wywoływana równolegle dla linijek czytanych w różnych
+ * trybach.
+ * @param[in] line 				- wskaźnik na początek linijki zakończonej
+ * 								znakiem nowej linii (bez tego znaku),
+ * @param[in] length 			- długość linijki,
+ * @param[in] mode 				- tryb, w którym czytana jest linijka,
+ * @param[out] command 			- wskaźnik na strukturę, do której zostaje
+ * 								zapisane prawidłowe polecenie.
+ * @return Rodzaj linijki.
+ */
+line_type_t parse_line(const char *line, size_t length, reading_mode_t mode,
+                       command_t *command);
+
+/** @brief Czyta i konwertuje jedną linijkę trybu wsadowego.
+ * Pobiera z bufora wejścia kolejną linijkę (bez kopiowania), a następnie
+ * konwertuje ją za pomocą @ref parse_line w trybie @ref reading_mode.
+ * Linijka niezakończona znakiem nowej linii, która nie jest pusta ani nie
+ * jest komentarzem, jest nieprawidłowa.
+ * @param[in,out] input 		- wskaźnik na strukturę buforowanego wejścia,
+ * @param[out] command 			- wskaźnik na strukturę, do której zostaje
+ * 								zapisane prawidłowe polecenie,
+ * @param[in,out] eof 			- wskaźnik na zmienną zapisującą informację o
+ * 								końcu danych wejściowych.
+ * @return Rodzaj przeczytanej linijki.
+ */
+line_type_t read_command(input_t *input, command_t *command, bool *eof);
+
+/** @brief Wywołuje odpowiednią funkcję, zadaną poleceniem z wejścia.
+ * Wywołuje jedną z sześciu funkcji z modułu silnika gry, w zależności od
+ * wartości pola name w strukturze @ref command_t.
+ * @param[in] command 			- struktura zawierająca linijkę z poleceniem,
+ * @param[in] g 				- wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość zwrócona przez wywołaną funkcję z modułu silnika gry.
+ */
+uint64_t call_function(command_t command, gamma_t *g);
+
+/** @brief Tworzy opis planszy zadany poleceniem p lub r.
+ * Dla polecenia p wywołuje @ref gamma_board, a dla polecenia r
+ * @ref gamma_board_rle.
+ * @param[in] name 				- nazwa polecenia, p lub r,
+ * @param[in] g 				- wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] length 			- wskaźnik, pod który zostaje zapisana długość
+ * 								opisu.
+ * @return Wskaźnik na zaalokowany opis planszy, który należy zwolnić, lub
+ * NULL, jeśli nie udało się go utworzyć.
+ */
+char* call_board_function(char name, gamma_t *g, size_t *length);
+
+/** @brief Sprawdza czy polecenie jest poleceniem zbiorczym.
+ * Odpowiedź na polecenie zbiorcze tworzy @ref call_bulk_function.
+ * @param[in] name 				- nazwa polecenia.
+ * @return Wartość @p true dla polecenia l lub @p false dla pozostałych.
+ */
+bool bulk_command(char name);
+
+/** @brief Wykonuje polecenie zbiorcze.
+ * Polecenie l wykonuje serię ruchów jednego gracza przez
+ * @ref gamma_move_batch, zapisuje wykonane ruchy w dzienniku i publikuje je
+ * obserwatorom. Odpowiedzią jest znak 1 lub 0 dla każdego ruchu, zależnie
+ * od tego, czy został wykonany.
+ * @param[in] command 			- struktura zawierająca linijkę z poleceniem,
+ * @param[in,out] g 			- wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] length 			- wskaźnik, pod który zostaje zapisana długość
+ * 								odpowiedzi.
+ * @return Wskaźnik na zaalokowaną odpowiedź zakończoną znakiem nowej linii,
+ * którą należy zwolnić, lub NULL, jeśli zabrakło pamięci.
+ */
+char* call_bulk_function(command_t command, gamma_t *g, size_t *length);
+
+/** @brief Sprawdza czy polecenie jest zapytaniem o przedział graczy.
+ * Odpowiedź na takie polecenie wypisuje @ref write_player_query.
+ * @param[in] name 				- nazwa polecenia.
+ * @return Wartość @p true dla poleceń B, F i Q lub @p false dla pozostałych.
+ */
+bool player_query(char name);
+
+/** @brief Wypisuje odpowiedź na polecenie B, F lub Q.
+ * Wywołuje @ref gamma_busy_fields, @ref gamma_free_fields lub
+ * @ref gamma_golden_possible dla przedziału graczy obciętego do numerów
+ * istniejących graczy. Wyniki oddzielone spacjami i zakończone znakiem nowej
+ * linii są przekazywane funkcji @p writer we fragmentach stałej długości,
+ * więc odpowiedź nie wymaga pamięci zależnej od długości przedziału.
+ * @param[in] command 			- struktura zawierająca linijkę z poleceniem,
+ * @param[in] g 				- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] writer 			- funkcja zapisująca fragmenty odpowiedzi,
+ * @param[in] context 			- wskaźnik przekazywany do funkcji @p writer.
+ */
+void write_player_query(command_t command, gamma_t *g, image_writer_t *writer,
+                        void *context);
+
+/** @brief Rozpoczyna kolejną linijkę bloku cichego.
+ * Polecenie s n sprawia, że n kolejnych niepustych linijek należy do bloku
+ * cichego, w którym wykonane ruchy m i g nie mają odpowiedzi, a odrzucone
+ * mają odpowiedź "REJECTED n".
+ * @param[in,out] quiet_lines 	- liczba linijek pozostałych w bloku cichym.
+ * @return Wartość @p true, jeśli linijka należy do bloku cichego lub
+ * @p false w przeciwnym wypadku.
+ */
+bool quiet_line(uint32_t *quiet_lines);
 
 /** @brief Obsługuje batch mode (tryb wsadowy).
  * Główna funkcja zajmująca się batch mode. W pętli pobiera kolejne linijki z
@@ -42,10 +145,14 @@ char* read_one_line(size_t *command_length, bool *eof, bool *error);
  * w nich polecenia lub wypisuje informacje o błędzie jeśli są nieprawidłowe.
  * Na koniec działania zwalnia pamięć alokowaną na strukturę @ref gamma_t.
  * @param[in,out] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[in,out] counter 	- licznik przeczytanych linijek z wejścia.
+ * @param[in,out] input 	- wskaźnik na strukturę buforowanego wejścia,
+ * @param[in,out] counter 	- licznik przeczytanych linijek z wejścia,
+ * @param[in] pipelined 	- jeśli ma wartość @p true, czytanie, wykonywanie
+ * 							poleceń i wypisywanie odpowiedzi odbywa się
+ * 							w osobnych wątkach (@ref pipelined_batch_mode).
  * @return Wartość 0, jeśli gra przebiegła prawidłowo lub 1, jeśli wystąpiły błędy
  * np. brak pamięci.
  */
-int batch_mode(gamma_t *g, int counter);
+int batch_mode(gamma_t *g, input_t *input, int counter, bool pipelined);
 
 #endif /* BATCH_MODE_H */
@@ -0,0 +1,144 @@
+/** @file
+ * Implementacja binarnego trybu wsadowego.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "binary_mode.h"
+#include "batch_mode.h"
+#include "output.h"
+#include "move_log.h"
+#include "spectator.h"
+
+
+static uint32_t read_uint32(const unsigned char *bytes);
+
+static void write_uint32(unsigned char *bytes, uint32_t value);
+
+static void write_uint64(unsigned char *bytes, uint64_t value);
+
+static void execute_record(gamma_t *g, const unsigned char *record,
+                           size_t length, uint32_t index);
+
+
+/** @brief Odczytuje liczbę zapisaną w porządku little-endian.
+ * @param[in] bytes 	- wskaźnik na 4 bajty liczby.
+ * @return Odczytana liczba.
+ */
+uint32_t read_uint32(const unsigned char *bytes) {
+	return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8
+	       | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+/** @brief Zapisuje liczbę 32-bitową w porządku little-endian.
+ * @param[out] bytes 	- wskaźnik na 4 bajty, pod które zostaje zapisana liczba,
+ * @param[in] value 	- zapisywana liczba.
+ */
+void write_uint32(unsigned char *bytes, uint32_t value) {
+	for(int i = 0; i < 4; i++) {
+		bytes[i] = (unsigned char)(value >> (8 * i));
+	}
+}
+
+/** @brief Zapisuje liczbę 64-bitową w porządku little-endian.
+ * @param[out] bytes 	- wskaźnik na 8 bajtów, pod które zostaje zapisana liczba,
+ * @param[in] value 	- zapisywana liczba.
+ */
+void write_uint64(unsigned char *bytes, uint64_t value) {
+	for(int i = 0; i < 8; i++) {
+		bytes[i] = (unsigned char)(value >> (8 * i));
+	}
+}
+
+/** @brief Wykonuje polecenie z jednego rekordu i dopisuje odpowiedź.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] record 	- wskaźnik na rekord z poleceniem,
+ * @param[in] length 	- dostępna długość rekordu, mniejsza od
+ * 						@ref BINARY_RECORD_SIZE tylko na końcu danych,
+ * @param[in] index 	- numer rekordu.
+ */
+void execute_record(gamma_t *g, const unsigned char *record, size_t length,
+                    uint32_t index) {
+	unsigned char reply[BINARY_REPLY_SIZE];
+	memset(reply, 0, sizeof(reply));
+	reply[0] = record[0];
+	write_uint32(reply + 4, index);
+	if(length < BINARY_RECORD_SIZE) {
+		reply[1] = BINARY_TRUNCATED;
+		print_text((const char *)reply, sizeof(reply));
+		return;
+	}
+
+	uint32_t player = read_uint32(record + 4),
+	x = read_uint32(record + 8),
+	y = read_uint32(record + 12);
+	uint64_t value = 0;
+	size_t board_length = 0;
+	char *board = NULL;
+	switch(record[0]) {
+		case 'm':
+			value = gamma_move(g, player, x, y);
+			break;
+		case 'g':
+			value = gamma_golden_move(g, player, x, y);
+			break;
+		case 'b':
+			value = gamma_busy_fields(g, player);
+			break;
+		case 'f':
+			value = gamma_free_fields(g, player);
+			break;
+		case 'q':
+			value = gamma_golden_possible(g, player);
+			break;
+		case 'w':
+			value = gamma_next_player_with_move(g, player);
+			break;
+		case 'p':
+		case 'r':
+			board = call_board_function((char)record[0], g,
+			                            &board_length);
+			if(board == NULL) {
+				reply[1] = BINARY_NO_MEMORY;
+			}
+			else {
+				value = board_length;
+			}
+			break;
+		default:
+			reply[1] = BINARY_UNKNOWN_COMMAND;
+	}
+	if(value) {
+		record_move(g, (char)record[0], player, x, y);
+		publish_move((char)record[0], player, x, y);
+	}
+	write_uint64(reply + 8, value);
+	print_text((const char *)reply, sizeof(reply));
+	if(board != NULL) {
+		print_text(board, (size_t)value);
+		free(board);
+	}
+}
+
+
+int binary_mode(gamma_t *g, input_t *input) {
+	const char *data;
+	size_t length;
+	uint32_t index = 0;
+	while(next_records(input, BINARY_RECORD_SIZE, &data, &length)) {
+		const unsigned char *record = (const unsigned char *)data;
+		const unsigned char *end = record + length;
+		while(record < end) {
+			size_t available = (size_t)(end - record);
+			execute_record(g, record, available, index++);
+			record += (available < BINARY_RECORD_SIZE ? available
+			                                          : BINARY_RECORD_SIZE);
+		}
+		end_of_command();
+	}
+	flush_output();
+	return (errno == ENOMEM);
+}
@@ -0,0 +1,59 @@
+/** @file
+ * Interfejs binarnego trybu wsadowego.
+ * Tryb jest wybierany poleceniem X width height players areas. Po nim
+ * (i po potwierdzeniu "OK n") wejście składa się z rekordów o stałym
+ * rozmiarze @ref BINARY_RECORD_SIZE bajtów, zapisanych w porządku
+ * little-endian:
+ * bajt 0       – kod polecenia, jedna z liter m, g, b, f, q, w, p, r,
+ * bajty 1-3    – zarezerwowane,
+ * bajty 4-7    – numer gracza,
+ * bajty 8-11   – współrzędna x,
+ * bajty 12-15  – współrzędna y.
+ * Na każdy rekord program odpowiada rekordem o rozmiarze
+ * @ref BINARY_REPLY_SIZE bajtów:
+ * bajt 0       – kod polecenia,
+ * bajt 1       – status (@ref binary_status_t),
+ * bajty 2-3    – zarezerwowane (zera),
+ * bajty 4-7    – numer rekordu liczony od zera (modulo 2^32),
+ * bajty 8-15   – wartość zwrócona przez funkcję silnika gry.
+ * W odpowiedzi na polecenie p wartością jest długość napisu z planszą,
+ * a sam napis następuje bezpośrednio po rekordzie odpowiedzi. Tak samo
+ * polecenie r przesyła zrzut planszy tworzony przez @ref gamma_board_rle.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef BINARY_MODE_H
+#define BINARY_MODE_H
+
+#include "gamma.h"
+#include "input.h"
+
+
+#define BINARY_RECORD_SIZE 16 ///< rozmiar rekordu z poleceniem w bajtach
+
+#define BINARY_REPLY_SIZE 16 ///< rozmiar rekordu z odpowiedzią w bajtach
+
+
+/**
+ * Statusy odpowiedzi binarnego trybu wsadowego.
+ */
+typedef enum binary_status {
+	BINARY_OK = 0, 				///< polecenie zostało wykonane
+	BINARY_UNKNOWN_COMMAND = 1, ///< nieznany kod polecenia
+	BINARY_TRUNCATED = 2, 		///< niepełny rekord na końcu danych
+	BINARY_NO_MEMORY = 3 		///< zabrakło pamięci na wykonanie polecenia
+} binary_status_t;
+
+
+/** @brief Obsługuje binarny tryb wsadowy.
+ * Przetwarza rekordy bezpośrednio z bufora wejścia, całymi fragmentami,
+ * aż do końca danych.
+ * @param[in,out] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] input 	- wskaźnik na strukturę buforowanego wejścia.
+ * @return Wartość 0, jeśli gra przebiegła prawidłowo lub 1, jeśli wystąpiły
+ * błędy np. brak pamięci.
+ */
+int binary_mode(gamma_t *g, input_t *input);
+
+#endif /* BINARY_MODE_H */
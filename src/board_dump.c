@@ -0,0 +1,142 @@
+/** @file
+ * Implementacja klasy odczytującej zrzuty planszy zakodowane długościami serii.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "board_dump.h"
+#include "input.h"
+#include "output.h"
+#include "auxiliary_functions.h"
+
+
+#define DUMP_MAGIC "GAMMARLE" ///< napis rozpoczynający zrzut planszy
+
+#define DUMP_MAGIC_LENGTH 8 ///< długość napisu rozpoczynającego zrzut planszy
+
+#define CELL_LIMIT 12 ///< maksymalna szerokość pola w wypisywanej planszy
+
+#define ROWS_BUFFER_SIZE (1 << 16) ///< rozmiar bufora wypisywanych wierszy
+
+
+/**
+ * Stan wypisywania odczytanej planszy.
+ */
+typedef struct board_text {
+	size_t cell_width; 		///< szerokość jednego pola
+	size_t length; 			///< liczba zajętych bajtów bufora
+	char data[ROWS_BUFFER_SIZE]; ///< bufor z wypisywanymi wierszami
+} board_text_t;
+
+
+static board_text_t text; ///< stan wypisywania odczytanej planszy
+
+
+static void add_bytes(const char *data, size_t length);
+
+static void add_run(uint32_t owner, uint32_t run);
+
+static bool decode_row(input_t *input, uint32_t width, uint32_t players);
+
+
+/** @brief Dopisuje bajty do bufora wierszy.
+ * Gdy bufor się zapełni, przekazuje go do wypisania.
+ * @param[in] data 		- wskaźnik na dopisywane bajty,
+ * @param[in] length 	- liczba bajtów, nie większa niż rozmiar bufora.
+ */
+void add_bytes(const char *data, size_t length) {
+	if(text.length + length > ROWS_BUFFER_SIZE) {
+		print_text(text.data, text.length);
+		text.length = 0;
+	}
+	memcpy(text.data + text.length, data, length);
+	text.length += length;
+}
+
+/** @brief Dopisuje serię pól jednego gracza.
+ * Pola mają taki sam wygląd jak w napisie tworzonym przez @ref gamma_board.
+ * @param[in] owner 	- numer gracza lub 0 dla wolnych pól,
+ * @param[in] run 		- długość serii.
+ */
+void add_run(uint32_t owner, uint32_t run) {
+	char cell[CELL_LIMIT];
+	size_t length = 1;
+	if(owner == 0) {
+		cell[0] = '.';
+	}
+	else {
+		length = format_number(cell, owner);
+	}
+	memset(cell + length, ' ', text.cell_width - length);
+	for(uint32_t i = 0; i < run; i++) {
+		add_bytes(cell, text.cell_width);
+	}
+}
+
+/** @brief Odczytuje i dopisuje jeden wiersz planszy.
+ * @param[in,out] input - wskaźnik na strukturę wejścia,
+ * @param[in] width 	- szerokość planszy,
+ * @param[in] players 	- liczba graczy.
+ * @return Wartość @p true, jeśli wiersz jest poprawny lub @p false
+ * w przeciwnym wypadku.
+ */
+bool decode_row(input_t *input, uint32_t width, uint32_t players) {
+	uint32_t remaining = width;
+	while(remaining > 0) {
+		uint32_t owner, run;
+		if(!next_uint32(input, &owner) || !next_uint32(input, &run)
+		   || owner > players || run == 0 || run > remaining) {
+			return false;
+		}
+		add_run(owner, run);
+		remaining -= run;
+	}
+	add_bytes("\n", 1);
+	return true;
+}
+
+
+int decode_board_dump(const char *path) {
+	int fd = open(path, O_RDONLY);
+	input_t input;
+	if(fd < 0) {
+		print_error(0);
+		flush_output();
+		return 1;
+	}
+	if(!init_input(&input, fd)) {
+		close(fd);
+		return 1;
+	}
+	bool correct = true;
+	for(int i = 0; i < DUMP_MAGIC_LENGTH && correct; i++) {
+		correct = (next_char(&input) == DUMP_MAGIC[i]);
+	}
+	uint32_t width = 0, height = 0, players = 0;
+	correct = correct && next_uint32(&input, &width)
+	          && next_uint32(&input, &height) && next_uint32(&input, &players)
+	          && width > 0 && height > 0 && players > 0;
+	int digits = number_of_digits(players);
+	text.cell_width = (digits == 1 ? 1 : (size_t)digits + 1);
+	text.length = 0;
+	uint64_t row = 0;
+	while(correct && row < height) {
+		row++;
+		correct = decode_row(&input, width, players);
+	}
+	if(correct && !end_of_input(&input)) {
+		row++;
+		correct = false;
+	}
+	print_text(text.data, text.length);
+	if(!correct) {
+		print_error(row > INT32_MAX ? INT32_MAX : (int)row);
+	}
+	flush_output();
+	close_input(&input);
+	close(fd);
+	return !correct;
+}
@@ -0,0 +1,26 @@
+/** @file
+ * Interfejs klasy odczytującej zrzuty planszy zakodowane długościami serii.
+ * Zrzut jest tworzony przez @ref gamma_board_rle (polecenie r trybu
+ * wsadowego) i ma opisany tam format. Odczytany zrzut jest wypisywany w takiej
+ * samej postaci jak napis tworzony przez @ref gamma_board, bez tworzenia gry,
+ * wiersz po wierszu, więc zajmuje stałą ilość pamięci niezależnie od rozmiaru
+ * planszy.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef BOARD_DUMP_H
+#define BOARD_DUMP_H
+
+
+/** @brief Obsługuje tryb odczytu zrzutu planszy.
+ * Czyta zrzut planszy z pliku i wypisuje planszę na standardowe wyjście.
+ * Jeśli zrzut jest uszkodzony, po wypisanych już wierszach wypisuje komunikat
+ * "ERROR n", gdzie n to numer błędnego wiersza liczony od 1 (nagłówek ma
+ * numer 0, a dane za ostatnim wierszem numer height + 1).
+ * @param[in] path 		- ścieżka pliku ze zrzutem.
+ * @return Wartość 0, jeśli odczytano cały zrzut lub 1 w przeciwnym wypadku.
+ */
+int decode_board_dump(const char *path);
+
+#endif /* BOARD_DUMP_H */
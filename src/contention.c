@@ -0,0 +1,214 @@
+/** @file
+ * Implementacja klasy mierzącej wydajność gry w trybie współbieżnym.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< udostępnia funkcję clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include "contention.h"
+#include "gamma.h"
+#include "output.h"
+
+
+#define BENCHMARK_SIZE 512 ///< bok planszy, na której mierzona jest wydajność
+
+#define BENCHMARK_PLAYERS 4 ///< liczba graczy
+
+#define BENCHMARK_AREAS 32 ///< maksymalna liczba obszarów gracza
+
+#define BENCHMARK_MOVES 1000000 ///< liczba prób ruchów w jednym przebiegu
+
+#define GOLDEN_MOVE_PERIOD 4096 ///< co który ruch jest próbą złotego ruchu
+
+#define MAX_READERS 256 ///< maksymalna liczba wątków czytających
+
+#define LINE_LENGTH 128 ///< maksymalna długość wypisywanej linijki
+
+
+/**
+ * Stan wątku czytającego.
+ */
+typedef struct reader {
+	gamma_t *g; 				///< wskaźnik na odpytywaną grę
+	const atomic_bool *finished; ///< informacja czy ruchy się skończyły
+	uint64_t seed; 				///< stan generatora liczb losowych
+	uint64_t queries; 			///< liczba wykonanych zapytań
+	pthread_t thread; 			///< wątek
+} reader_t;
+
+
+static uint64_t next_random(uint64_t *seed);
+
+static double seconds_since(const struct timespec *start);
+
+static void* reader_thread(void *arg);
+
+static bool run_pass(bool concurrent, uint32_t readers, double *moves,
+                     double *queries);
+
+static void print_pass(const char *mode, uint32_t readers, double moves,
+                       double queries);
+
+
+/** @brief Losuje kolejną liczbę generatorem xorshift.
+ * Każdy wątek ma własny generator, więc wyniki nie zależą od kolejności,
+ * w jakiej wątki dostają procesor.
+ * @param[in,out] seed 	- niezerowy stan generatora.
+ * @return Wylosowana liczba.
+ */
+uint64_t next_random(uint64_t *seed) {
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 7;
+	*seed ^= *seed << 17;
+	return *seed;
+}
+
+/** @brief Liczy czas, który upłynął od zadanej chwili.
+ * @param[in] start 	- chwila początkowa.
+ * @return Liczba sekund.
+ */
+double seconds_since(const struct timespec *start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)(now.tv_sec - start->tv_sec)
+	       + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/** @brief Funkcja wątku czytającego.
+ * Dopóki trwają ruchy, odpytuje grę o losowego gracza, tak jak wątek
+ * monitorujący rozgrywkę.
+ * @param[in,out] arg 	- wskaźnik na stan wątku (@ref reader_t).
+ * @return Wartość NULL.
+ */
+void* reader_thread(void *arg) {
+	reader_t *reader = arg;
+	while(!atomic_load_explicit(reader->finished, memory_order_relaxed)) {
+		uint64_t random = next_random(&reader->seed);
+		uint32_t player = (uint32_t)(random % BENCHMARK_PLAYERS) + 1;
+		switch((random >> 8) % 3) {
+			case 0:
+				gamma_busy_fields(reader->g, player);
+				break;
+			case 1:
+				gamma_free_fields(reader->g, player);
+				break;
+			default:
+				gamma_golden_possible(reader->g, player);
+		}
+		reader->queries++;
+	}
+	return NULL;
+}
+
+/** @brief Wykonuje jeden przebieg pomiaru.
+ * Ruchy wykonuje wątek wywołujący, a czytelnicy działają do ich końca.
+ * Seria ruchów jest w każdym przebiegu taka sama.
+ * @param[in] concurrent 	- informacja czy włączyć tryb współbieżny,
+ * @param[in] readers 		- liczba wątków czytających,
+ * @param[out] moves 		- liczba ruchów na sekundę,
+ * @param[out] queries 		- liczba zapytań czytelników na sekundę.
+ * @return Wartość @p true, jeśli pomiar się udał lub @p false, jeśli
+ * zabrakło pamięci.
+ */
+bool run_pass(bool concurrent, uint32_t readers, double *moves,
+              double *queries) {
+	gamma_t *g = gamma_new(BENCHMARK_SIZE, BENCHMARK_SIZE, BENCHMARK_PLAYERS,
+	                       BENCHMARK_AREAS);
+	reader_t *pool = calloc(readers + 1, sizeof(reader_t));
+	if(g == NULL || pool == NULL
+	   || (concurrent && !gamma_enable_concurrency(g))) {
+		gamma_delete(g);
+		free(pool);
+		return false;
+	}
+
+	atomic_bool finished;
+	atomic_init(&finished, false);
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	uint32_t started = 0;
+	for(uint32_t i = 0; i < readers; i++) {
+		pool[started].g = g;
+		pool[started].finished = &finished;
+		pool[started].seed = 2 * (uint64_t)i + 3;
+		if(pthread_create(&pool[started].thread, NULL, reader_thread,
+		                  &pool[started]) == 0) {
+			started++;
+		}
+	}
+
+	uint64_t seed = 1;
+	for(uint32_t i = 0; i < BENCHMARK_MOVES; i++) {
+		uint64_t random = next_random(&seed);
+		uint32_t player = (uint32_t)(random % BENCHMARK_PLAYERS) + 1;
+		uint32_t x = (uint32_t)(random >> 16) % BENCHMARK_SIZE;
+		uint32_t y = (uint32_t)(random >> 40) % BENCHMARK_SIZE;
+		if(i % GOLDEN_MOVE_PERIOD == GOLDEN_MOVE_PERIOD - 1) {
+			gamma_golden_move(g, player, x, y);
+		}
+		else {
+			gamma_move(g, player, x, y);
+		}
+	}
+	double writer_time = seconds_since(&start);
+	atomic_store(&finished, true);
+
+	uint64_t all_queries = 0;
+	for(uint32_t i = 0; i < started; i++) {
+		pthread_join(pool[i].thread, NULL);
+		all_queries += pool[i].queries;
+	}
+	double time = seconds_since(&start);
+	*moves = BENCHMARK_MOVES / writer_time;
+	*queries = (double)all_queries / time;
+	gamma_delete(g);
+	free(pool);
+	return true;
+}
+
+/** @brief Wypisuje wynik jednego przebiegu.
+ * @param[in] mode 		- opis przebiegu,
+ * @param[in] readers 	- liczba wątków czytających,
+ * @param[in] moves 	- liczba ruchów na sekundę,
+ * @param[in] queries 	- liczba zapytań czytelników na sekundę.
+ */
+void print_pass(const char *mode, uint32_t readers, double moves,
+                double queries) {
+	char line[LINE_LENGTH];
+	int length = snprintf(line, sizeof(line),
+	                      "%s, %u readers: %.0f moves/s, %.0f queries/s\n",
+	                      mode, readers, moves, queries);
+	if(length > 0) {
+		print_text(line, (size_t)length < sizeof(line) ? (size_t)length
+		                                               : sizeof(line) - 1);
+	}
+}
+
+
+int contention_benchmark(uint32_t readers) {
+	if(readers > MAX_READERS) {
+		readers = MAX_READERS;
+	}
+	double moves, queries;
+	bool correct = run_pass(false, 0, &moves, &queries);
+	if(correct) {
+		print_pass("unlocked", 0, moves, queries);
+		correct = run_pass(true, 0, &moves, &queries);
+	}
+	if(correct) {
+		print_pass("locked", 0, moves, queries);
+		correct = run_pass(true, readers, &moves, &queries);
+	}
+	if(correct) {
+		print_pass("locked", readers, moves, queries);
+	}
+	flush_output();
+	return !correct;
+}
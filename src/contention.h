@@ -0,0 +1,27 @@
+/** @file
+ * Interfejs klasy mierzącej wydajność gry w trybie współbieżnym.
+ * Jeden wątek wykonuje losowe ruchy, a pozostałe w tym samym czasie
+ * odpytują tę samą grę o liczby pól i możliwość złotego ruchu, jak wątki
+ * monitorujące rozgrywki (@ref gamma_enable_concurrency).
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef CONTENTION_H
+#define CONTENTION_H
+
+#include <stdint.h>
+
+
+/** @brief Obsługuje tryb pomiaru rywalizacji o zamek gry.
+ * Wykonuje tę samą serię losowych ruchów trzy razy: bez trybu współbieżnego,
+ * w trybie współbieżnym bez czytelników i w trybie współbieżnym z @p readers
+ * wątkami czytającymi. Po każdym przebiegu wypisuje na standardowe wyjście
+ * linijkę z liczbą ruchów na sekundę, a w ostatnim także liczbę zapytań
+ * czytelników na sekundę.
+ * @param[in] readers 	- liczba wątków czytających.
+ * @return Wartość 0, jeśli pomiar się udał lub 1, jeśli zabrakło pamięci.
+ */
+int contention_benchmark(uint32_t readers);
+
+#endif /* CONTENTION_H */
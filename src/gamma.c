@@ -3,23 +3,199 @@
  *
  * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
  */
+
+#define _GNU_SOURCE ///< udostępnia funkcje sysconf i pthread_rwlockattr_setkind_np
  
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <errno.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include "gamma.h"
 #include "queue.h"
+#include "memory.h"
 #include "auxiliary_functions.h"
 
 
 #define UINT_LIMIT 10 ///< Limit długości uint32_t to 10 cyfr (2^32 = 4,294,967,296)
 
+#define RLE_MAGIC "GAMMARLE" ///< napis rozpoczynający zrzut planszy
+
+#define RLE_MAGIC_LENGTH 8 ///< długość napisu rozpoczynającego zrzut planszy
+
+#define RLE_VARINT_LIMIT 10 ///< maksymalna długość liczby w kodowaniu varint
+
+#define RLE_INITIAL_CAPACITY 4096 ///< początkowy rozmiar bufora zrzutu planszy
+
+#define RLE_BAND_ROWS 64 ///< liczba wierszy kodowanych jednocześnie w zrzucie planszy
+
+#define NEIGHBOURS 8 ///< maksymalna liczba sąsiadów pola w dowolnej topologii
+
+#define RING_LENGTH 8 ///< maksymalna liczba pól otaczających pole
+
+/**
+ * Oznacza funkcję wyspecjalizowaną dla topologii planszy. Funkcja dostaje
+ * topologię jako stałą i jest zawsze rozwijana w miejscu wywołania, więc
+ * w każdej z wersji pętli zostaje tylko kod jednej topologii.
+ */
+#define TOPOLOGY_KERNEL static inline __attribute__((always_inline))
+
+#define BASIC_AREAS_CAPACITY 64 ///< bazowy rozmiar tablicy obszarów
+
+#define BASIC_PLAYERS_CAPACITY 16 ///< bazowy rozmiar tablicy stanów graczy
+
+#define PLAYER_HASH_MULTIPLIER UINT64_C(0x9E3779B97F4A7C15) ///< mnożnik haszujący numery graczy
+
+#define NO_PLAYER UINT64_MAX ///< wynik wyszukiwania gracza, gdy takiego gracza nie ma
+
+#define INFLUENCE_CHUNK 4096 ///< liczba pól przetwarzanych naraz przez wątek mapy wpływów
+
+#define MAX_INFLUENCE_THREADS 64 ///< maksymalna liczba wątków liczących mapę wpływów
+
+#define UNREACHED UINT64_MAX ///< stan pola, do którego nie dotarło przeszukiwanie
+
 #define BOARD_SIZE_HARD_LIMIT UINT32_MAX /**< Ustalam limit na łączną liczbę pól
  * planszy na 2*32 - 1 = UIN32_MAX.
  */
 
+/**
+ * Bufor, w którym powstaje zrzut planszy zakodowanej długościami serii.
+ */
+typedef struct rle_buffer {
+	char *data; 		///< zaalokowany bufor
+	size_t length; 		///< liczba zajętych bajtów
+	size_t capacity; 	///< rozmiar bufora
+	memory_t *memory; 	///< liczniki pamięci gry
+} rle_buffer_t;
+
+/**
+ * Pas kolejnych wierszy planszy kodowanych jednocześnie. Plansza jest
+ * przechowywana kolumnami, więc pas jest przeglądany kolumna po kolumnie,
+ * a serie każdego wiersza trafiają do osobnego bufora.
+ */
+typedef struct rle_band {
+	rle_buffer_t rows[RLE_BAND_ROWS]; 	///< zakodowane wiersze pasa, od dolnego
+	uint32_t owners[RLE_BAND_ROWS]; 	///< właściciele bieżących serii wierszy
+	uint32_t starts[RLE_BAND_ROWS]; 	///< początki bieżących serii wierszy
+} rle_band_t;
+
+/**
+ * Obszar na planszy, element tablicy obszarów. Obszary każdego gracza tworzą
+ * listę dwukierunkową, a zwolnione identyfikatory - listę jednokierunkową.
+ */
+typedef struct area {
+	gamma_area_t info; 	/**< statystyki obszaru, rozmiar 0 oznacza
+ * 						zwolniony identyfikator */
+	uint32_t previous; 	///< poprzedni obszar tego samego gracza lub 0
+	uint32_t next; 		/**< następny obszar tego samego gracza, następny
+ * 						zwolniony identyfikator lub 0 */
+} area_t;
+
+/**
+ * Stan gracza, który wykonał już ruch. Stan powstaje przy pierwszym ruchu
+ * gracza. Wcześniej gracz ma stan @ref NEW_PLAYER: nie zajmuje pól, nie ma
+ * obszarów i ma dostępny złoty ruch, więc zawsze może wykonać ruch.
+ */
+typedef struct player {
+	uint64_t busy_fields; 	///< liczba pól zajętych przez gracza
+	uint64_t free_edges; 	///< suma wartości free_edges obszarów gracza
+	uint32_t number; 		///< numer gracza
+	uint32_t areas; 		///< liczba obszarów zajętych przez gracza
+	uint32_t first_area; 	///< identyfikator pierwszego obszaru gracza lub 0
+	bool golden_move_available; /**< informacja czy gracz nie wykorzystał
+ * 							jeszcze złotego ruchu */
+	bool blocked; 			///< informacja, że gracz nie może wykonać ruchu
+} player_t;
+
+/**
+ * Węzeł drzewa przedziałów numerów graczy, którzy nie mogą wykonać ruchu.
+ * Istnieją tylko węzły przedziałów zawierających takich graczy, więc drzewo
+ * zajmuje pamięć proporcjonalną do liczby graczy, którzy wykonali ruch.
+ */
+typedef struct blocked_node {
+	uint32_t children[2]; 	/**< węzły dolnej i górnej połowy przedziału lub
+ * 							0, w zwolnionym węźle children[0] to następny
+ * 							zwolniony węzeł */
+	uint32_t blocked; 		///< liczba graczy z przedziału, którzy nie mogą wykonać ruchu
+} blocked_node_t;
+
+/**
+ * Lista pól, która rośnie w miarę potrzeby.
+ */
+typedef struct field_list {
+	field_t *fields; 	///< tablica z polami
+	size_t length; 		///< liczba pól na liście
+	size_t capacity; 	///< rozmiar tablicy
+	memory_t *memory; 	///< liczniki pamięci gry
+} field_list_t;
+
+/**
+ * Zbiór pól obszaru odwiedzonych przy liczeniu fragmentów obszaru. Jest
+ * tablicą bitów obejmującą prostokąt ograniczający obszar albo, gdy ta
+ * byłaby większa, tablicą haszującą o rozmiarze zależnym od liczby pól
+ * obszaru, co oszczędza pamięć dla obszarów rozciągniętych na dużą część
+ * planszy.
+ */
+typedef struct visited {
+	uint64_t *bits; 		///< tablica bitów lub NULL
+	field_t *fields; 		/**< tablica haszująca pól, wolne miejsca mają
+ * 							współrzędną x równą UINT32_MAX, lub NULL */
+	size_t mask; 			///< rozmiar tablicy haszującej pomniejszony o 1
+	size_t size; 			///< rozmiar zaalokowanej tablicy w bajtach
+	const gamma_area_t *box; ///< statystyki obszaru z jego prostokątem
+} visited_t;
+
+/**
+ * Bariera synchronizująca wątki liczące mapę wpływów. W przeciwieństwie do
+ * pthread_barrier_t liczba wątków może się zmniejszyć, gdy nie uda się
+ * utworzyć któregoś z nich.
+ */
+typedef struct influence_barrier {
+	pthread_mutex_t lock; 	///< zamek chroniący pozostałe pola
+	pthread_cond_t passed; 	///< zmienna warunkowa budzona po przejściu bariery
+	uint32_t count; 		///< liczba wątków, na które czeka bariera
+	uint32_t arrived; 		///< liczba wątków czekających na barierze
+	uint64_t generation; 	///< liczba przejść bariery
+} influence_barrier_t;
+
+struct influence;
+
+/**
+ * Stan jednego wątku liczącego mapę wpływów.
+ */
+typedef struct influence_worker {
+	struct influence *influence; ///< wskaźnik na stan współdzielony przez wątki
+	field_list_t next; 		///< pola osiągnięte przez wątek w bieżącym kroku
+	size_t offset; 			///< miejsce tych pól w następnym froncie
+	pthread_t thread; 		///< wątek
+} influence_worker_t;
+
+/**
+ * Stan obliczania mapy wpływów współdzielony przez wątki.
+ * Stan pola to jego odległość od najbliższego pola gracza w starszych 32
+ * bitach i numer najbliższego gracza (0 przy remisie) w młodszych albo
+ * @ref UNREACHED.
+ */
+typedef struct influence {
+	gamma_t *g; 			///< wskaźnik na strukturę przechowującą stan gry
+	_Atomic uint64_t *states; /**< stany pól, pole (x, y) pod indeksem
+ * 							x * height + y */
+	field_list_t frontier; 	///< pola w odległości level, czyli bieżący front
+	atomic_size_t next_chunk; ///< pierwsza nieprzydzielona część pracy
+	atomic_bool failed; 	///< informacja czy zabrakło pamięci
+	bool started; 			///< informacja czy powstał już pierwszy front
+	bool finished; 			///< informacja czy przeszukiwanie się zakończyło
+	uint32_t level; 		///< odległość pól bieżącego frontu
+	uint32_t *nearest; 		///< wynikowa tablica najbliższych graczy lub NULL
+	uint32_t *distance; 	///< wynikowa tablica odległości lub NULL
+	influence_barrier_t barrier; ///< bariera między krokami przeszukiwania
+	influence_worker_t *workers; ///< stany wątków, wątek 0 to wątek wywołujący
+	uint32_t threads; 		///< liczba wątków
+} influence_t;
+
 /**
  * Implementacja struktury przechowującej stan gry.
  */
@@ -27,96 +203,676 @@ struct gamma {
 	uint32_t **board; 		/**< plansza, zawiera numery graczy, do których
  * 							należą poszczególne pola planszy, bazowo
  * 							wypelniona zerami */
-	uint64_t *busy_fields; 	/**< tablica zawierająca ilość pól zajętych
- * 							przez każdego gracza */
-	uint64_t *free_fields; 	/**< tablica zawierająca ilość pól, na które
- * 							każdy z graczy może postawić pionek w następnym
- * 							normalnym(nie złotym) ruchu */
-	uint32_t *areas; 		/**< tablica zawierająca ilość obaszarow
- * 							zajętych przez każdego z graczy */
-	bool *golden_move_available; /**< tablica zawierająca informację czy
- * 							dany gracz wykorzystał już złoty ruch */
+	player_t *player_list; 	/**< tablica stanów graczy, którzy wykonali
+ * 							ruch, w kolejności ich pierwszych ruchów */
+	uint32_t player_count; 	/**< liczba stanów w tablicy stanów graczy */
+	size_t player_capacity; /**< rozmiar tablicy stanów graczy */
+	uint32_t *player_slots; /**< tablica haszująca numerów graczy, zawiera
+ * 							indeksy w tablicy stanów powiększone o 1 lub 0
+ * 							dla wolnego miejsca */
+	size_t slot_capacity; 	/**< rozmiar tablicy haszującej, potęga dwójki */
+	uint32_t slot_shift; 	/**< przesunięcie iloczynu numeru gracza
+ * 							i @ref PLAYER_HASH_MULTIPLIER dające miejsce
+ * 							w tablicy haszującej */
 	uint64_t all_free_fields; /**< liczba wszystkich wolnych pól na planszy */
 	uint32_t players; 		/**< liczba graczy */
 	uint32_t max_areas; 	/**< maksymalna liczba obszarów należących do
  * 							jednego gracza */
+	gamma_topology_t topology; /**< sposób, w jaki pola planszy sąsiadują
+ * 							ze sobą */
 	uint32_t width; 		/**< szerokość planszy */
 	uint32_t height;		/**< wysokość planszy */
-	
+	queue_t queue; 			/**< kolejka używana przez kolejne przeszukiwania
+ * 							metodą BFS, zachowuje zaalokowaną pamięć */
+	uint32_t **area_ids; 	/**< plansza, zawiera identyfikatory obszarów,
+ * 							do których należą poszczególne pola planszy,
+ * 							0 dla wolnych pól */
+	area_t *area_list; 		/**< tablica obszarów indeksowana ich
+ * 							identyfikatorami, pozycja 0 jest nieużywana */
+	size_t area_capacity; 	/**< rozmiar tablicy obszarów */
+	uint32_t next_area_id; 	/**< najmniejszy identyfikator, który nie był
+ * 							jeszcze używany */
+	uint32_t free_area_id; 	/**< ostatnio zwolniony identyfikator lub 0 */
+	blocked_node_t *blocked_tree; /**< węzły drzewa graczy, którzy nie mogą
+ * 							wykonać ruchu, węzeł 0 jest nieużywany */
+	size_t blocked_capacity; /**< rozmiar tablicy węzłów, wystarcza na ścieżki
+ * 							do wszystkich graczy z tablicy stanów */
+	uint32_t blocked_nodes; /**< liczba użytych węzłów, razem z węzłem 0 */
+	uint32_t free_blocked_node; /**< ostatnio zwolniony węzeł lub 0 */
+	uint32_t blocked_root; 	/**< korzeń drzewa lub 0, jeśli każdy gracz może
+ * 							wykonać ruch */
+	uint32_t player_bits; 	/**< liczba bitów numerów graczy, czyli
+ * 							wysokość drzewa */
+	uint32_t players_with_move; /**< liczba graczy, którzy mogą wykonać ruch */
+	uint32_t players_with_fields; /**< liczba graczy, którzy zajmują co
+ * 							najmniej jedno pole */
+	pthread_rwlock_t *lock; /**< zamek chroniący stan gry w trybie
+ * 							współbieżnym lub NULL, jeśli tryb nie jest
+ * 							włączony */
+	memory_t *memory; 		/**< liczniki pamięci gry, zmieniane także przez
+ * 							funkcje czytające stan gry */
 };
 
+/**
+ * Stan gracza, który nie wykonał jeszcze ruchu.
+ */
+static const player_t NEW_PLAYER = {0, 0, 0, 0, 0, true, false};
+
+
+/** @name Funkcje obsługujące tryb współbieżny
+ * Po wywołaniu @ref gamma_enable_concurrency funkcje odczytujące stan gry
+ * zajmują zamek do odczytu, a funkcje wykonujące ruchy - do zapisu, i pod nim
+ * wywołują @ref take_free_field lub @ref take_busy_field. Bez tego trybu
+ * funkcje obsługujące zamek nic nie robią.
+ */
+///@{
+static void lock_for_reading(const gamma_t *g);
+
+static void lock_for_writing(gamma_t *g);
+
+static void unlock_game(const gamma_t *g);
+
+static bool take_free_field(gamma_t *g, uint32_t player, uint32_t x,
+                            uint32_t y);
+
+static bool take_busy_field(gamma_t *g, uint32_t player, uint32_t x,
+                            uint32_t y);
+///@}
+
+
+/** @name Funkcje alokujące pamięć gry
+ * Cała pamięć gry jest alokowana przez funkcje z modułu @ref memory.h,
+ * które liczą jej zużycie, pilnują limitu pamięci gry i biorą ją z alokatora
+ * lub areny podanych przy tworzeniu gry.
+ */
+///@{
+static uint32_t** new_board(gamma_t *g);
+
+static void delete_board(gamma_t *g, uint32_t **board);
+
+static bool grow_player_slots(gamma_t *g);
+
+static bool reserve_players(gamma_t *g);
+///@}
+
+
+/** @name Funkcje obsługujące stany graczy
+ * Stany graczy są przechowywane tylko dla graczy, którzy wykonali ruch,
+ * i wyszukiwane po numerze w tablicy haszującej z adresowaniem liniowym,
+ * więc pamięć gry nie zależy od liczby graczy podanej przy jej tworzeniu.
+ */
+///@{
+static size_t player_slot(const gamma_t *g, uint32_t number);
+
+static player_t* find_player(const gamma_t *g, uint32_t number);
+
+static const player_t* player_state(const gamma_t *g, uint32_t number);
+
+static void insert_player_slot(gamma_t *g, uint32_t index);
+
+static player_t* add_player(gamma_t *g, uint32_t number);
+
+static int compare_player_numbers(const void *first, const void *second);
+///@}
+
 
 /** @name Funkcje zajmujące się polami
  * Funkcje sprawdzające sąsiądów pola, dostępność zajętych pól i liczące ilość
  * wolnych pól.
  */
 ///@{
-static bool busy_fields_available(uint64_t *busy_fields, uint32_t num_of_players,
-                                    uint32_t player);
+TOPOLOGY_KERNEL bool player_fields_around(const gamma_t *g,
+                                          gamma_topology_t topology,
+                                          uint32_t player, uint32_t x,
+                                          uint32_t y);
 
-static bool player_fields_around(gamma_t *g, uint32_t player, uint32_t x,
-									uint32_t y);
+TOPOLOGY_KERNEL uint64_t count_free_fields_kernel(const gamma_t *g,
+                                                  gamma_topology_t topology,
+                                                  uint32_t player);
 
-static uint64_t count_free_fields(gamma_t *g, uint32_t player);
+static uint64_t count_free_fields(const gamma_t *g, uint32_t player);
 ///@}
 
 
-/** @name Funkcje wykorzystywane przy liczeniu ilości sąsiednich obszarów
+/** @name Funkcje wyznaczające sąsiadów pola
+ * Każda topologia ma własną funkcję wyznaczającą sąsiadów. Pętle
+ * przeszukujące planszę są pisane jako funkcje @ref TOPOLOGY_KERNEL
+ * z topologią jako parametrem i wywoływane z instrukcji switch, która wybiera
+ * topologię raz, przed pętlą.
+ */
+///@{
+TOPOLOGY_KERNEL int square_fields_around(const gamma_t *g, uint32_t x,
+                                         uint32_t y,
+                                         field_t around[NEIGHBOURS]);
+
+TOPOLOGY_KERNEL int diagonal_fields_around(const gamma_t *g, uint32_t x,
+                                           uint32_t y,
+                                           field_t around[NEIGHBOURS]);
+
+TOPOLOGY_KERNEL int hex_fields_around(const gamma_t *g, uint32_t x, uint32_t y,
+                                      field_t around[NEIGHBOURS]);
+
+TOPOLOGY_KERNEL int torus_fields_around(const gamma_t *g, uint32_t x,
+                                        uint32_t y,
+                                        field_t around[NEIGHBOURS]);
+
+TOPOLOGY_KERNEL int topology_fields_around(const gamma_t *g,
+                                           gamma_topology_t topology,
+                                           uint32_t x, uint32_t y,
+                                           field_t around[NEIGHBOURS]);
+
+TOPOLOGY_KERNEL uint32_t topology_free_fields_around(const gamma_t *g,
+                                                     gamma_topology_t topology,
+                                                     uint32_t x, uint32_t y);
+
+static int fields_around(const gamma_t *g, uint32_t x, uint32_t y,
+                         field_t around[NEIGHBOURS]);
+
+static uint32_t free_fields_around(const gamma_t *g, uint32_t x, uint32_t y);
+///@}
+
+
+/** @name Funkcje zarządzające obszarami
  * Grupa funkcji używanych w @ref gamma_move i @ref gamma_golden_move do
- * wyznaczenia liczby obszarów z jakimi sąsiaduje dane pole.
+ * utrzymywania identyfikatorów i statystyk obszarów. Ruch łączy obszary,
+ * z którymi sąsiaduje pole, przepisując identyfikatory mniejszych obszarów na
+ * identyfikator największego, a złoty ruch dzieli obszar poprzedniego
+ * właściciela pola, przeszukując go metodą BFS.
+ */
+///@{
+static bool reserve_areas(gamma_t *g, uint32_t count);
+
+static uint32_t new_area(gamma_t *g, uint32_t owner);
+
+static void release_area(gamma_t *g, uint32_t id);
+
+static void add_field_to_area(gamma_t *g, uint32_t id, uint32_t x, uint32_t y,
+                              uint32_t free_edges);
+
+TOPOLOGY_KERNEL void relabel_area_kernel(gamma_t *g, gamma_topology_t topology,
+                                         field_t start, uint32_t from,
+                                         uint32_t to, bool measure);
+
+static void relabel_area(gamma_t *g, field_t start, uint32_t from, uint32_t to,
+                         bool measure);
+
+static void merge_areas(gamma_t *g, field_t start, uint32_t from, uint32_t to);
+
+static int adjacent_areas(const gamma_t *g, uint32_t player, uint32_t x,
+                          uint32_t y, uint32_t ids[NEIGHBOURS],
+                          field_t seeds[NEIGHBOURS]);
+
+static bool reserve_occupation(gamma_t *g, const uint32_t ids[NEIGHBOURS],
+                               int count);
+
+static void occupy_field(gamma_t *g, uint32_t player, uint32_t x, uint32_t y,
+                         const uint32_t ids[NEIGHBOURS],
+                         const field_t seeds[NEIGHBOURS], int count,
+                         bool was_free);
+
+static int split_area(gamma_t *g, uint32_t x, uint32_t y,
+                      uint32_t pieces[NEIGHBOURS], field_t seeds[NEIGHBOURS]);
+
+static void join_pieces(gamma_t *g, uint32_t x, uint32_t y, uint32_t whole,
+                        const uint32_t pieces[NEIGHBOURS],
+                        const field_t seeds[NEIGHBOURS], int count);
+///@}
+
+
+/** @name Funkcje przewidujące skutek ruchu
+ * Funkcje używane przez @ref gamma_try_move i @ref gamma_try_golden_move.
+ * Nie zmieniają stanu gry, więc wiele wątków może jednocześnie sprawdzać
+ * ruchy w tej samej pozycji.
+ */
+///@{
+static bool in_area(const gamma_t *g, uint32_t x, uint32_t y, int dx, int dy,
+                    uint32_t area);
+
+static bool ring_linked(const gamma_t *g, uint32_t x, uint32_t y,
+                        uint32_t area);
+
+static int area_neighbours(const gamma_t *g, uint32_t x, uint32_t y,
+                           field_t seeds[NEIGHBOURS], bool *linked);
+
+static bool init_visited(const gamma_t *g, uint32_t area, visited_t *visited);
+
+static bool mark_visited(visited_t *visited, field_t field);
+
+TOPOLOGY_KERNEL bool search_pieces(const gamma_t *g, gamma_topology_t topology,
+                                   uint32_t area, visited_t *visited,
+                                   const field_t *seeds, int count,
+                                   int *pieces);
+
+static bool count_pieces(const gamma_t *g, uint32_t x, uint32_t y,
+                         int *pieces);
+///@}
+
+
+/** @name Funkcje śledzące graczy, którzy mogą wykonać ruch
+ * Gracz może wykonać ruch, jeśli @ref gamma_free_fields daje dla niego
+ * wartość dodatnią lub @ref gamma_golden_possible daje @p true. Po każdym
+ * ruchu sprawdzani są tylko gracze, których ten ruch dotyczy: wykonujący
+ * ruch, poprzedni właściciel pola i właściciele pól sąsiednich. Wszyscy
+ * gracze są sprawdzani od nowa tylko wtedy, gdy zajmą się ostatnie wolne
+ * pole albo pola zajmuje po ruchu lub zajmował przed nim co najwyżej jeden
+ * gracz, bo tylko wtedy zmienia się dostępność złotego ruchu dla graczy
+ * niebiorących udziału w ruchu.
+ */
+///@{
+static bool player_can_move(const gamma_t *g, const player_t *state);
+
+static uint32_t new_blocked_node(gamma_t *g);
+
+static void block_player(gamma_t *g, uint32_t number);
+
+static void unblock_player(gamma_t *g, uint32_t number);
+
+static void update_blocked(gamma_t *g, player_t *state, bool can_move);
+
+static void refresh_player(gamma_t *g, uint32_t player);
+
+static void refresh_all_players(gamma_t *g);
+
+static void refresh_players_after_move(gamma_t *g, uint32_t player,
+                                       uint32_t owner, uint32_t x, uint32_t y,
+                                       uint32_t players_with_fields);
+
+static uint64_t first_unblocked(const gamma_t *g, uint32_t node,
+                                uint32_t level, uint64_t base, uint64_t from);
+///@}
+
+
+/** @name Funkcje obliczające mapę wpływów
+ * Używane w @ref gamma_influence_map. Przeszukiwanie BFS zaczyna się
+ * jednocześnie od wszystkich pól graczy i przebiega przez wolne pola, krokami
+ * o jedno pole. Pola bieżącego frontu są dzielone na części, które kolejne
+ * wątki pobierają ze wspólnego licznika, a między krokami wątki czekają na
+ * barierze.
  */
 ///@{
-static void add_to_queue(gamma_t *g, bool **visited, queue_t *queue,
-			field_t *field, uint32_t player, uint32_t *coordinate, int factor);
+static void init_influence_barrier(influence_barrier_t *barrier, uint32_t count);
+
+static void wait_influence_barrier(influence_barrier_t *barrier);
+
+static void leave_influence_barrier(influence_barrier_t *barrier);
+
+static bool push_field(field_list_t *list, field_t field);
+
+static size_t next_influence_chunk(influence_t *influence, size_t total);
 
-static void add_to_queue_fields_around(gamma_t *g, bool **visited,
-								queue_t *queue, field_t field, uint32_t player);
+TOPOLOGY_KERNEL void init_influence_sources_kernel(influence_worker_t *worker,
+                                                  gamma_topology_t topology);
 
-static void make_BFS(gamma_t *g, uint32_t player, bool **visited,
-                     field_t field);
+static void init_influence_sources(influence_worker_t *worker);
 
-static bool is_another_area(gamma_t *g, bool **visited, field_t *field,
-                            uint32_t player, uint32_t *coordinate, int factor);
+static void reach_field(influence_worker_t *worker, field_t field,
+                        uint64_t state);
 
-static int number_of_connected_areas(gamma_t *g, uint32_t player, uint32_t x,
-                                     uint32_t y);
+TOPOLOGY_KERNEL void expand_frontier_kernel(influence_worker_t *worker,
+                                           gamma_topology_t topology);
 
-static int number_of_split_areas(gamma_t *g, uint32_t owner, uint32_t x,
-                                 uint32_t y);
+static void expand_frontier(influence_worker_t *worker);
+
+static bool gather_frontier(influence_t *influence);
+
+static void write_influence(influence_worker_t *worker);
+
+static void* influence_thread(void *arg);
+
+static bool count_territory(influence_t *influence,
+                            gamma_territory_t **territory, uint32_t *count);
+
+static int compare_territories(const void *first, const void *second);
 ///@}
 
 
 /** @name Funkcje używane przy tworzeniu bufora ze stanem planszy
- * Używane w @ref gamma_board.
+ * Używane w @ref gamma_board, @ref gamma_board_rows i @ref gamma_board_rle.
+ * Tworzone bufory liczą się do pamięci gry do chwili, w której zostają
+ * przekazane wywołującemu.
  */
 ///@{
-static char* board_for_multiple_digits_players(gamma_t *g, size_t max_num_of_digits);
+static char* board_rows(gamma_t *g, uint32_t first_row, uint32_t rows,
+                        size_t *length);
+
+static bool reserve_rle_buffer(rle_buffer_t *buffer, size_t length);
 
-static char* standard_board(gamma_t *g);
+static bool append_rle_number(rle_buffer_t *buffer, uint64_t number);
+
+static bool encode_rle_band(gamma_t *g, rle_band_t *band, uint32_t bottom,
+                            uint32_t rows);
 ///@}
 
 
-/** @brief Sprawdza czy isnieją pola zejęte przez innych garczy.
-* Funkcja pomocnicza dla funkcji @ref gamma_golden_possible, sprawdzająca czy
-		* istnieje choć jedno pole zajęte przez innego gracza.
-* @param[in] busy_fields 	 - zawiera informacje ile pól zajęli poszczególni gracze,
-* @param[in] num_of_players  - łączna liczba graczy,
-* @param[in] player 		 - numer gracza, na rzecz którego dokonywane jest sprawdzenie.
-* @return Wartość @p true, jeśli istnieje choć jedno pole zajęte przez innego
-* gracza lub @p false, gdy takich pól nie ma.
-*/
-bool busy_fields_available(uint64_t *busy_fields, uint32_t num_of_players,
-                           uint32_t player) {
-	for(unsigned int i = 1; i <= num_of_players; i++) {
-		if(busy_fields[i] != 0 && i != player) {
-			return true;
+/** @brief Alokuje planszę wypełnioną zerami.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry
+ * 						z ustalonymi wymiarami planszy.
+ * @return Wskaźnik na tablicę kolumn planszy lub NULL, jeśli zabrakło
+ * pamięci.
+ */
+uint32_t** new_board(gamma_t *g) {
+	uint32_t **board = allocate_memory(g->memory, GAMMA_MEMORY_BOARD,
+	                                   (size_t)g->width * sizeof(uint32_t *),
+	                                   true);
+	if(!board) {
+		return NULL;
+	}
+	for(uint32_t i = 0; i < g->width; i++) {
+		board[i] = allocate_memory(g->memory, GAMMA_MEMORY_BOARD,
+		                           (size_t)g->height * sizeof(uint32_t), true);
+		if(!board[i]) {
+			delete_board(g, board);
+			return NULL;
+		}
+	}
+	return board;
+}
+
+/** @brief Zwalnia planszę.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] board 	- plansza z @ref new_board, być może zaalokowana
+ * 						tylko częściowo, lub NULL.
+ */
+void delete_board(gamma_t *g, uint32_t **board) {
+	if(board) {
+		for(uint32_t i = 0; i < g->width && board[i]; i++) {
+			release_memory(g->memory, GAMMA_MEMORY_BOARD, board[i],
+			               (size_t)g->height * sizeof(uint32_t));
 		}
+		release_memory(g->memory, GAMMA_MEMORY_BOARD, board,
+		               (size_t)g->width * sizeof(uint32_t *));
 	}
-	return false;
 }
 
+/** @brief Powiększa dwukrotnie tablicę haszującą numerów graczy.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli udało się powiększyć tablicę lub @p false,
+ * jeśli zabrakło pamięci.
+ */
+bool grow_player_slots(gamma_t *g) {
+	size_t capacity = g->slot_capacity ? 2 * g->slot_capacity
+	                                   : 2 * BASIC_PLAYERS_CAPACITY;
+	uint32_t *slots = allocate_memory(g->memory, GAMMA_MEMORY_PLAYERS,
+	                                  capacity * sizeof(uint32_t), true);
+	if(!slots) {
+		return false;
+	}
+	release_memory(g->memory, GAMMA_MEMORY_PLAYERS, g->player_slots,
+	               g->slot_capacity * sizeof(uint32_t));
+	g->player_slots = slots;
+	g->slot_capacity = capacity;
+	g->slot_shift = 64;
+	for(size_t i = capacity; i > 1; i /= 2) {
+		(g->slot_shift)--;
+	}
+	for(uint32_t i = 1; i <= g->player_count; i++) {
+		insert_player_slot(g, i);
+	}
+	return true;
+}
+
+/** @brief Zapewnia miejsce na stan jeszcze jednego gracza.
+ * Powiększa tablicę stanów, tablicę haszującą i tablicę węzłów drzewa
+ * graczy, którzy nie mogą wykonać ruchu, tak aby uaktualnianie drzewa po
+ * ruchu nigdy nie alokowało pamięci.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli jest miejsce lub @p false, jeśli zabrakło
+ * pamięci.
+ */
+bool reserve_players(gamma_t *g) {
+	size_t count = (size_t)g->player_count + 1;
+	if(count > g->player_capacity) {
+		size_t capacity = g->player_capacity ? 2 * g->player_capacity
+		                                     : BASIC_PLAYERS_CAPACITY;
+		player_t *player_list = resize_memory(g->memory, GAMMA_MEMORY_PLAYERS,
+		                                      g->player_list,
+		                                      g->player_capacity
+		                                      * sizeof(player_t),
+		                                      capacity * sizeof(player_t));
+		if(!player_list) {
+			return false;
+		}
+		g->player_list = player_list;
+		g->player_capacity = capacity;
+	}
+
+	size_t nodes = 1 + count * ((size_t)g->player_bits + 1);
+	if(nodes > g->blocked_capacity) {
+		size_t capacity = 2 * nodes;
+		blocked_node_t *tree = resize_memory(g->memory, GAMMA_MEMORY_PLAYERS,
+		                                     g->blocked_tree,
+		                                     g->blocked_capacity
+		                                     * sizeof(blocked_node_t),
+		                                     capacity * sizeof(blocked_node_t));
+		if(!tree) {
+			return false;
+		}
+		g->blocked_tree = tree;
+		g->blocked_capacity = capacity;
+	}
+
+	return 2 * count <= g->slot_capacity || grow_player_slots(g);
+}
+
+/** @brief Wyznacza miejsce gracza w tablicy haszującej.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry
+ * 						z zaalokowaną tablicą haszującą,
+ * @param[in] number 	- numer gracza.
+ * @return Pierwsze miejsce, od którego gracz jest szukany w tablicy.
+ */
+size_t player_slot(const gamma_t *g, uint32_t number) {
+	return (size_t)((number * PLAYER_HASH_MULTIPLIER) >> g->slot_shift);
+}
+
+/** @brief Wyszukuje stan gracza.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] number 	- numer gracza.
+ * @return Wskaźnik na stan gracza lub NULL, jeśli gracz nie wykonał jeszcze
+ * ruchu.
+ */
+player_t* find_player(const gamma_t *g, uint32_t number) {
+	if(g->player_slots == NULL) {
+		return NULL;
+	}
+	size_t mask = g->slot_capacity - 1;
+	for(size_t i = player_slot(g, number); g->player_slots[i] != 0;
+	    i = (i + 1) & mask) {
+		player_t *state = &g->player_list[g->player_slots[i] - 1];
+		if(state->number == number) {
+			return state;
+		}
+	}
+	return NULL;
+}
+
+/** @brief Podaje stan gracza do odczytu.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] number 	- numer gracza.
+ * @return Wskaźnik na stan gracza lub na @ref NEW_PLAYER, jeśli gracz nie
+ * wykonał jeszcze ruchu.
+ */
+const player_t* player_state(const gamma_t *g, uint32_t number) {
+	const player_t *state = find_player(g, number);
+	return state != NULL ? state : &NEW_PLAYER;
+}
+
+/** @brief Wpisuje stan gracza do tablicy haszującej.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] index 	- indeks stanu w tablicy stanów powiększony o 1.
+ */
+void insert_player_slot(gamma_t *g, uint32_t index) {
+	size_t mask = g->slot_capacity - 1;
+	size_t i = player_slot(g, g->player_list[index - 1].number);
+	while(g->player_slots[i] != 0) {
+		i = (i + 1) & mask;
+	}
+	g->player_slots[i] = index;
+}
+
+/** @brief Podaje stan gracza do zmiany, tworząc go w razie potrzeby.
+ * Utworzenie stanu może przenieść tablicę stanów, więc wcześniej pobrane
+ * wskaźniki na stany innych graczy tracą ważność.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] number 	- poprawny numer gracza.
+ * @return Wskaźnik na stan gracza lub NULL, jeśli zabrakło pamięci.
+ */
+player_t* add_player(gamma_t *g, uint32_t number) {
+	player_t *state = find_player(g, number);
+	if(state != NULL) {
+		return state;
+	}
+	if(!reserve_players(g)) {
+		errno = 0;
+		return NULL;
+	}
+	state = &g->player_list[(g->player_count)++];
+	*state = NEW_PLAYER;
+	state->number = number;
+	insert_player_slot(g, g->player_count);
+	return state;
+}
+
+/** @brief Porównuje numery graczy.
+ * Używana do sortowania numerów funkcją qsort.
+ * @param[in] first 	- wskaźnik na pierwszy numer,
+ * @param[in] second 	- wskaźnik na drugi numer.
+ * @return Liczba ujemna, zero lub liczba dodatnia, zależnie od tego, czy
+ * pierwszy numer jest mniejszy, równy czy większy od drugiego.
+ */
+int compare_player_numbers(const void *first, const void *second) {
+	uint32_t a = *(const uint32_t*)first;
+	uint32_t b = *(const uint32_t*)second;
+	return (a > b) - (a < b);
+}
+
+/** @brief Zajmuje zamek gry do odczytu, jeśli tryb współbieżny jest włączony.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry.
+ */
+void lock_for_reading(const gamma_t *g) {
+	if(g->lock != NULL) {
+		pthread_rwlock_rdlock(g->lock);
+	}
+}
+
+/** @brief Zajmuje zamek gry do zapisu, jeśli tryb współbieżny jest włączony.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry.
+ */
+void lock_for_writing(gamma_t *g) {
+	if(g->lock != NULL) {
+		pthread_rwlock_wrlock(g->lock);
+	}
+}
+
+/** @brief Zwalnia zamek gry, jeśli tryb współbieżny jest włączony.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry.
+ */
+void unlock_game(const gamma_t *g) {
+	if(g->lock != NULL) {
+		pthread_rwlock_unlock(g->lock);
+	}
+}
+
+/** @brief Wykonuje zwykły ruch na poprawnym polu.
+ * Wywoływana przez @ref gamma_move po sprawdzeniu parametrów i zajęciu
+ * zamka.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player 	- poprawny numer gracza,
+ * @param[in] x 		- współrzędna pozioma pola leżącego na planszy,
+ * @param[in] y 		- współrzędna pionowa pola leżącego na planszy.
+ * @return Wartość @p true, jeśli ruch został wykonany lub @p false, jeśli
+ * jest nielegalny lub zabrakło pamięci.
+ */
+bool take_free_field(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+	if(g->board[x][y] != 0) {
+		return false;
+	}
+
+	uint32_t ids[NEIGHBOURS];
+	field_t seeds[NEIGHBOURS];
+	int connected_areas = adjacent_areas(g, player, x, y, ids, seeds);
+	if((connected_areas == 0 && player_state(g, player)->areas == g->max_areas)
+		|| !reserve_occupation(g, ids, connected_areas)) {
+		return false;
+	}
+	player_t *state = add_player(g, player);
+	if(state == NULL) {
+		return false;
+	}
+	uint32_t players_with_fields = g->players_with_fields;
+	occupy_field(g, player, x, y, ids, seeds, connected_areas, true);
+	if((state->busy_fields)++ == 0) {
+		(g->players_with_fields)++;
+	}
+	(g->all_free_fields)--;
+	refresh_players_after_move(g, player, 0, x, y, players_with_fields);
+	return true;
+}
+
+/** @brief Wykonuje złoty ruch na poprawnym polu.
+ * Wywoływana przez @ref gamma_golden_move po sprawdzeniu parametrów
+ * i zajęciu zamka.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player 	- poprawny numer gracza,
+ * @param[in] x 		- współrzędna pozioma pola leżącego na planszy,
+ * @param[in] y 		- współrzędna pionowa pola leżącego na planszy.
+ * @return Wartość @p true, jeśli ruch został wykonany lub @p false, jeśli
+ * jest nielegalny lub zabrakło pamięci.
+ */
+bool take_busy_field(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+	uint32_t current_owner = g->board[x][y];
+	uint32_t ids[NEIGHBOURS];
+	field_t seeds[NEIGHBOURS];
+	int connected_areas = adjacent_areas(g, player, x, y, ids, seeds);
+	const player_t *current = player_state(g, player);
+	if(!(current->golden_move_available)
+		|| current_owner == 0
+		|| current_owner == player
+		|| (connected_areas == 0 && current->areas == g->max_areas)) {
+		return false;
+	}
+
+	uint32_t whole = g->area_ids[x][y];
+	uint64_t whole_size = g->area_list[whole].info.size;
+	if(!reserve_occupation(g, ids, connected_areas)
+		|| !reserve_areas(g, NEIGHBOURS + 1) || whole_size > SIZE_MAX
+		|| !reserve_queue(&g->queue, (size_t)whole_size)
+		|| add_player(g, player) == NULL) {
+		errno = 0;
+		return false;
+	}
+	player_t *state = find_player(g, player);
+	player_t *owner = find_player(g, current_owner);
+
+	uint32_t pieces[NEIGHBOURS];
+	field_t piece_seeds[NEIGHBOURS];
+	int split_areas = split_area(g, x, y, pieces, piece_seeds);
+	if(owner->areas + split_areas - 1 > g->max_areas) {
+		join_pieces(g, x, y, whole, pieces, piece_seeds, split_areas);
+		return false;
+	}
+	uint32_t players_with_fields = g->players_with_fields;
+	release_area(g, whole);
+	owner->areas += split_areas - 1;
+	occupy_field(g, player, x, y, ids, seeds, connected_areas, false);
+	if(--(owner->busy_fields) == 0) {
+		(g->players_with_fields)--;
+	}
+	if((state->busy_fields)++ == 0) {
+		(g->players_with_fields)++;
+	}
+	state->golden_move_available = false;
+	refresh_players_after_move(g, player, current_owner, x, y,
+	                           players_with_fields);
+	return true;
+}
+
+
 /** @brief Sprawdza czy któreś z sąsiadujących pól należy do danego gracza
+ * Sąsiedzi są sprawdzani bezpośrednio na planszy, bo funkcja jest wywoływana
+ * dla każdego pola przy liczeniu wolnych pól. Na planszy @ref GAMMA_TORUS
+ * o boku 1 pole sprawdza samo siebie, co nie zmienia wyniku dla wolnego pola.
  * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] topology 	- topologia planszy, stała w miejscu wywołania,
  * @param[in] player 	- numer gracza, na rzecz którego wykonywane jest sprawdzenie,
  * @param[in] x 		- współrzędna pozioma sprawdzanego pola,
  * @param[in] y 		- współrzędna pionowa sprawdzanego pola.
@@ -124,298 +880,1657 @@ bool busy_fields_available(uint64_t *busy_fields, uint32_t num_of_players,
  * jakimkolwiek polem należącym do podanego gracza lub @p false, jeśli wśród
  * sąsiadów nie ma pól należących do gracza.
  */
-bool player_fields_around(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-	if((x != 0 && g->board[x - 1][y] == player)//lewy sąsiad
-	   || (x != UINT32_MAX && x + 1 < g->width && g->board[x + 1][y] == player)//prawy sąsiad
-	   || (y != 0 && g->board[x][y - 1] == player)//dolny sąsiad
-	   || (y != UINT32_MAX && y + 1 < g->height && g->board[x][y + 1] == player)) {//górny sąsiad
+bool player_fields_around(const gamma_t *g, gamma_topology_t topology,
+                          uint32_t player, uint32_t x, uint32_t y) {
+	if(topology == GAMMA_TORUS) {
+		uint32_t left = (x == 0 ? g->width : x) - 1;
+		uint32_t right = (x + 1 == g->width ? 0 : x + 1);
+		uint32_t down = (y == 0 ? g->height : y) - 1;
+		uint32_t up = (y + 1 == g->height ? 0 : y + 1);
+		return g->board[left][y] == player || g->board[right][y] == player
+		       || g->board[x][down] == player || g->board[x][up] == player;
+	}
+
+	bool left = (x != 0), right = (x + 1 < g->width);
+	bool down = (y != 0), up = (y + 1 < g->height);
+	if((left && g->board[x - 1][y] == player)//lewy sąsiad
+	   || (right && g->board[x + 1][y] == player)//prawy sąsiad
+	   || (down && g->board[x][y - 1] == player)//dolny sąsiad
+	   || (up && g->board[x][y + 1] == player)) {//górny sąsiad
 		return true;
 	}
-	else {
-		return false;
+	if(topology == GAMMA_SQUARE_DIAGONAL) {
+		return (left && down && g->board[x - 1][y - 1] == player)
+		       || (right && down && g->board[x + 1][y - 1] == player)
+		       || (right && up && g->board[x + 1][y + 1] == player)
+		       || (left && up && g->board[x - 1][y + 1] == player);
 	}
+	if(topology == GAMMA_HEX) {
+		return (right && down && g->board[x + 1][y - 1] == player)
+		       || (left && up && g->board[x - 1][y + 1] == player);
+	}
+	return false;
 }
 
 /** @brief Liczy jakie pola może jeszcze zająć gracz, ktory osiągnał limit obszarów.
  * Funkcja przchodzi całą planszę i liczy pola, które sąsiadują z jakimkolwiek
  * polem należącym do danego gracza.
  * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] topology 	- topologia planszy, stała w miejscu wywołania,
  * @param[in] player 	- numer gracza, dla którego chcemy policzyć pola.
  * @return Liczba pól możliwych do zajęcia przez gracza, który osiągnął limit
  * obszarów, liczba nieujemna.
  */
-uint64_t count_free_fields(gamma_t *g, uint32_t player) {
-	uint64_t counter = 0;
-	for(uint32_t x = 0; x < g->width; x++) {
-		for(uint32_t y = 0; y < g->height; y++) {
-			if(player_fields_around(g, player, x, y)
-			   && g->board[x][y] == 0) {
-				counter++;
+uint64_t count_free_fields_kernel(const gamma_t *g, gamma_topology_t topology,
+                                  uint32_t player) {
+	uint64_t counter = 0;
+	for(uint32_t x = 0; x < g->width; x++) {
+		for(uint32_t y = 0; y < g->height; y++) {
+			if(g->board[x][y] == 0
+			   && player_fields_around(g, topology, player, x, y)) {
+				counter++;
+			}
+		}
+	}
+	return counter;
+}
+
+/** @brief Liczy jakie pola może jeszcze zająć gracz, ktory osiągnał limit obszarów.
+ * Wywołuje wersję @ref count_free_fields_kernel dla topologii planszy.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player 	- numer gracza, dla którego chcemy policzyć pola.
+ * @return Liczba pól możliwych do zajęcia przez gracza, który osiągnął limit
+ * obszarów, liczba nieujemna.
+ */
+uint64_t count_free_fields(const gamma_t *g, uint32_t player) {
+	switch(g->topology) {
+		case GAMMA_SQUARE_DIAGONAL:
+			return count_free_fields_kernel(g, GAMMA_SQUARE_DIAGONAL, player);
+		case GAMMA_HEX:
+			return count_free_fields_kernel(g, GAMMA_HEX, player);
+		case GAMMA_TORUS:
+			return count_free_fields_kernel(g, GAMMA_TORUS, player);
+		default:
+			return count_free_fields_kernel(g, GAMMA_SQUARE, player);
+	}
+}
+
+
+/** @brief Wyznacza sąsiadów pola na planszy @ref GAMMA_SQUARE.
+ * Sąsiedzi są podawani w kolejności: lewy, prawy, dolny, górny.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola,
+ * @param[out] around 	- tablica, do której zostają zapisani sąsiedzi.
+ * @return Liczba sąsiadów pola leżących na planszy, od 0 do 4.
+ */
+int square_fields_around(const gamma_t *g, uint32_t x, uint32_t y,
+                         field_t around[NEIGHBOURS]) {
+	int count = 0;
+	if(x != 0) {//lewy sąsiad
+		around[count++] = (field_t){x - 1, y};
+	}
+	if(x + 1 < g->width) {//prawy sąsiad
+		around[count++] = (field_t){x + 1, y};
+	}
+	if(y != 0) {//dolny sąsiad
+		around[count++] = (field_t){x, y - 1};
+	}
+	if(y + 1 < g->height) {//górny sąsiad
+		around[count++] = (field_t){x, y + 1};
+	}
+	return count;
+}
+
+/** @brief Wyznacza sąsiadów pola na planszy @ref GAMMA_SQUARE_DIAGONAL.
+ * Po sąsiadach z @ref square_fields_around następują sąsiedzi po
+ * przekątnych.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola,
+ * @param[out] around 	- tablica, do której zostają zapisani sąsiedzi.
+ * @return Liczba sąsiadów pola leżących na planszy, od 0 do 8.
+ */
+int diagonal_fields_around(const gamma_t *g, uint32_t x, uint32_t y,
+                           field_t around[NEIGHBOURS]) {
+	bool left = (x != 0), right = (x + 1 < g->width);
+	bool down = (y != 0), up = (y + 1 < g->height);
+	int count = square_fields_around(g, x, y, around);
+	if(left && down) {
+		around[count++] = (field_t){x - 1, y - 1};
+	}
+	if(right && down) {
+		around[count++] = (field_t){x + 1, y - 1};
+	}
+	if(right && up) {
+		around[count++] = (field_t){x + 1, y + 1};
+	}
+	if(left && up) {
+		around[count++] = (field_t){x - 1, y + 1};
+	}
+	return count;
+}
+
+/** @brief Wyznacza sąsiadów pola na planszy @ref GAMMA_HEX.
+ * Po sąsiadach z @ref square_fields_around następują sąsiedzi (x + 1, y - 1)
+ * i (x - 1, y + 1).
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola,
+ * @param[out] around 	- tablica, do której zostają zapisani sąsiedzi.
+ * @return Liczba sąsiadów pola leżących na planszy, od 0 do 6.
+ */
+int hex_fields_around(const gamma_t *g, uint32_t x, uint32_t y,
+                      field_t around[NEIGHBOURS]) {
+	int count = square_fields_around(g, x, y, around);
+	if(x + 1 < g->width && y != 0) {
+		around[count++] = (field_t){x + 1, y - 1};
+	}
+	if(x != 0 && y + 1 < g->height) {
+		around[count++] = (field_t){x - 1, y + 1};
+	}
+	return count;
+}
+
+/** @brief Wyznacza sąsiadów pola na planszy @ref GAMMA_TORUS.
+ * Sąsiedzi są podawani w kolejności: lewy, prawy, dolny, górny, a pola na
+ * przeciwnych brzegach planszy sąsiadują ze sobą. Każdy sąsiad jest podawany
+ * raz i pole nie jest swoim sąsiadem, także gdy bok planszy ma 1 lub 2 pola.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola,
+ * @param[out] around 	- tablica, do której zostają zapisani sąsiedzi.
+ * @return Liczba sąsiadów pola, od 0 do 4.
+ */
+int torus_fields_around(const gamma_t *g, uint32_t x, uint32_t y,
+                        field_t around[NEIGHBOURS]) {
+	int count = 0;
+	if(g->width > 1) {//lewy sąsiad
+		around[count++] = (field_t){(x == 0 ? g->width : x) - 1, y};
+	}
+	if(g->width > 2) {//prawy sąsiad
+		around[count++] = (field_t){x + 1 == g->width ? 0 : x + 1, y};
+	}
+	if(g->height > 1) {//dolny sąsiad
+		around[count++] = (field_t){x, (y == 0 ? g->height : y) - 1};
+	}
+	if(g->height > 2) {//górny sąsiad
+		around[count++] = (field_t){x, y + 1 == g->height ? 0 : y + 1};
+	}
+	return count;
+}
+
+/** @brief Wyznacza sąsiadów pola w zadanej topologii.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] topology 	- topologia planszy, stała w miejscu wywołania,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola,
+ * @param[out] around 	- tablica, do której zostają zapisani sąsiedzi.
+ * @return Liczba sąsiadów pola, od 0 do @ref NEIGHBOURS.
+ */
+int topology_fields_around(const gamma_t *g, gamma_topology_t topology,
+                           uint32_t x, uint32_t y, field_t around[NEIGHBOURS]) {
+	switch(topology) {
+		case GAMMA_SQUARE_DIAGONAL:
+			return diagonal_fields_around(g, x, y, around);
+		case GAMMA_HEX:
+			return hex_fields_around(g, x, y, around);
+		case GAMMA_TORUS:
+			return torus_fields_around(g, x, y, around);
+		default:
+			return square_fields_around(g, x, y, around);
+	}
+}
+
+/** @brief Liczy wolnych sąsiadów pola w zadanej topologii.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] topology 	- topologia planszy, stała w miejscu wywołania,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola.
+ * @return Liczba wolnych pól sąsiadujących z polem, od 0 do @ref NEIGHBOURS.
+ */
+uint32_t topology_free_fields_around(const gamma_t *g,
+                                     gamma_topology_t topology,
+                                     uint32_t x, uint32_t y) {
+	field_t around[NEIGHBOURS];
+	int count = topology_fields_around(g, topology, x, y, around);
+	uint32_t free_fields = 0;
+	for(int i = 0; i < count; i++) {
+		free_fields += (g->board[around[i].x][around[i].y] == 0);
+	}
+	return free_fields;
+}
+
+/** @brief Wyznacza sąsiadów pola.
+ * Topologia jest wybierana przy każdym wywołaniu, więc funkcja jest używana
+ * poza pętlami przeszukującymi planszę.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola,
+ * @param[out] around 	- tablica, do której zostają zapisani sąsiedzi.
+ * @return Liczba sąsiadów pola, od 0 do @ref NEIGHBOURS.
+ */
+int fields_around(const gamma_t *g, uint32_t x, uint32_t y,
+                  field_t around[NEIGHBOURS]) {
+	return topology_fields_around(g, g->topology, x, y, around);
+}
+
+/** @brief Liczy wolnych sąsiadów pola.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola.
+ * @return Liczba wolnych pól sąsiadujących z polem, od 0 do @ref NEIGHBOURS.
+ */
+uint32_t free_fields_around(const gamma_t *g, uint32_t x, uint32_t y) {
+	return topology_free_fields_around(g, g->topology, x, y);
+}
+
+
+/** @brief Zapewnia miejsce na nowe obszary.
+ * W razie potrzeby powiększa tablicę obszarów co najmniej dwukrotnie, tak
+ * aby @ref new_area mogła utworzyć @p count obszarów bez alokowania pamięci.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] count 	- liczba obszarów, które mogą zostać utworzone.
+ * @return Wartość @p true, jeśli w tablicy jest miejsce lub @p false, jeśli
+ * zabrakło pamięci.
+ */
+bool reserve_areas(gamma_t *g, uint32_t count) {
+	uint64_t needed = (uint64_t)g->next_area_id + count;
+	if(needed <= g->area_capacity) {
+		return true;
+	}
+	if(needed > (uint64_t)UINT32_MAX + 1) {
+		return false;
+	}
+	size_t capacity = g->area_capacity ? 2 * g->area_capacity
+	                                   : BASIC_AREAS_CAPACITY;
+	while(capacity < needed) {
+		capacity *= 2;
+	}
+	if(capacity > SIZE_MAX / sizeof(area_t)) {
+		return false;
+	}
+	area_t *area_list = resize_memory(g->memory, GAMMA_MEMORY_AREAS,
+	                                  g->area_list,
+	                                  g->area_capacity * sizeof(area_t),
+	                                  capacity * sizeof(area_t));
+	if(!area_list) {
+		errno = 0;
+		return false;
+	}
+	g->area_list = area_list;
+	g->area_capacity = capacity;
+	return true;
+}
+
+/** @brief Tworzy pusty obszar gracza.
+ * Używa ostatnio zwolnionego identyfikatora, jeśli taki jest. Miejsce
+ * w tablicy obszarów musi zostać wcześniej zapewnione przez
+ * @ref reserve_areas.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] owner 	- numer gracza, do którego należy obszar, mającego
+ * 						już stan (@ref add_player).
+ * @return Identyfikator nowego obszaru.
+ */
+uint32_t new_area(gamma_t *g, uint32_t owner) {
+	uint32_t id = g->free_area_id;
+	if(id != 0) {
+		g->free_area_id = g->area_list[id].next;
+	}
+	else {
+		id = g->next_area_id++;
+	}
+	area_t *area = &g->area_list[id];
+	area->info.owner = owner;
+	area->info.size = 0;
+	area->info.min_x = area->info.min_y = UINT32_MAX;
+	area->info.max_x = area->info.max_y = 0;
+	area->info.free_edges = 0;
+	area->previous = 0;
+	player_t *state = find_player(g, owner);
+	area->next = state->first_area;
+	if(area->next != 0) {
+		g->area_list[area->next].previous = id;
+	}
+	state->first_area = id;
+	return id;
+}
+
+/** @brief Usuwa obszar z listy obszarów gracza i zwalnia jego identyfikator.
+ * Wolni sąsiedzi obszaru przestają być liczeni do sumy gracza.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] id 		- identyfikator obszaru.
+ */
+void release_area(gamma_t *g, uint32_t id) {
+	area_t *area = &g->area_list[id];
+	player_t *state = find_player(g, area->info.owner);
+	if(area->previous != 0) {
+		g->area_list[area->previous].next = area->next;
+	}
+	else {
+		state->first_area = area->next;
+	}
+	if(area->next != 0) {
+		g->area_list[area->next].previous = area->previous;
+	}
+	state->free_edges -= area->info.free_edges;
+	area->info.size = 0;
+	area->next = g->free_area_id;
+	g->free_area_id = id;
+}
+
+/** @brief Dolicza pole do statystyk obszaru.
+ * @param[in,out] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] id 			- identyfikator obszaru,
+ * @param[in] x 			- współrzędna pozioma pola,
+ * @param[in] y 			- współrzędna pionowa pola,
+ * @param[in] free_edges 	- liczba wolnych sąsiadów pola.
+ */
+void add_field_to_area(gamma_t *g, uint32_t id, uint32_t x, uint32_t y,
+                       uint32_t free_edges) {
+	gamma_area_t *info = &g->area_list[id].info;
+	info->size++;
+	info->min_x = x < info->min_x ? x : info->min_x;
+	info->max_x = x > info->max_x ? x : info->max_x;
+	info->min_y = y < info->min_y ? y : info->min_y;
+	info->max_y = y > info->max_y ? y : info->max_y;
+	info->free_edges += free_edges;
+	find_player(g, info->owner)->free_edges += free_edges;
+}
+
+/** @brief Przepisuje identyfikator obszaru metodą BFS.
+ * Zmienia identyfikator @p from na @p to we wszystkich polach spójnego
+ * obszaru zawierającego pole @p start. Kolejka gry musi wcześniej pomieścić
+ * tyle pól, ile ma obszar (@ref reserve_queue), dzięki czemu przeszukiwanie
+ * nie alokuje pamięci i nie może zostać przerwane.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] topology 	- topologia planszy, stała w miejscu wywołania,
+ * @param[in] start 	- pole, od którego zaczyna się przeszukiwanie,
+ * @param[in] from 		- dotychczasowy identyfikator pól,
+ * @param[in] to 		- nowy identyfikator pól,
+ * @param[in] measure 	- informacja czy doliczyć odwiedzone pola do statystyk
+ * 						obszaru @p to.
+ */
+void relabel_area_kernel(gamma_t *g, gamma_topology_t topology, field_t start,
+                         uint32_t from, uint32_t to, bool measure) {
+	queue_t *queue = &g->queue;
+	g->area_ids[start.x][start.y] = to;
+	enqueue(queue, start);
+	while(!empty_queue(queue)) {
+		field_t field = dequeue(queue), around[NEIGHBOURS];
+		int count = topology_fields_around(g, topology, field.x, field.y,
+		                                   around);
+		uint32_t free_edges = 0;
+		for(int i = 0; i < count; i++) {
+			uint32_t id = g->area_ids[around[i].x][around[i].y];
+			free_edges += (g->board[around[i].x][around[i].y] == 0);
+			if(id == from) {
+				g->area_ids[around[i].x][around[i].y] = to;
+				enqueue(queue, around[i]);
+			}
+		}
+		if(measure) {
+			add_field_to_area(g, to, field.x, field.y, free_edges);
+		}
+	}
+}
+
+/** @brief Przepisuje identyfikator obszaru metodą BFS.
+ * Wywołuje wersję @ref relabel_area_kernel dla topologii planszy.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] start 	- pole, od którego zaczyna się przeszukiwanie,
+ * @param[in] from 		- dotychczasowy identyfikator pól,
+ * @param[in] to 		- nowy identyfikator pól,
+ * @param[in] measure 	- informacja czy doliczyć odwiedzone pola do statystyk
+ * 						obszaru @p to.
+ */
+void relabel_area(gamma_t *g, field_t start, uint32_t from, uint32_t to,
+                  bool measure) {
+	switch(g->topology) {
+		case GAMMA_SQUARE_DIAGONAL:
+			relabel_area_kernel(g, GAMMA_SQUARE_DIAGONAL, start, from, to,
+			                    measure);
+			break;
+		case GAMMA_HEX:
+			relabel_area_kernel(g, GAMMA_HEX, start, from, to, measure);
+			break;
+		case GAMMA_TORUS:
+			relabel_area_kernel(g, GAMMA_TORUS, start, from, to, measure);
+			break;
+		default:
+			relabel_area_kernel(g, GAMMA_SQUARE, start, from, to, measure);
+	}
+}
+
+/** @brief Dołącza obszar do innego obszaru tego samego gracza.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] start 	- dowolne pole dołączanego obszaru,
+ * @param[in] from 		- identyfikator dołączanego obszaru, który zostaje
+ * 						zwolniony,
+ * @param[in] to 		- identyfikator obszaru, do którego dołączamy.
+ */
+void merge_areas(gamma_t *g, field_t start, uint32_t from, uint32_t to) {
+	gamma_area_t *source = &g->area_list[from].info;
+	gamma_area_t *target = &g->area_list[to].info;
+	target->size += source->size;
+	target->min_x = source->min_x < target->min_x ? source->min_x : target->min_x;
+	target->max_x = source->max_x > target->max_x ? source->max_x : target->max_x;
+	target->min_y = source->min_y < target->min_y ? source->min_y : target->min_y;
+	target->max_y = source->max_y > target->max_y ? source->max_y : target->max_y;
+	target->free_edges += source->free_edges;
+	source->free_edges = 0;
+	relabel_area(g, start, from, to, false);
+	release_area(g, from);
+}
+
+/** @brief Wyznacza obszary gracza, z którymi sąsiaduje pole.
+ * Największy z obszarów jest podawany jako pierwszy.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player 	- numer gracza,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola,
+ * @param[out] ids 		- tablica, do której zostają zapisane identyfikatory
+ * 						różnych obszarów,
+ * @param[out] seeds 	- tablica, do której zostają zapisane pola tych
+ * 						obszarów sąsiadujące z polem (@p x, @p y).
+ * @return Liczba różnych obszarów gracza sąsiadujących z polem, od 0 do
+ * @ref NEIGHBOURS.
+ */
+int adjacent_areas(const gamma_t *g, uint32_t player, uint32_t x, uint32_t y,
+                   uint32_t ids[NEIGHBOURS], field_t seeds[NEIGHBOURS]) {
+	field_t around[NEIGHBOURS];
+	int fields = fields_around(g, x, y, around), count = 0;
+	for(int i = 0; i < fields; i++) {
+		if(g->board[around[i].x][around[i].y] != player) {
+			continue;
+		}
+		uint32_t id = g->area_ids[around[i].x][around[i].y];
+		bool known = false;
+		for(int j = 0; j < count; j++) {
+			known |= (ids[j] == id);
+		}
+		if(known) {
+			continue;
+		}
+		ids[count] = id;
+		seeds[count] = around[i];
+		if(g->area_list[id].info.size > g->area_list[ids[0]].info.size) {
+			ids[count] = ids[0];
+			seeds[count] = seeds[0];
+			ids[0] = id;
+			seeds[0] = around[i];
+		}
+		count++;
+	}
+	return count;
+}
+
+/** @brief Zapewnia pamięć potrzebną do zajęcia pola.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] ids 		- obszary gracza sąsiadujące z polem, wyznaczone przez
+ * 						@ref adjacent_areas,
+ * @param[in] count 	- liczba tych obszarów.
+ * @return Wartość @p true, jeśli udało się zapewnić pamięć lub @p false,
+ * jeśli jej zabrakło.
+ */
+bool reserve_occupation(gamma_t *g, const uint32_t ids[NEIGHBOURS],
+                        int count) {
+	uint64_t largest_merged = 0;
+	for(int i = 1; i < count; i++) {
+		uint64_t size = g->area_list[ids[i]].info.size;
+		largest_merged = size > largest_merged ? size : largest_merged;
+	}
+	if(!reserve_areas(g, 1) || largest_merged > SIZE_MAX
+	   || !reserve_queue(&g->queue, (size_t)largest_merged)) {
+		errno = 0;
+		return false;
+	}
+	return true;
+}
+
+/** @brief Zajmuje pole, aktualizując obszary.
+ * Pole trafia do największego z sąsiednich obszarów gracza, do którego
+ * zostają dołączone pozostałe, albo do nowego obszaru. Pamięć musi zostać
+ * wcześniej zapewniona przez @ref reserve_occupation.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player 	- numer gracza zajmującego pole,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola,
+ * @param[in] ids 		- obszary gracza sąsiadujące z polem, wyznaczone przez
+ * 						@ref adjacent_areas,
+ * @param[in] seeds 	- pola tych obszarów sąsiadujące z polem,
+ * @param[in] count 	- liczba tych obszarów,
+ * @param[in] was_free 	- informacja czy pole było wolne (w przeciwnym
+ * 						wypadku jest zajmowane złotym ruchem).
+ */
+void occupy_field(gamma_t *g, uint32_t player, uint32_t x, uint32_t y,
+                  const uint32_t ids[NEIGHBOURS],
+                  const field_t seeds[NEIGHBOURS], int count, bool was_free) {
+	uint32_t target = count > 0 ? ids[0] : new_area(g, player);
+	for(int i = 1; i < count; i++) {
+		merge_areas(g, seeds[i], ids[i], target);
+	}
+	player_t *state = find_player(g, player);
+	if(count == 0) {
+		(state->areas)++;
+	}
+	else {
+		state->areas -= (uint32_t)count - 1;
+	}
+	g->board[x][y] = player;
+	g->area_ids[x][y] = target;
+	add_field_to_area(g, target, x, y, free_fields_around(g, x, y));
+	if(was_free) {
+		field_t around[NEIGHBOURS];
+		int fields = fields_around(g, x, y, around);
+		for(int i = 0; i < fields; i++) {
+			uint32_t id = g->area_ids[around[i].x][around[i].y];
+			if(id != 0) {
+				g->area_list[id].info.free_edges--;
+				(find_player(g, g->area_list[id].info.owner)->free_edges)--;
+			}
+		}
+	}
+}
+
+/** @brief Dzieli obszar po usunięciu z niego pola.
+ * Każdy spójny fragment obszaru sąsiadujący z polem (@p x, @p y) dostaje
+ * nowy identyfikator i statystyki policzone od nowa, a pole przestaje należeć
+ * do obszaru. Stary identyfikator pozostaje zajęty do czasu wywołania
+ * @ref release_area lub @ref join_pieces. Pamięć na nowe obszary i kolejkę
+ * mieszczącą cały obszar musi zostać wcześniej zapewniona.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola,
+ * @param[out] pieces 	- tablica, do której zostają zapisane identyfikatory
+ * 						fragmentów,
+ * @param[out] seeds 	- tablica, do której zostają zapisane pola fragmentów
+ * 						sąsiadujące z polem (@p x, @p y).
+ * @return Liczba fragmentów, od 0 do @ref NEIGHBOURS.
+ */
+int split_area(gamma_t *g, uint32_t x, uint32_t y,
+               uint32_t pieces[NEIGHBOURS], field_t seeds[NEIGHBOURS]) {
+	uint32_t whole = g->area_ids[x][y];
+	field_t around[NEIGHBOURS];
+	int fields = fields_around(g, x, y, around), count = 0;
+	g->area_ids[x][y] = 0;
+	for(int i = 0; i < fields; i++) {
+		if(g->area_ids[around[i].x][around[i].y] == whole) {
+			pieces[count] = new_area(g, g->board[x][y]);
+			seeds[count] = around[i];
+			relabel_area(g, around[i], whole, pieces[count], true);
+			count++;
+		}
+	}
+	return count;
+}
+
+/** @brief Cofa podział obszaru wykonany przez @ref split_area.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma usuniętego pola,
+ * @param[in] y 		- współrzędna pionowa usuniętego pola,
+ * @param[in] whole 	- identyfikator podzielonego obszaru,
+ * @param[in] pieces 	- identyfikatory fragmentów,
+ * @param[in] seeds 	- pola fragmentów sąsiadujące z usuniętym polem,
+ * @param[in] count 	- liczba fragmentów.
+ */
+void join_pieces(gamma_t *g, uint32_t x, uint32_t y, uint32_t whole,
+                 const uint32_t pieces[NEIGHBOURS],
+                 const field_t seeds[NEIGHBOURS], int count) {
+	for(int i = 0; i < count; i++) {
+		relabel_area(g, seeds[i], pieces[i], whole, false);
+		release_area(g, pieces[i]);
+	}
+	g->area_ids[x][y] = whole;
+}
+
+
+/** @brief Sprawdza czy pole przesunięte względem danego należy do obszaru.
+ * Na planszy @ref GAMMA_TORUS przesunięcie przechodzi przez brzeg planszy.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola,
+ * @param[in] dx 		- przesunięcie w poziomie, od -1 do 1,
+ * @param[in] dy 		- przesunięcie w pionie, od -1 do 1,
+ * @param[in] area 		- identyfikator obszaru.
+ * @return Wartość @p true, jeśli pole (@p x + @p dx, @p y + @p dy) leży na
+ * planszy i należy do obszaru @p area lub @p false w przeciwnym wypadku.
+ */
+bool in_area(const gamma_t *g, uint32_t x, uint32_t y, int dx, int dy,
+             uint32_t area) {
+	if(g->topology == GAMMA_TORUS) {
+		x = (dx < 0 && x == 0) ? g->width : x;
+		y = (dy < 0 && y == 0) ? g->height : y;
+		x = (x + dx) % g->width;
+		y = (y + dy) % g->height;
+	}
+	else if((dx < 0 && x == 0) || (dx > 0 && x + 1 >= g->width)
+	        || (dy < 0 && y == 0) || (dy > 0 && y + 1 >= g->height)) {
+		return false;
+	}
+	else {
+		x += dx;
+		y += dy;
+	}
+	return g->area_ids[x][y] == area;
+}
+
+/** @brief Sprawdza czy sąsiedzi pola z jego obszaru są połączeni wokół pola.
+ * Pola otaczające pole (@p x, @p y) tworzą pierścień, w którym kolejne pola
+ * sąsiadują ze sobą. Sąsiedzi pola leżący w jednym nieprzerwanym ciągu pól
+ * obszaru na pierścieniu są połączeni bez udziału pola, więc jeśli wszyscy
+ * leżą w jednym ciągu, usunięcie pola nie dzieli obszaru. Wynik @p false nie
+ * przesądza, że obszar się podzieli.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma zajętego pola,
+ * @param[in] y 		- współrzędna pionowa zajętego pola,
+ * @param[in] area 		- identyfikator obszaru pola.
+ * @return Wartość @p true, jeśli sąsiedzi pola z jego obszaru są połączeni
+ * przez pierścień lub @p false w przeciwnym wypadku.
+ */
+bool ring_linked(const gamma_t *g, uint32_t x, uint32_t y, uint32_t area) {
+	//pierścień planszy kwadratowej: sąsiedzi pod parzystymi indeksami
+	static const int square_ring[RING_LENGTH][2] = {
+		{-1, 0}, {-1, -1}, {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}
+	};
+	static const int hex_ring[RING_LENGTH][2] = {
+		{1, 0}, {1, -1}, {0, -1}, {-1, 0}, {-1, 1}, {0, 1}
+	};
+	if(g->topology == GAMMA_TORUS && (g->width < 3 || g->height < 3)) {
+		return false;//pierścień nachodziłby na samo pole
+	}
+	const int (*ring)[2] = (g->topology == GAMMA_HEX ? hex_ring : square_ring);
+	int length = (g->topology == GAMMA_HEX ? 6 : RING_LENGTH);
+	int step = (g->topology == GAMMA_SQUARE_DIAGONAL
+	            || g->topology == GAMMA_HEX ? 1 : 2);
+	bool inside[RING_LENGTH];
+	int gap = -1;
+	for(int i = 0; i < length; i++) {
+		inside[i] = in_area(g, x, y, ring[i][0], ring[i][1], area);
+		gap = inside[i] ? gap : i;
+	}
+	if(gap < 0) {
+		return true;
+	}
+	int runs = 0;
+	bool touches = false;
+	for(int k = 1; k <= length; k++) {//zaczynamy za polem spoza obszaru
+		int i = (gap + k) % length;
+		if(inside[i]) {
+			touches |= (i % step == 0);
+		}
+		else {
+			runs += touches;
+			touches = false;
+		}
+	}
+	return runs <= 1;
+}
+
+/** @brief Wyznacza sąsiadów pola należących do tego samego obszaru.
+ * Sprawdza też za pomocą @ref ring_linked, czy wszyscy ci sąsiedzi są
+ * połączeni przez pola otaczające pole (@p x, @p y). Jeśli tak, usunięcie
+ * pola nie dzieli obszaru i nie trzeba go przeszukiwać.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma zajętego pola,
+ * @param[in] y 		- współrzędna pionowa zajętego pola,
+ * @param[out] seeds 	- tablica, do której zostają zapisani sąsiedzi,
+ * @param[out] linked 	- po zakończeniu wykonania funkcji będzie zawierać
+ * 						informację czy sąsiedzi są połączeni wokół pola.
+ * @return Liczba sąsiadów pola należących do jego obszaru, od 0 do
+ * @ref NEIGHBOURS.
+ */
+int area_neighbours(const gamma_t *g, uint32_t x, uint32_t y,
+                    field_t seeds[NEIGHBOURS], bool *linked) {
+	uint32_t area = g->area_ids[x][y];
+	field_t around[NEIGHBOURS];
+	int fields = fields_around(g, x, y, around), count = 0;
+	for(int i = 0; i < fields; i++) {
+		if(g->area_ids[around[i].x][around[i].y] == area) {
+			seeds[count++] = around[i];
+		}
+	}
+	*linked = (count <= 1 || ring_linked(g, x, y, area));
+	return count;
+}
+
+/** @brief Tworzy pusty zbiór odwiedzonych pól obszaru.
+ * Wybiera mniejszą z dwóch postaci zbioru (@ref visited_t), a jeśli nie
+ * uda się jej zaalokować, na przykład z powodu limitu pamięci gry, próbuje
+ * drugiej.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] area 		- identyfikator obszaru,
+ * @param[out] visited 	- wskaźnik na tworzony zbiór.
+ * @return Wartość @p true, jeśli udało się utworzyć zbiór lub @p false,
+ * jeśli zabrakło pamięci.
+ */
+bool init_visited(const gamma_t *g, uint32_t area, visited_t *visited) {
+	const gamma_area_t *box = &g->area_list[area].info;
+	uint64_t box_fields = (uint64_t)(box->max_x - box->min_x + 1)
+	                      * (box->max_y - box->min_y + UINT64_C(1));
+	uint64_t bits_size = (box_fields / 64 + 1) * sizeof(uint64_t);
+	uint64_t capacity = 1;
+	while(capacity < 2 * box->size) {
+		capacity *= 2;
+	}
+	uint64_t fields_size = capacity * sizeof(field_t);
+	visited->bits = NULL;
+	visited->fields = NULL;
+	visited->mask = (size_t)(capacity - 1);
+	visited->box = box;
+	for(int attempt = 0; attempt < 2; attempt++) {
+		bool bits = (bits_size <= fields_size) == (attempt == 0);
+		uint64_t size = bits ? bits_size : fields_size;
+		if(size > SIZE_MAX) {
+			continue;
+		}
+		visited->size = (size_t)size;
+		if(bits) {
+			visited->bits = allocate_memory(g->memory, GAMMA_MEMORY_SEARCH,
+			                                visited->size, true);
+			if(visited->bits) {
+				return true;
+			}
+		}
+		else {
+			visited->fields = allocate_memory(g->memory, GAMMA_MEMORY_SEARCH,
+			                                  visited->size, false);
+			if(visited->fields) {
+				memset(visited->fields, 0xFF, visited->size);
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+/** @brief Oznacza pole obszaru jako odwiedzone.
+ * W tablicy bitów pole ma bit o numerze wyznaczonym przez jego położenie
+ * w prostokącie ograniczającym obszar, a w tablicy haszującej jest
+ * wyszukiwane metodą adresowania liniowego.
+ * @param[in,out] visited 	- zbiór odwiedzonych pól,
+ * @param[in] field 		- pole leżące w prostokącie ograniczającym obszar.
+ * @return Wartość @p true, jeśli pole nie było wcześniej odwiedzone lub
+ * @p false w przeciwnym wypadku.
+ */
+bool mark_visited(visited_t *visited, field_t field) {
+	if(visited->bits) {
+		const gamma_area_t *box = visited->box;
+		uint64_t index = (uint64_t)(field.x - box->min_x)
+		                 * (box->max_y - box->min_y + UINT64_C(1))
+		                 + (field.y - box->min_y);
+		uint64_t bit = UINT64_C(1) << (index % 64);
+		if(visited->bits[index / 64] & bit) {
+			return false;
+		}
+		visited->bits[index / 64] |= bit;
+		return true;
+	}
+
+	uint64_t hash = (((uint64_t)field.x << 32) | field.y)
+	                * UINT64_C(0x9E3779B97F4A7C15);
+	size_t i = (size_t)(hash ^ (hash >> 32)) & visited->mask;
+	while(visited->fields[i].x != UINT32_MAX) {
+		if(visited->fields[i].x == field.x && visited->fields[i].y == field.y) {
+			return false;
+		}
+		i = (i + 1) & visited->mask;
+	}
+	visited->fields[i] = field;
+	return true;
+}
+
+/** @brief Przydziela sąsiadów usuwanego pola do fragmentów obszaru.
+ * Przeszukuje obszar metodą BFS z własną kolejką, zaczynając od kolejnych
+ * nieodwiedzonych sąsiadów, i kończy, gdy tylko wszyscy sąsiedzi zostaną
+ * przydzieleni do fragmentów.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] topology 	- topologia planszy, stała w miejscu wywołania,
+ * @param[in] area 		- identyfikator obszaru,
+ * @param[in,out] visited - zbiór odwiedzonych pól obszaru, z oznaczonym
+ * 						usuwanym polem,
+ * @param[in] seeds 	- sąsiedzi usuwanego pola należący do obszaru,
+ * @param[in] count 	- liczba tych sąsiadów,
+ * @param[out] pieces 	- wskaźnik, pod który zostaje zapisana liczba
+ * 						fragmentów.
+ * @return Wartość @p true, jeśli udało się policzyć fragmenty lub @p false,
+ * jeśli zabrakło pamięci.
+ */
+bool search_pieces(const gamma_t *g, gamma_topology_t topology, uint32_t area,
+                   visited_t *visited, const field_t *seeds, int count,
+                   int *pieces) {
+	queue_t queue = init_queue(g->memory);
+	bool correct = true;
+	int left = count;
+	*pieces = 0;
+	for(int i = 0; correct && left > 0; i++) {
+		if(!mark_visited(visited, seeds[i])) {
+			continue;
+		}
+		(*pieces)++;
+		left--;
+		correct = (left == 0 || enqueue(&queue, seeds[i]));
+		while(correct && left > 0 && !empty_queue(&queue)) {
+			field_t field = dequeue(&queue), around[NEIGHBOURS];
+			int fields = topology_fields_around(g, topology, field.x, field.y,
+			                                    around);
+			for(int j = 0; correct && j < fields; j++) {
+				if(g->area_ids[around[j].x][around[j].y] != area
+				   || !mark_visited(visited, around[j])) {
+					continue;
+				}
+				for(int k = i + 1; k < count; k++) {
+					left -= (seeds[k].x == around[j].x
+					         && seeds[k].y == around[j].y);
+				}
+				correct = enqueue(&queue, around[j]);
+			}
+		}
+		clear_queue(&queue);
+	}
+	delete_queue(&queue);
+	return correct;
+}
+
+/** @brief Liczy fragmenty, na które rozpadłby się obszar bez danego pola.
+ * Nie zmienia stanu gry. Jeśli sąsiedzi pola nie są połączeni wokół niego
+ * (@ref area_neighbours), przeszukuje obszar wersją @ref search_pieces dla
+ * topologii planszy, ze zbiorem odwiedzonych pól z @ref init_visited.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma zajętego pola,
+ * @param[in] y 		- współrzędna pionowa zajętego pola,
+ * @param[out] pieces 	- wskaźnik, pod który zostaje zapisana liczba
+ * 						fragmentów, od 0 do @ref NEIGHBOURS.
+ * @return Wartość @p true, jeśli udało się policzyć fragmenty lub @p false,
+ * jeśli zabrakło pamięci.
+ */
+bool count_pieces(const gamma_t *g, uint32_t x, uint32_t y, int *pieces) {
+	field_t seeds[NEIGHBOURS];
+	bool linked;
+	int count = area_neighbours(g, x, y, seeds, &linked);
+	if(linked) {
+		*pieces = (count > 0 ? 1 : 0);
+		return true;
+	}
+
+	uint32_t area = g->area_ids[x][y];
+	visited_t visited;
+	if(!init_visited(g, area, &visited)) {
+		errno = 0;
+		return false;
+	}
+	mark_visited(&visited, (field_t){x, y});
+	bool correct;
+	switch(g->topology) {
+		case GAMMA_SQUARE_DIAGONAL:
+			correct = search_pieces(g, GAMMA_SQUARE_DIAGONAL, area, &visited,
+			                        seeds, count, pieces);
+			break;
+		case GAMMA_HEX:
+			correct = search_pieces(g, GAMMA_HEX, area, &visited, seeds, count,
+			                        pieces);
+			break;
+		case GAMMA_TORUS:
+			correct = search_pieces(g, GAMMA_TORUS, area, &visited, seeds,
+			                        count, pieces);
+			break;
+		default:
+			correct = search_pieces(g, GAMMA_SQUARE, area, &visited, seeds,
+			                        count, pieces);
+	}
+	release_memory(g->memory, GAMMA_MEMORY_SEARCH,
+	               visited.bits ? (void *)visited.bits : (void *)visited.fields,
+	               visited.size);
+	if(!correct) {
+		errno = 0;
+		return false;
+	}
+	return true;
+}
+
+
+/** @brief Sprawdza czy gracz może wykonać ruch.
+ * Gracz, który nie osiągnął limitu obszarów, może wejść na dowolne wolne
+ * pole, a gracz, który go osiągnął - na wolne pole sąsiadujące z jednym
+ * z jego obszarów, czyli gdy suma wartości free_edges jego obszarów jest
+ * dodatnia. Złoty ruch wymaga pola zajętego przez innego gracza.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] state 	- wskaźnik na stan gracza.
+ * @return Wartość @p true, jeśli gracz może wykonać ruch lub @p false
+ * w przeciwnym wypadku.
+ */
+bool player_can_move(const gamma_t *g, const player_t *state) {
+	uint64_t busy_fields = (uint64_t)g->width * g->height - g->all_free_fields;
+	return (g->all_free_fields != 0
+	        && (state->areas < g->max_areas || state->free_edges != 0))
+	       || (state->golden_move_available
+	           && busy_fields > state->busy_fields);
+}
+
+/** @brief Daje nieużywany węzeł drzewa graczy, którzy nie mogą wykonać ruchu.
+ * Miejsce na węzeł zapewnia @ref reserve_players.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry.
+ * @return Indeks wyzerowanego węzła.
+ */
+uint32_t new_blocked_node(gamma_t *g) {
+	uint32_t index = g->free_blocked_node;
+	if(index != 0) {
+		g->free_blocked_node = g->blocked_tree[index].children[0];
+	}
+	else {
+		index = (g->blocked_nodes)++;
+	}
+	blocked_node_t *node = &g->blocked_tree[index];
+	node->children[0] = node->children[1] = 0;
+	node->blocked = 0;
+	return index;
+}
+
+/** @brief Dodaje gracza do drzewa graczy, którzy nie mogą wykonać ruchu.
+ * Przechodzi od korzenia do liścia gracza, tworząc brakujące węzły.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] number 	- numer gracza, którego nie ma w drzewie.
+ */
+void block_player(gamma_t *g, uint32_t number) {
+	uint32_t *link = &g->blocked_root;
+	for(uint32_t level = g->player_bits; ; level--) {
+		if(*link == 0) {
+			*link = new_blocked_node(g);
+		}
+		blocked_node_t *node = &g->blocked_tree[*link];
+		(node->blocked)++;
+		if(level == 0) {
+			return;
+		}
+		link = &node->children[(number >> (level - 1)) & 1];
+	}
+}
+
+/** @brief Usuwa gracza z drzewa graczy, którzy nie mogą wykonać ruchu.
+ * Węzły, w których przedziałach nie zostaje żaden gracz, wracają na listę
+ * zwolnionych węzłów.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] number 	- numer gracza, który jest w drzewie.
+ */
+void unblock_player(gamma_t *g, uint32_t number) {
+	uint32_t *link = &g->blocked_root;
+	for(uint32_t level = g->player_bits; ; level--) {
+		uint32_t index = *link;
+		blocked_node_t *node = &g->blocked_tree[index];
+		if(--(node->blocked) == 0) {
+			*link = 0;
+			while(index != 0) {
+				node = &g->blocked_tree[index];
+				uint32_t next = node->children[0] | node->children[1];
+				node->children[0] = g->free_blocked_node;
+				g->free_blocked_node = index;
+				index = next;
+			}
+			return;
+		}
+		link = &node->children[(number >> (level - 1)) & 1];
+	}
+}
+
+/** @brief Zapisuje czy gracz może wykonać ruch.
+ * Uaktualnia stan gracza, licznik graczy mogących wykonać ruch i drzewo
+ * graczy, którzy nie mogą go wykonać, jeśli informacja się zmieniła.
+ * @param[in,out] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] state 	- wskaźnik na stan gracza,
+ * @param[in] can_move 		- informacja czy gracz może wykonać ruch.
+ */
+void update_blocked(gamma_t *g, player_t *state, bool can_move) {
+	if(state->blocked != can_move) {
+		return;
+	}
+	state->blocked = !can_move;
+	if(can_move) {
+		(g->players_with_move)++;
+		unblock_player(g, state->number);
+	}
+	else {
+		(g->players_with_move)--;
+		block_player(g, state->number);
+	}
+}
+
+/** @brief Sprawdza od nowa czy gracz może wykonać ruch.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player 	- numer gracza, który ma stan.
+ */
+void refresh_player(gamma_t *g, uint32_t player) {
+	player_t *state = find_player(g, player);
+	update_blocked(g, state, player_can_move(g, state));
+}
+
+/** @brief Sprawdza od nowa wszystkich graczy.
+ * Sprawdzani są tylko gracze, którzy mają stan, bo gracz bez pól i ze złotym
+ * ruchem zawsze może wykonać ruch: wejść na wolne pole albo, gdy takiego nie
+ * ma, złotym ruchem na pole innego gracza.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry.
+ */
+void refresh_all_players(gamma_t *g) {
+	for(uint32_t i = 0; i < g->player_count; i++) {
+		player_t *state = &g->player_list[i];
+		update_blocked(g, state, player_can_move(g, state));
+	}
+}
+
+/** @brief Uaktualnia informacje o graczach po wykonanym ruchu.
+ * @param[in,out] g 				- wskaźnik na strukturę przechowującą
+ * 									stan gry,
+ * @param[in] player 				- numer gracza, który wykonał ruch,
+ * @param[in] owner 				- poprzedni właściciel pola lub 0, jeśli
+ * 									pole było wolne,
+ * @param[in] x 					- współrzędna pozioma pola,
+ * @param[in] y 					- współrzędna pionowa pola,
+ * @param[in] players_with_fields 	- liczba graczy zajmujących pola przed
+ * 									ruchem.
+ */
+void refresh_players_after_move(gamma_t *g, uint32_t player, uint32_t owner,
+                                uint32_t x, uint32_t y,
+                                uint32_t players_with_fields) {
+	if((players_with_fields != g->players_with_fields
+	    && (players_with_fields <= 1 || g->players_with_fields <= 1))
+	   || (owner == 0 && g->all_free_fields == 0)) {
+		refresh_all_players(g);
+		return;
+	}
+	refresh_player(g, player);
+	if(owner != 0) {
+		refresh_player(g, owner);
+		return;
+	}
+	field_t around[NEIGHBOURS];
+	int count = fields_around(g, x, y, around);
+	for(int i = 0; i < count; i++) {
+		uint32_t neighbour = g->board[around[i].x][around[i].y];
+		if(neighbour != 0 && neighbour != player) {
+			refresh_player(g, neighbour);
+		}
+	}
+}
+
+/** @brief Wyszukuje najmniejszy numer, który nie należy do gracza
+ * niemogącego wykonać ruchu.
+ * Przeszukuje poddrzewo drzewa graczy, którzy nie mogą wykonać ruchu,
+ * pomijając przedziały, w których żaden gracz nie może wykonać ruchu, więc
+ * działa w czasie proporcjonalnym do wysokości drzewa.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] node 		- węzeł poddrzewa lub 0 dla pustego poddrzewa,
+ * @param[in] level 	- poziom węzła, czyli logarytm długości przedziału,
+ * @param[in] base 		- początek przedziału węzła,
+ * @param[in] from 		- najmniejszy dopuszczalny numer, mniejszy niż
+ * 						koniec przedziału węzła.
+ * @return Najmniejszy numer nie mniejszy niż @p from i nie mniejszy niż
+ * @p base, który nie należy do gracza niemogącego wykonać ruchu (być może
+ * większy niż liczba graczy), lub @ref NO_PLAYER, jeśli takiego numeru
+ * w przedziale nie ma.
+ */
+uint64_t first_unblocked(const gamma_t *g, uint32_t node, uint32_t level,
+                         uint64_t base, uint64_t from) {
+	if(node == 0) {
+		return from > base ? from : base;
+	}
+	if(g->blocked_tree[node].blocked == (UINT64_C(1) << level)) {
+		return NO_PLAYER;
+	}
+	if(level == 0) {
+		return base;
+	}
+	uint64_t half = UINT64_C(1) << (level - 1);
+	const uint32_t *children = g->blocked_tree[node].children;
+	if(from < base + half) {
+		uint64_t found = first_unblocked(g, children[0], level - 1, base, from);
+		if(found != NO_PLAYER) {
+			return found;
+		}
+	}
+	return first_unblocked(g, children[1], level - 1, base + half, from);
+}
+
+
+/** @brief Inicjalizuje barierę.
+ * @param[out] barrier 	- wskaźnik na barierę,
+ * @param[in] count 	- liczba wątków, na które czeka bariera.
+ */
+void init_influence_barrier(influence_barrier_t *barrier, uint32_t count) {
+	pthread_mutex_init(&barrier->lock, NULL);
+	pthread_cond_init(&barrier->passed, NULL);
+	barrier->count = count;
+	barrier->arrived = 0;
+	barrier->generation = 0;
+}
+
+/** @brief Czeka, aż wszystkie wątki dojdą do bariery.
+ * @param[in,out] barrier 	- wskaźnik na barierę.
+ */
+void wait_influence_barrier(influence_barrier_t *barrier) {
+	pthread_mutex_lock(&barrier->lock);
+	uint64_t generation = barrier->generation;
+	if(++barrier->arrived == barrier->count) {
+		barrier->arrived = 0;
+		barrier->generation++;
+		pthread_cond_broadcast(&barrier->passed);
+	}
+	while(generation == barrier->generation) {
+		pthread_cond_wait(&barrier->passed, &barrier->lock);
+	}
+	pthread_mutex_unlock(&barrier->lock);
+}
+
+/** @brief Zmniejsza liczbę wątków, na które czeka bariera.
+ * Wywoływana, gdy nie udało się utworzyć wątku.
+ * @param[in,out] barrier 	- wskaźnik na barierę.
+ */
+void leave_influence_barrier(influence_barrier_t *barrier) {
+	pthread_mutex_lock(&barrier->lock);
+	barrier->count--;
+	if(barrier->arrived > 0 && barrier->arrived == barrier->count) {
+		barrier->arrived = 0;
+		barrier->generation++;
+		pthread_cond_broadcast(&barrier->passed);
+	}
+	pthread_mutex_unlock(&barrier->lock);
+}
+
+/** @brief Dopisuje pole do listy.
+ * W razie potrzeby dwukrotnie powiększa tablicę.
+ * @param[in,out] list 	- wskaźnik na listę,
+ * @param[in] field 	- dopisywane pole.
+ * @return Wartość @p true, jeśli dopisano pole lub @p false, jeśli zabrakło
+ * pamięci.
+ */
+bool push_field(field_list_t *list, field_t field) {
+	if(list->length == list->capacity) {
+		size_t capacity = list->capacity ? 2 * list->capacity : INFLUENCE_CHUNK;
+		if(capacity > SIZE_MAX / sizeof(field_t)) {
+			return false;
+		}
+		field_t *fields = resize_memory(list->memory, GAMMA_MEMORY_INFLUENCE,
+		                                list->fields,
+		                                list->capacity * sizeof(field_t),
+		                                capacity * sizeof(field_t));
+		if(!fields) {
+			return false;
+		}
+		list->fields = fields;
+		list->capacity = capacity;
+	}
+	list->fields[list->length++] = field;
+	return true;
+}
+
+/** @brief Przydziela wątkowi kolejną część pracy.
+ * @param[in,out] influence - wskaźnik na stan obliczania mapy wpływów,
+ * @param[in] total 		- liczba części pracy w bieżącym kroku.
+ * @return Numer przydzielonej części lub @p total, jeśli praca się skończyła.
+ */
+size_t next_influence_chunk(influence_t *influence, size_t total) {
+	size_t chunk = atomic_fetch_add_explicit(&influence->next_chunk, 1,
+	                                         memory_order_relaxed);
+	return chunk < total ? chunk : total;
+}
+
+/** @brief Ustawia stany pól na początku przeszukiwania.
+ * Pola graczy są w odległości 0 od siebie samych, a te z nich, które
+ * sąsiadują z wolnym polem, trafiają do pierwszego frontu. Wątki dzielą się
+ * kolumnami planszy.
+ * @param[in,out] worker 	- wskaźnik na stan wątku,
+ * @param[in] topology 		- topologia planszy, stała w miejscu wywołania.
+ */
+void init_influence_sources_kernel(influence_worker_t *worker,
+                                   gamma_topology_t topology) {
+	influence_t *influence = worker->influence;
+	gamma_t *g = influence->g;
+	size_t columns = INFLUENCE_CHUNK / g->height + 1;
+	size_t chunks = (g->width + columns - 1) / columns;
+	for(size_t chunk = next_influence_chunk(influence, chunks); chunk < chunks;
+	    chunk = next_influence_chunk(influence, chunks)) {
+		uint32_t end = (uint32_t)((chunk + 1) * columns < g->width
+		                          ? (chunk + 1) * columns : g->width);
+		for(uint32_t x = (uint32_t)(chunk * columns); x < end; x++) {
+			_Atomic uint64_t *states = influence->states + (size_t)x * g->height;
+			for(uint32_t y = 0; y < g->height; y++) {
+				uint32_t owner = g->board[x][y];
+				atomic_store_explicit(&states[y], owner ? owner : UNREACHED,
+				                      memory_order_relaxed);
+				if(owner != 0
+				   && topology_free_fields_around(g, topology, x, y) > 0
+				   && !push_field(&worker->next, (field_t){x, y})) {
+					atomic_store(&influence->failed, true);
+				}
+			}
+		}
+	}
+}
+
+/** @brief Ustawia stany pól na początku przeszukiwania.
+ * Wywołuje wersję @ref init_influence_sources_kernel dla topologii planszy.
+ * @param[in,out] worker 	- wskaźnik na stan wątku.
+ */
+void init_influence_sources(influence_worker_t *worker) {
+	switch(worker->influence->g->topology) {
+		case GAMMA_SQUARE_DIAGONAL:
+			init_influence_sources_kernel(worker, GAMMA_SQUARE_DIAGONAL);
+			break;
+		case GAMMA_HEX:
+			init_influence_sources_kernel(worker, GAMMA_HEX);
+			break;
+		case GAMMA_TORUS:
+			init_influence_sources_kernel(worker, GAMMA_TORUS);
+			break;
+		default:
+			init_influence_sources_kernel(worker, GAMMA_SQUARE);
+	}
+}
+
+/** @brief Dociera do wolnego pola z pola bieżącego frontu.
+ * Pierwszy wątek, który dotrze do pola, ustala jego odległość i dopisuje je
+ * do następnego frontu. Jeśli w tym samym kroku do pola dociera inny gracz,
+ * pole staje się remisowe.
+ * @param[in,out] worker 	- wskaźnik na stan wątku,
+ * @param[in] field 		- wolne pole,
+ * @param[in] state 		- stan, który pole ma przyjąć.
+ */
+void reach_field(influence_worker_t *worker, field_t field, uint64_t state) {
+	influence_t *influence = worker->influence;
+	_Atomic uint64_t *target = influence->states
+	                           + (size_t)field.x * influence->g->height + field.y;
+	uint64_t seen = atomic_load_explicit(target, memory_order_relaxed);
+	while(true) {
+		if(seen == UNREACHED) {
+			if(atomic_compare_exchange_weak_explicit(target, &seen, state,
+			                                         memory_order_relaxed,
+			                                         memory_order_relaxed)) {
+				if(!push_field(&worker->next, field)) {
+					atomic_store(&influence->failed, true);
+				}
+				return;
+			}
+		}
+		else if((seen >> 32) != (state >> 32) || (uint32_t)seen == 0
+		        || seen == state) {
+			return;
+		}
+		else if(atomic_compare_exchange_weak_explicit(target, &seen,
+		                                              state >> 32 << 32,
+		                                              memory_order_relaxed,
+		                                              memory_order_relaxed)) {
+			return;
+		}
+	}
+}
+
+/** @brief Wykonuje jeden krok przeszukiwania.
+ * Wątek pobiera kolejne części bieżącego frontu i dociera z nich do
+ * sąsiednich wolnych pól.
+ * @param[in,out] worker 	- wskaźnik na stan wątku,
+ * @param[in] topology 		- topologia planszy, stała w miejscu wywołania.
+ */
+void expand_frontier_kernel(influence_worker_t *worker,
+                            gamma_topology_t topology) {
+	influence_t *influence = worker->influence;
+	gamma_t *g = influence->g;
+	size_t length = influence->frontier.length;
+	size_t chunks = (length + INFLUENCE_CHUNK - 1) / INFLUENCE_CHUNK;
+	uint64_t next_level = (uint64_t)(influence->level + 1) << 32;
+	for(size_t chunk = next_influence_chunk(influence, chunks); chunk < chunks;
+	    chunk = next_influence_chunk(influence, chunks)) {
+		size_t end = (chunk + 1) * INFLUENCE_CHUNK;
+		end = end < length ? end : length;
+		for(size_t i = chunk * INFLUENCE_CHUNK; i < end; i++) {
+			field_t field = influence->frontier.fields[i], around[NEIGHBOURS];
+			uint32_t nearest = (uint32_t)atomic_load_explicit(
+				&influence->states[(size_t)field.x * g->height + field.y],
+				memory_order_relaxed);
+			int count = topology_fields_around(g, topology, field.x, field.y,
+			                                   around);
+			for(int j = 0; j < count; j++) {
+				if(g->board[around[j].x][around[j].y] == 0) {
+					reach_field(worker, around[j], next_level | nearest);
+				}
 			}
 		}
 	}
-	return counter;
 }
 
+/** @brief Wykonuje jeden krok przeszukiwania.
+ * Wywołuje wersję @ref expand_frontier_kernel dla topologii planszy.
+ * @param[in,out] worker 	- wskaźnik na stan wątku.
+ */
+void expand_frontier(influence_worker_t *worker) {
+	switch(worker->influence->g->topology) {
+		case GAMMA_SQUARE_DIAGONAL:
+			expand_frontier_kernel(worker, GAMMA_SQUARE_DIAGONAL);
+			break;
+		case GAMMA_HEX:
+			expand_frontier_kernel(worker, GAMMA_HEX);
+			break;
+		case GAMMA_TORUS:
+			expand_frontier_kernel(worker, GAMMA_TORUS);
+			break;
+		default:
+			expand_frontier_kernel(worker, GAMMA_SQUARE);
+	}
+}
 
-/** @brief Dodaje pole do kolejki.
- * Funkcja dodaje do kolejki sąsiada podanego pola. O tym, którego z sąsiadów,
- * decydują wartości parametrów @p coordinate i @p factor.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[in,out] visited - plansza używana do oznaczania pól, które były wcześniej
- * 						dodane do kolejki,
- * @param[in,out] queue - wskaźnik na kolejkę,
- * @param[in] field 	- wskaźnik na strukurę pola, którego sąsiad ma
- * 						znaleźć się w kolejce,
- * @param[in] player 	- numer gracza, którego obszar jest przedmiotem przeszukiwania
- * 						metodą BFS,
- * @param[out] coordinate - wskaźnik na współrzędną(x lub y), będącą zmienną
- * 						struktury pola, która ma zostać zmodyfikowana,
- * @param[in] factor 	- czynnik o jaki należy zmodyfikować podaną współrzędną.
- */
-void add_to_queue(gamma_t *g, bool **visited, queue_t *queue, field_t *field,
-                  uint32_t player, uint32_t *coordinate, int factor) {
-	(*coordinate) += factor;
-	if(visited[field->x][field->y] == false
-	   && g->board[field->x][field->y] == player)  {
-		enqueue(queue, *field);
-		visited[field->x][field->y] = true;
-	}
-	(*coordinate) -= factor;
-}
-
-/** @brief Dodaje do kolejki wszystkie sąsiednie pola.
- * Korzysta z funkcji pomocniczej @ref add_to_queue, dodającej pojedyncze
- * pola-sąsiadów do kolejki.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[in,out] visited - plansza używana do oznaczania pól, które były wcześniej
- * 						dodane[in] do kolejki,
- * @param[in,out] queue - wskaźnik na kolejkę,
- * @param[in] field 	- pole, którego sąsiedzi mają być dodani do kolejki,
- * @param[in] player 	- numer gracza, którego obszar jest przedmiotem
- * 						przeszukiwania metodą BFS.
- */
-void add_to_queue_fields_around(gamma_t *g, bool **visited, queue_t *queue,
-                                field_t field, uint32_t player) {
-	
-	if((field.x) != 0) {
-		add_to_queue(g, visited, queue, &field, player, &(field.x), -1);
+/** @brief Przygotowuje następny front.
+ * Wywoływana przez wątek 0, gdy pozostałe czekają na barierze. Wyznacza
+ * miejsca, pod które wątki przepiszą osiągnięte pola, i kończy
+ * przeszukiwanie, gdy front jest pusty lub zabrakło pamięci.
+ * @param[in,out] influence - wskaźnik na stan obliczania mapy wpływów.
+ * @return Wartość @p true, jeśli przeszukiwanie trwa dalej lub @p false
+ * w przeciwnym wypadku.
+ */
+bool gather_frontier(influence_t *influence) {
+	size_t total = 0;
+	for(uint32_t i = 0; i < influence->threads; i++) {
+		influence->workers[i].offset = total;
+		total += influence->workers[i].next.length;
 	}
-	
-	if(field.x != UINT32_MAX && field.x + 1 < g->width) {//prawy sąsiad
-		add_to_queue(g, visited, queue, &field, player, &(field.x), 1);
+	if(influence->started) {
+		influence->level++;
 	}
-	
-	if((field.y) != 0) {//dolny sąsiad
-		add_to_queue(g, visited, queue, &field, player, &(field.y), -1);
+	influence->started = true;
+	atomic_store_explicit(&influence->next_chunk, 0, memory_order_relaxed);
+	if(total > influence->frontier.capacity
+	   && !atomic_load(&influence->failed)) {
+		field_t *fields = resize_memory(influence->frontier.memory,
+		                                GAMMA_MEMORY_INFLUENCE,
+		                                influence->frontier.fields,
+		                                influence->frontier.capacity
+		                                * sizeof(field_t),
+		                                total * sizeof(field_t));
+		if(fields) {
+			influence->frontier.fields = fields;
+			influence->frontier.capacity = total;
+		}
+		else {
+			atomic_store(&influence->failed, true);
+		}
 	}
-	
-	if(field.y != UINT32_MAX && field.y + 1 < g->height) {//górny sąsiad
-		add_to_queue(g, visited, queue, &field, player, &(field.y), 1);
+	influence->frontier.length = total;
+	return total > 0 && !atomic_load(&influence->failed);
+}
+
+/** @brief Zapisuje wyniki dla części planszy.
+ * Wątki dzielą się kolumnami planszy.
+ * @param[in,out] worker 	- wskaźnik na stan wątku.
+ */
+void write_influence(influence_worker_t *worker) {
+	influence_t *influence = worker->influence;
+	gamma_t *g = influence->g;
+	size_t columns = INFLUENCE_CHUNK / g->height + 1;
+	size_t chunks = (g->width + columns - 1) / columns;
+	for(size_t chunk = next_influence_chunk(influence, chunks); chunk < chunks;
+	    chunk = next_influence_chunk(influence, chunks)) {
+		uint32_t end = (uint32_t)((chunk + 1) * columns < g->width
+		                          ? (chunk + 1) * columns : g->width);
+		for(uint32_t x = (uint32_t)(chunk * columns); x < end; x++) {
+			size_t index = (size_t)x * g->height;
+			for(uint32_t y = 0; y < g->height; y++, index++) {
+				uint64_t state = atomic_load_explicit(&influence->states[index],
+				                                      memory_order_relaxed);
+				uint32_t nearest = state == UNREACHED ? 0 : (uint32_t)state;
+				if(influence->nearest != NULL) {
+					influence->nearest[index] = nearest;
+				}
+				if(influence->distance != NULL) {
+					influence->distance[index] = (uint32_t)(state >> 32);
+				}
+			}
+		}
 	}
 }
 
-/** @brief Wykonuje przeszukiwanie metodą BFS.
- * Funkcja najpierw dodaje do kolejki pierwsze pole, a potem pętli wszystkie
- * kolejne za pomocą funkcji @ref add_to_queue_fields_around. Pętla konczy się
- * w momencie opróżnienia kolejki.
- * Celem funkcji jest oznaczenie pól jednego obszaru na planszy @p visited.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[in] player 	- numer gracza, którego obszar jest przedmiotem
- * 						przeszukiwania metodą BFS,
- * @param[in,out] visited - plansza używana do oznaczania pól, które były
- * 						wcześniej dodane do kolejki,
- * @param[in] field 	- pole, od którego po zostać zaczęte przeszukiwanie BFS.
- */
-void make_BFS(gamma_t *g, uint32_t player, bool **visited, field_t field) {
-	queue_t queue = init_queue();
-	enqueue(&queue, field);
-	visited[field.x][field.y] = true;
-	do {
-		if(!empty_queue(queue)) {
-			field = dequeue(&queue);
-		}
-		add_to_queue_fields_around(g, visited, &queue, field, player);
-	} while(!empty_queue(queue));
-	
-	clear_queue(&queue);
+/** @brief Oblicza mapę wpływów razem z pozostałymi wątkami.
+ * Wykonywana przez każdy z wątków, również przez wątek wywołujący.
+ * @param[in,out] arg 	- wskaźnik na stan wątku (@ref influence_worker_t).
+ * @return Wartość NULL.
+ */
+void* influence_thread(void *arg) {
+	influence_worker_t *worker = arg;
+	influence_t *influence = worker->influence;
+	bool first = (worker == influence->workers);
+	init_influence_sources(worker);
+	while(true) {
+		wait_influence_barrier(&influence->barrier);
+		if(first) {
+			influence->finished = !gather_frontier(influence);
+		}
+		wait_influence_barrier(&influence->barrier);
+		if(influence->finished) {
+			break;
+		}
+		if(worker->next.length > 0) {
+			memcpy(influence->frontier.fields + worker->offset,
+			       worker->next.fields, worker->next.length * sizeof(field_t));
+			worker->next.length = 0;
+		}
+		wait_influence_barrier(&influence->barrier);
+		expand_frontier(worker);
+	}
+	if(!atomic_load(&influence->failed)) {
+		write_influence(worker);
+	}
+	return NULL;
 }
 
-/** @brief Sprawdza czy pole należy do nowego obszaru.
- * Funkcja wywołuje BFS dla sąsiada podanego pola. O tym, dla którego z sąsiadów,
- * decydują wartości parametrów @p coordinate i @p factor.
- * BFS jest wywołany jeśli zadany sąsiad jest częścią nowego,
- * dotąd nieoznaczonego obszaru. Jeśli pole sąsiada zostało oznaczone na planszy
- * @p visited to znaczy, że należy innego, już policzonego obszaru.
- * Wtedy BFS dla takiego pola jest pomijany.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[in,out] visited - plansza używana do oznaczania pól, które były wcześniej
- * 						dodane do kolejki,
- * @param[in] field 	- wskaźnik na strukurę pola, którego sąsiad ma
- * 						znaleźć się w kolejce,
- * @param[in] player 	- numer gracza, którego obszary chcemy sprawdzić,
- * @param[in] coordinate - wskaźnik na współrzędną(x lub y), będącą zmienną
- * 						struktury pola, która ma zostać zmodyfikowana,
- * @param[in] factor 	- czynnik o jaki należy zmodyfikować podaną współrzędną.
- * @return Wartość 1, jeśli pole należy do gracza i nie zostało oznaczone
- * wcześniej, czyli należy do nowego obszaru lub 0, jeśli nie spelnia tych
- * warunków.
- */
-bool is_another_area(gamma_t *g, bool **visited, field_t *field,
-                     uint32_t player, uint32_t *coordinate, int factor) {
-	bool another_area = false;
-	(*coordinate) += factor;
-	if(visited[field->x][field->y] == false
-	   && g->board[field->x][field->y] == player)  {
-		make_BFS(g, player, visited, *field);
-		another_area = true;
-	}
-	(*coordinate) -= factor;
-	return another_area;
-}
-
-/** @brief Liczy wszystkie gracza obszary znajdujące się wokół podanego pola.
- * W ten sposób sprawdzamy ile obszarów gracza zostanie połączonych w momencie
- * wykonania ruchu na pole o danych współrzędnych @p x i @p y. Dla każdego z
- * sąsiednich pól wywoływane jest osobne sprawdzenie czy jest częscią kolejnego,
- * nieoznaczonego obszaru. Jeśli pole zostało oznaczone na planszy @p visited
- * to znaczy, że należy do tego samego obszaru co któreś z innych sąsiednich pól.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[in] player 	- numer gracza, którego obszary chcemy sprawdzić,
- * @param[in] x 		- współrzędna pionowa pola na planszy.
- * @param[in] y 		- współrzędna pionowa pola na planszy.
- * @return Wartość od 0 do 4 (przy czym wartość 0 przy normalnym użyciu nigdy nie
- * zostanie uzyskana ze względu na istnienie funkcji @ref player_fields_around).
- * Wartość oznacza liczbę obszarów gracza, z którymi sąsiaduje pole.
- */
-int number_of_connected_areas(gamma_t *g, uint32_t player, uint32_t x,
-                              uint32_t y) {
-	bool **visited = (bool **)init_board(sizeof(uint8_t), g->width,
-	                                             g->height);
-	int counter = 0;
-	field_t field;
-	field.x = x;
-	field.y = y;
-	
-	if(field.x != 0) {//obszar lewego sąsiada
-		counter += is_another_area(g, visited, &field, player, &(field.x), -1);
+/** @brief Liczy wolne pola, dla których każdy z graczy jest najbliższy.
+ * Jedno przejście po stanach pól po zakończeniu przeszukiwania. Wynik ma
+ * po jednym elemencie dla każdego gracza, który wykonał ruch, więc nie
+ * zależy od liczby graczy podanej przy tworzeniu gry. Gracze bez pól, którzy
+ * nie mogą być najbliżsi żadnemu polu, są na koniec pomijani.
+ * @param[in] influence 	- wskaźnik na stan obliczania mapy wpływów,
+ * @param[out] territory 	- wskaźnik, pod który zostaje zapisana zaalokowana
+ * 							tablica wyników,
+ * @param[out] count 		- wskaźnik, pod który zostaje zapisana liczba
+ * 							elementów tablicy.
+ * @return Wartość @p true, jeśli udało się policzyć pola lub @p false, jeśli
+ * zabrakło pamięci.
+ */
+bool count_territory(influence_t *influence, gamma_territory_t **territory,
+                     uint32_t *count) {
+	gamma_t *g = influence->g;
+	size_t size = ((size_t)g->player_count + 1) * sizeof(gamma_territory_t);
+	gamma_territory_t *result = NULL;
+	if(charge_memory(g->memory, GAMMA_MEMORY_OUTPUT, size)) {
+		result = calloc(1, size);
+		discharge_memory(g->memory, GAMMA_MEMORY_OUTPUT, size);
 	}
-	
-	if(field.x != UINT32_MAX && field.x + 1 < g->width) {//obszar prawego sąsiada
-		counter += is_another_area(g, visited, &field, player, &(field.x), 1);
+	if(result == NULL) {
+		return false;
 	}
-	
-	if(field.y != 0) {//obszar dolnego sąsiada
-		counter += is_another_area(g, visited, &field, player, &(field.y), -1);
+	for(uint32_t i = 0; i < g->player_count; i++) {
+		result[i + 1].player = g->player_list[i].number;
 	}
-	
-	if(field.y != UINT32_MAX && field.y + 1 < g->height) {//obszar górnego sąsiada
-		counter += is_another_area(g, visited, &field, player, &(field.y), 1);
+
+	uint32_t last_player = 0;
+	size_t last_index = 0;
+	size_t index = 0;
+	for(uint32_t x = 0; x < g->width; x++) {
+		for(uint32_t y = 0; y < g->height; y++, index++) {
+			if(g->board[x][y] != 0) {
+				continue;
+			}
+			uint64_t state = atomic_load_explicit(&influence->states[index],
+			                                      memory_order_relaxed);
+			uint32_t nearest = state == UNREACHED ? 0 : (uint32_t)state;
+			if(nearest != last_player) {
+				last_player = nearest;
+				last_index = 0;
+				if(nearest != 0) {
+					player_t *owner = find_player(g, nearest);
+					last_index = (size_t)(owner - g->player_list) + 1;
+				}
+			}
+			result[last_index].fields++;
+		}
 	}
-	
-	delete_board((void **)visited, g->width);
-	return counter;
+
+	uint32_t kept = 1;
+	for(uint32_t i = 0; i < g->player_count; i++) {
+		if(g->player_list[i].busy_fields != 0) {
+			result[kept++] = result[i + 1];
+		}
+	}
+	qsort(result + 1, kept - 1, sizeof(gamma_territory_t), compare_territories);
+	*territory = result;
+	*count = kept;
+	return true;
 }
 
-/** @brief Wywołuje funkcję liczącą obszary właściciela na planszy.
- * W ten sposób sprawdzamy ile obszarów właściciela zostanie rozdzielonych przy
- * złotym ruchu innego gracza na dane pole. Liczymy to tak samo jak liczbę
- * obszarów połączonych przez normalny ruch, przy czym przed wywołaniem funkcji
- * @ref number_of_connected_areas chwilowo ustawiamy dane pole na puste.
- * @param[in] g 	- wskaźnik na strukturę przechowującą stan gry,
- * @param[in] owner - obecny właściciel pola,
- * @param[in] x 	- współrzędna pozioma pola na planszy,
- * @param[in] y 	- współrzędna pionowa pola na planszy.
- * @return Wartość od 0 do 4, w  zależności ile obszarów właściciel zostanie
- * rozdzielonych.
+/** @brief Porównuje wyniki dwóch graczy według ich numerów.
+ * Używana do sortowania wyników funkcją qsort.
+ * @param[in] first 	- wskaźnik na pierwszy wynik,
+ * @param[in] second 	- wskaźnik na drugi wynik.
+ * @return Liczba ujemna, zero lub liczba dodatnia, zależnie od tego, czy
+ * numer pierwszego gracza jest mniejszy, równy czy większy od numeru
+ * drugiego.
  */
-int number_of_split_areas(gamma_t *g, uint32_t owner, uint32_t x, uint32_t y) {
-	g->board[x][y] = 0;
-	int number = number_of_connected_areas(g, owner, x, y);
-	g->board[x][y] = owner;
-	return number;
+int compare_territories(const void *first, const void *second) {
+	uint32_t a = ((const gamma_territory_t*)first)->player;
+	uint32_t b = ((const gamma_territory_t*)second)->player;
+	return (a > b) - (a < b);
 }
 
-
-/** @brief Tworzy napis odpowiadający zawartości planszy.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry.
+/** @brief Tworzy fragment napisu opisującego stan planszy.
+ * Gdy liczba graczy ma więcej niż 1 cyfrę, pola zajmują po tyle znaków, ile
+ * cyfr ma liczba graczy, i są oddzielane spacją.
+ * @param[in] g 			- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] first_row 	- numer pierwszej linijki, licząc od górnego
+ * 							wiersza planszy,
+ * @param[in] rows 			- liczba linijek, tak aby ostatnia leżała na
+ * 							planszy,
+ * @param[out] length 		- wskaźnik, pod który zostaje zapisana długość
+ * 							napisu.
  * @return Wskaźnik na zaalokowany napis lub NULL, jeśli zabrakło pamięci.
  */
-char* standard_board(gamma_t *g) {
-	uint32_t width = g->width;
-	uint32_t height = g->height;
-	int k = 0;
-	size_t memory_amount = ((width + 1) * height) + 1;
-	char *gamma_board = calloc(memory_amount, sizeof(char));
+char* board_rows(gamma_t *g, uint32_t first_row, uint32_t rows,
+                 size_t *length) {
+	size_t max_num_of_digits = number_of_digits(g->players);
+	size_t cell = (max_num_of_digits == 1 ? 1 : max_num_of_digits + 1);
+	uint64_t memory_amount = ((uint64_t)g->width * cell + 1) * rows + 1;
+	if(memory_amount > SIZE_MAX
+	   || !charge_memory(g->memory, GAMMA_MEMORY_OUTPUT,
+	                     (size_t)memory_amount)) {
+		errno = 0;
+		return NULL;
+	}
+	char *gamma_board = malloc((size_t)memory_amount);
 	if(!gamma_board) {
+		discharge_memory(g->memory, GAMMA_MEMORY_OUTPUT, (size_t)memory_amount);
 		errno = 0;
 		return NULL;
 	}
-	
-	for(int i = (int)height - 1; i >= 0; i--) {
-		for(uint32_t j = 0; j < width; j++) {
-			if(g->board[j][i] != 0) {
-				gamma_board[k] = g->board[j][i] + '0';
+
+	char *position = gamma_board;
+	for(uint32_t r = 0; r < rows; r++) {
+		uint32_t y = g->height - 1 - (first_row + r);
+		for(uint32_t x = 0; x < g->width; x++) {
+			uint32_t owner = g->board[x][y];
+			size_t written = 1;
+			if(owner == 0) {
+				*position = '.';
+			}
+			else if(max_num_of_digits == 1) {
+				*position = (char)(owner + '0');
 			}
 			else {
-				gamma_board[k] = '.';
+				written = (size_t)sprintf(position, "%u", owner);
 			}
-			k++;
+			memset(position + written, ' ', cell - written);
+			position += cell;
 		}
-		gamma_board[k] = '\n';
-		k++;
+		*position++ = '\n';
 	}
-	gamma_board[k] = '\0';
-	
+	*position = '\0';
+	discharge_memory(g->memory, GAMMA_MEMORY_OUTPUT, (size_t)memory_amount);
+	*length = (size_t)(position - gamma_board);
 	return gamma_board;
 }
 
-/** @brief Tworzy napis opisujący stan planszy, wersja dla liczby graczy >9.
- * W przypadku, gdy liczba graczy ma więcej niż 1 cyfrę, kolumny
- * planszy oddzielamy spacją.
- * @param[in] g 				- wskaźnik na strukturę przechowującą stan gry,
- * @param[in] max_num_of_digits - maksymalna ilość cyfr w numerze gracza.
- * @return Wskaźnik na zaalokowany napis lub NULL, jeśli zabrakło pamięci.
+/** @brief Zapewnia miejsce w buforze zrzutu planszy.
+ * W razie potrzeby powiększa bufor co najmniej dwukrotnie.
+ * @param[in,out] buffer 	- wskaźnik na bufor zrzutu,
+ * @param[in] length 		- liczba bajtów, które mają zostać dopisane.
+ * @return Wartość @p true, jeśli w buforze jest miejsce lub @p false,
+ * jeśli zabrakło pamięci.
  */
-char* board_for_multiple_digits_players(gamma_t *g, size_t max_num_of_digits) {
-	uint32_t width = g->width;
-	uint32_t height = g->height;
-	int k = 0;
-	size_t memory_amount = (((max_num_of_digits + 1) * width + 1) * height) + 1;
-	char *gamma_board = calloc(memory_amount, sizeof(char));
-	if(!gamma_board) {
-		errno = 0;
-		return NULL;
+bool reserve_rle_buffer(rle_buffer_t *buffer, size_t length) {
+	if(buffer->length + length <= buffer->capacity) {
+		return true;
 	}
-	
-	for(int i = (int)height - 1; i >= 0; i--) {
-		for(uint32_t j = 0; j < width; j++) {
-			if(g->board[j][i] != 0) {
-				char num_str[UINT_LIMIT];
-				size_t num_of_digits = number_of_digits(g->board[j][i]);
-				sprintf(num_str, "%u", g->board[j][i]);
-				strcat(gamma_board, num_str);
-				k += num_of_digits;
-				for(uint32_t l = 0; l <= max_num_of_digits - num_of_digits; l++) {
-					gamma_board[k] = ' ';
-					k++;
-				}
-			}
-			else {
-				gamma_board[k] = '.';
-				k++;
-				for(uint32_t l = 0; l < max_num_of_digits; l++) {
-					gamma_board[k] = ' ';
-					k++;
-				}
+	size_t capacity = buffer->capacity ? 2 * buffer->capacity
+	                                   : RLE_INITIAL_CAPACITY;
+	if(capacity < buffer->length + length) {
+		capacity = buffer->length + length;
+	}
+	char *data = resize_memory(buffer->memory, GAMMA_MEMORY_OUTPUT,
+	                           buffer->data, buffer->capacity, capacity);
+	if(!data) {
+		return false;
+	}
+	buffer->data = data;
+	buffer->capacity = capacity;
+	return true;
+}
+
+/** @brief Dopisuje do zrzutu planszy liczbę w kodowaniu varint.
+ * @param[in,out] buffer 	- wskaźnik na bufor zrzutu,
+ * @param[in] number 		- dopisywana liczba.
+ * @return Wartość @p true, jeśli udało się dopisać liczbę lub @p false,
+ * jeśli zabrakło pamięci.
+ */
+bool append_rle_number(rle_buffer_t *buffer, uint64_t number) {
+	if(!reserve_rle_buffer(buffer, RLE_VARINT_LIMIT)) {
+		return false;
+	}
+	while(number >= 0x80) {
+		buffer->data[buffer->length++] = (char)(number | 0x80);
+		number >>= 7;
+	}
+	buffer->data[buffer->length++] = (char)number;
+	return true;
+}
+
+/** @brief Koduje pas kolejnych wierszy planszy.
+ * @param[in] g 			- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] band 		- wskaźnik na pas, którego bufory wierszy zostają
+ * 							wypełnione seriami,
+ * @param[in] bottom 		- numer dolnego wiersza pasa,
+ * @param[in] rows 			- liczba wierszy pasa, od 1 do @ref RLE_BAND_ROWS.
+ * @return Wartość @p true, jeśli udało się zakodować pas lub @p false,
+ * jeśli zabrakło pamięci.
+ */
+bool encode_rle_band(gamma_t *g, rle_band_t *band, uint32_t bottom,
+                     uint32_t rows) {
+	bool correct = true;
+	for(uint32_t r = 0; r < rows; r++) {
+		band->rows[r].length = 0;
+		band->owners[r] = g->board[0][bottom + r];
+		band->starts[r] = 0;
+	}
+	for(uint32_t j = 1; j < g->width; j++) {
+		const uint32_t *column = g->board[j] + bottom;
+		for(uint32_t r = 0; r < rows; r++) {
+			if(column[r] != band->owners[r]) {
+				correct = correct
+				          && append_rle_number(&band->rows[r], band->owners[r])
+				          && append_rle_number(&band->rows[r],
+				                               j - band->starts[r]);
+				band->owners[r] = column[r];
+				band->starts[r] = j;
 			}
 		}
-		gamma_board[k] = '\n';
-		k++;
 	}
-	gamma_board[k] = '\0';
-	
-	return gamma_board;
+	for(uint32_t r = 0; r < rows; r++) {
+		correct = correct && append_rle_number(&band->rows[r], band->owners[r])
+		          && append_rle_number(&band->rows[r],
+		                               g->width - band->starts[r]);
+	}
+	return correct;
 }
 
 
@@ -431,51 +2546,154 @@ uint32_t gamma_height(gamma_t *g) {
 	return g->height;
 }
 
+gamma_topology_t gamma_topology(gamma_t *g) {
+	return g->topology;
+}
+
+uint32_t gamma_field_owner(gamma_t *g, uint32_t x, uint32_t y) {
+	if(g == NULL || x >= g->width || y >= g->height) {
+		return 0;
+	}
+	lock_for_reading(g);
+	uint32_t owner = g->board[x][y];
+	unlock_game(g);
+	return owner;
+}
+
 gamma_t* gamma_new(uint32_t width, uint32_t height,
 					uint32_t players, uint32_t areas) {
+	return gamma_new_ex(width, height, players, areas, GAMMA_SQUARE);
+}
+
+gamma_t* gamma_new_ex(uint32_t width, uint32_t height, uint32_t players,
+                      uint32_t areas, gamma_topology_t topology) {
+	gamma_options_t options = {topology, 0, NULL, 0};
+	return gamma_new_with_options(width, height, players, areas, &options);
+}
+
+gamma_t* gamma_new_with_options(uint32_t width, uint32_t height,
+                                uint32_t players, uint32_t areas,
+                                const gamma_options_t *options) {
 	if(width <= 0 || height <= 0 || players <= 0 || areas <= 0
-	|| (uint64_t)width * (uint64_t)height > BOARD_SIZE_HARD_LIMIT) {
+	|| (uint64_t)width * (uint64_t)height > BOARD_SIZE_HARD_LIMIT
+	|| options == NULL
+	|| (options->topology != GAMMA_SQUARE
+	    && options->topology != GAMMA_SQUARE_DIAGONAL
+	    && options->topology != GAMMA_HEX && options->topology != GAMMA_TORUS)) {
 		return NULL;
 	}
 
-	gamma_t *g = malloc(sizeof(gamma_t));
+	memory_t *memory = new_memory(options);
+	gamma_t *g = NULL;
+	if(memory) {
+		g = allocate_memory(memory, GAMMA_MEMORY_GAME, sizeof(gamma_t), true);
+	}
 	if(!g) {
+		delete_memory(memory);
 		errno = 0;
 		return NULL;
 	}
 
-	g->board = (uint32_t **)init_board(sizeof(uint32_t), width, height);
-	g->busy_fields = calloc((size_t)players + 1, sizeof(uint64_t));
-	g->free_fields = calloc((size_t)players + 1,  sizeof(uint64_t));
-	g->areas = calloc((size_t)players + 1, sizeof(uint32_t));
-	g->golden_move_available = calloc((size_t)players + 1, sizeof(bool));
-	
+	g->memory = memory;
 	g->all_free_fields = (uint64_t)width * (uint64_t)height;
 	g->width = width;
 	g->height = height;
 	g->players = players;
 	g->max_areas = areas;
+	g->topology = options->topology;
+	g->queue = init_queue(memory);
+	g->area_list = NULL;
+	g->area_capacity = 0;
+	g->next_area_id = 1;
+	g->free_area_id = 0;
+	g->players_with_fields = 0;
+	g->players_with_move = players;
+	g->player_bits = 0;
+	while((UINT64_C(1) << g->player_bits) <= players) {
+		(g->player_bits)++;
+	}
+	g->blocked_nodes = 1;
+	g->lock = NULL;
+
+	g->board = new_board(g);
+	g->area_ids = new_board(g);
 	
-	if(!(g->board) || !(g->busy_fields) || !(g->free_fields)
-		|| !(g->areas) || !(g->golden_move_available)) {
+	if(!(g->board) || !(g->area_ids)) {
 		errno = 0;
 		gamma_delete(g);
 		return NULL;
 	}
-	init_boolean_array(g->golden_move_available, players + 1);
 	
 	return g;
 }
 
+bool gamma_memory_usage(gamma_t *g, gamma_memory_t *usage) {
+	if(g == NULL || usage == NULL) {
+		return false;
+	}
+	read_memory(g->memory, usage);
+	return true;
+}
+
 void gamma_delete(gamma_t *g) {
-	if(g != NULL) {
-		delete_board((void **)g->board, g->width);
-		free(g->busy_fields);
-		free(g->free_fields);
-		free(g->areas);
-		free(g->golden_move_available);
-		free(g);
+	if(g != NULL && memory_in_arena(g->memory)) {
+		if(g->lock != NULL) {
+			pthread_rwlock_destroy(g->lock);
+		}
+		delete_memory(g->memory);
+	}
+	else if(g != NULL) {
+		memory_t *memory = g->memory;
+		delete_board(g, g->board);
+		delete_board(g, g->area_ids);
+		release_memory(memory, GAMMA_MEMORY_PLAYERS, g->player_list,
+		               g->player_capacity * sizeof(player_t));
+		release_memory(memory, GAMMA_MEMORY_PLAYERS, g->player_slots,
+		               g->slot_capacity * sizeof(uint32_t));
+		release_memory(memory, GAMMA_MEMORY_PLAYERS, g->blocked_tree,
+		               g->blocked_capacity * sizeof(blocked_node_t));
+		release_memory(memory, GAMMA_MEMORY_AREAS, g->area_list,
+		               g->area_capacity * sizeof(area_t));
+		delete_queue(&g->queue);
+		if(g->lock != NULL) {
+			pthread_rwlock_destroy(g->lock);
+			release_memory(memory, GAMMA_MEMORY_GAME, g->lock,
+			               sizeof(pthread_rwlock_t));
+		}
+		release_memory(memory, GAMMA_MEMORY_GAME, g, sizeof(gamma_t));
+		delete_memory(memory);
+	}
+}
+
+bool gamma_enable_concurrency(gamma_t *g) {
+	if(g == NULL) {
+		return false;
+	}
+	if(g->lock != NULL) {
+		return true;
+	}
+
+	pthread_rwlockattr_t attributes;
+	if(pthread_rwlockattr_init(&attributes) != 0) {
+		errno = 0;
+		return false;
+	}
+	// Ciągłe odczyty nie mogą zagłodzić wątku wykonującego ruchy.
+	pthread_rwlockattr_setkind_np(&attributes,
+	                              PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+	g->lock = allocate_memory(g->memory, GAMMA_MEMORY_GAME,
+	                          sizeof(pthread_rwlock_t), false);
+	if(g->lock && pthread_rwlock_init(g->lock, &attributes) != 0) {
+		release_memory(g->memory, GAMMA_MEMORY_GAME, g->lock,
+		               sizeof(pthread_rwlock_t));
+		g->lock = NULL;
+	}
+	pthread_rwlockattr_destroy(&attributes);
+	if(!(g->lock)) {
+		errno = 0;
+		return false;
 	}
+	return true;
 }
 
 bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
@@ -484,76 +2702,138 @@ bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
 		return false;
 	}
 
-	if ((g->board[x][y] != 0)
-		|| (!player_fields_around(g, player, x, y)
-			&& g->areas[player] == g->max_areas)) {
+	lock_for_writing(g);
+	bool moved = take_free_field(g, player, x, y);
+	unlock_game(g);
+	return moved;
+}
+
+bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+	if(g == NULL || player > (g->players) || player <= 0 || x >= (g->width)
+		|| y >= (g->height)) {
 		return false;
 	}
-	else {
-		if(!player_fields_around(g, player, x, y)) {
-			(g->areas[player])++;
+
+	lock_for_writing(g);
+	bool moved = take_busy_field(g, player, x, y);
+	unlock_game(g);
+	return moved;
+}
+
+uint64_t gamma_move_batch(gamma_t *g, const gamma_move_t *moves, size_t count,
+                          uint64_t *results) {
+	if(results != NULL) {
+		memset(results, 0, (count + 63) / 64 * sizeof(uint64_t));
+	}
+	if(g == NULL || moves == NULL) {
+		return 0;
+	}
+
+	uint64_t made = 0;
+	lock_for_writing(g);
+	for(size_t i = 0; i < count; i++) {
+		const gamma_move_t *move = &moves[i];
+		if(move->player > g->players || move->player == 0
+		   || move->x >= g->width || move->y >= g->height) {
+			continue;
 		}
-		else {
-			g->areas[player] -= number_of_connected_areas(g, player, x, y) - 1;
+		bool moved = move->golden
+		             ? take_busy_field(g, move->player, move->x, move->y)
+		             : take_free_field(g, move->player, move->x, move->y);
+		if(moved) {
+			made++;
+			if(results != NULL) {
+				results[i / 64] |= (uint64_t)1 << (i % 64);
+			}
 		}
-		(g->busy_fields[player])++;
-		(g->all_free_fields)--;
-		g->board[x][y] = player;
-		return true;
 	}
+	unlock_game(g);
+	return made;
 }
 
-bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+bool gamma_try_move(const gamma_t *g, uint32_t player, uint32_t x, uint32_t y,
+                    gamma_probe_t *probe) {
 	if(g == NULL || player > (g->players) || player <= 0 || x >= (g->width)
 		|| y >= (g->height)) {
 		return false;
 	}
 
-	uint32_t current_owner = g->board[x][y];
-	int var_number_of_split_areas = number_of_split_areas(g, current_owner, x, y);
-	
-	if(!(g->golden_move_available[player])
-		|| g->board[x][y] == 0
-		|| g->board[x][y] == player
-		|| (!player_fields_around(g, player, x, y) && g->areas[player] == g->max_areas)
-		|| (g->areas[current_owner] + var_number_of_split_areas - 1 > g->max_areas)) {
+	uint32_t ids[NEIGHBOURS];
+	field_t seeds[NEIGHBOURS];
+	lock_for_reading(g);
+	bool legal = (g->board[x][y] == 0);
+	int connected_areas = legal ? adjacent_areas(g, player, x, y, ids, seeds)
+	                            : 0;
+	legal = legal && (connected_areas != 0
+	                  || player_state(g, player)->areas != g->max_areas);
+	unlock_game(g);
+	if(legal && probe != NULL) {
+		probe->owner = 0;
+		probe->player_areas = 1 - connected_areas;
+		probe->owner_areas = 0;
+		probe->player_busy = 1;
+		probe->owner_busy = 0;
+	}
+	return legal;
+}
+
+bool gamma_try_golden_move(const gamma_t *g, uint32_t player, uint32_t x,
+                           uint32_t y, gamma_probe_t *probe) {
+	if(g == NULL || player > (g->players) || player <= 0 || x >= (g->width)
+		|| y >= (g->height)) {
 		return false;
 	}
-	else {
-		if(!player_fields_around(g, player, x, y)) {
-			(g->areas[player])++;
-		}
-		else {
-			g->areas[player] -= number_of_connected_areas(g, player, x, y) - 1;
-		}
-		g->areas[current_owner] += var_number_of_split_areas - 1;
-		(g->busy_fields[current_owner])--;
-		(g->busy_fields[player])++;
-		g->golden_move_available[player] = false;
-		g->board[x][y] = player;
-		return true;
+
+	lock_for_reading(g);
+	uint32_t current_owner = g->board[x][y];
+	uint32_t ids[NEIGHBOURS];
+	field_t seeds[NEIGHBOURS];
+	int connected_areas = adjacent_areas(g, player, x, y, ids, seeds);
+	int split_areas;
+	const player_t *state = player_state(g, player);
+	bool legal = state->golden_move_available
+		&& current_owner != 0
+		&& current_owner != player
+		&& (connected_areas != 0 || state->areas != g->max_areas)
+		&& count_pieces(g, x, y, &split_areas)
+		&& player_state(g, current_owner)->areas + split_areas - 1
+		   <= g->max_areas;
+	unlock_game(g);
+	if(legal && probe != NULL) {
+		probe->owner = current_owner;
+		probe->player_areas = 1 - connected_areas;
+		probe->owner_areas = split_areas - 1;
+		probe->player_busy = 1;
+		probe->owner_busy = -1;
 	}
+	return legal;
 }
 
 uint64_t gamma_busy_fields(gamma_t *g, uint32_t player) {
 	if(g == NULL || player > g->players || player <= 0) {
 		return 0;
 	}
-	else {
-		return g->busy_fields[player];
-	}
+
+	lock_for_reading(g);
+	uint64_t busy_fields = player_state(g, player)->busy_fields;
+	unlock_game(g);
+	return busy_fields;
 }
 
 uint64_t gamma_free_fields(gamma_t *g, uint32_t player) {
 	if(g == NULL || player > g->players || player <= 0) {
 		return 0;
 	}
-	else if(g->areas[player] < g->max_areas) {
-		return g->all_free_fields;
-	}
-	else {
-		return count_free_fields(g, player);
+
+	lock_for_reading(g);
+	uint64_t free_fields = g->all_free_fields;
+	const player_t *state = player_state(g, player);
+	if(state->areas >= g->max_areas) {
+		free_fields = state->free_edges != 0
+		              ? count_free_fields(g, player) : 0;
 	}
+	unlock_game(g);
+	return free_fields;
 }
 
 bool gamma_golden_possible(gamma_t *g, uint32_t player) {
@@ -561,13 +2841,69 @@ bool gamma_golden_possible(gamma_t *g, uint32_t player) {
 		return false;
 	}
 
-	if(g->golden_move_available[player]
-		&& busy_fields_available(g->busy_fields, g->players, player)) {
-		return true;
-	}
-	else {
+	lock_for_reading(g);
+	const player_t *state = player_state(g, player);
+	uint64_t busy_fields = (uint64_t)g->width * g->height - g->all_free_fields;
+	bool possible = state->golden_move_available
+		&& busy_fields > state->busy_fields;
+	unlock_game(g);
+	return possible;
+}
+
+bool gamma_game_over(gamma_t *g) {
+	if(g == NULL) {
 		return false;
 	}
+
+	lock_for_reading(g);
+	bool over = (g->players_with_move == 0);
+	unlock_game(g);
+	return over;
+}
+
+uint32_t gamma_next_player_with_move(gamma_t *g, uint32_t from) {
+	if(g == NULL) {
+		return 0;
+	}
+
+	lock_for_reading(g);
+	uint64_t player = 0;
+	if(g->players_with_move != 0) {
+		player = first_unblocked(g, g->blocked_root, g->player_bits, 0,
+		                         from < g->players ? (uint64_t)from + 1 : 1);
+		if(player > g->players) {
+			player = first_unblocked(g, g->blocked_root, g->player_bits, 0, 1);
+		}
+	}
+	unlock_game(g);
+	return (uint32_t)player;
+}
+
+uint32_t* gamma_active_players(gamma_t *g, uint32_t *count) {
+	if(g == NULL || count == NULL) {
+		return NULL;
+	}
+
+	lock_for_reading(g);
+	size_t size = ((size_t)g->player_count + 1) * sizeof(uint32_t);
+	uint32_t *players = NULL;
+	if(charge_memory(g->memory, GAMMA_MEMORY_OUTPUT, size)) {
+		players = malloc(size);
+		discharge_memory(g->memory, GAMMA_MEMORY_OUTPUT, size);
+	}
+	if(players != NULL) {
+		for(uint32_t i = 0; i < g->player_count; i++) {
+			players[i] = g->player_list[i].number;
+		}
+		*count = g->player_count;
+	}
+	unlock_game(g);
+	if(players == NULL) {
+		errno = 0;
+		return NULL;
+	}
+	qsort(players, *count, sizeof(uint32_t), compare_player_numbers);
+	return players;
 }
 
 char* gamma_board(gamma_t *g) {
@@ -575,15 +2911,209 @@ char* gamma_board(gamma_t *g) {
 		return NULL;
 	}
 	
-	char *gamma_board = NULL;
-	int max_num_of_digits = number_of_digits(g->players);
-	
-	if(max_num_of_digits == 1) {
-		gamma_board = standard_board(g);
+	size_t length;
+	lock_for_reading(g);
+	char *gamma_board = board_rows(g, 0, g->height, &length);
+	unlock_game(g);
+
+	return gamma_board;
+}
+
+char* gamma_board_rows(gamma_t *g, uint32_t first_row, uint32_t rows,
+                       size_t *length) {
+	if(g == NULL || length == NULL || first_row >= g->height || rows == 0) {
+		return NULL;
 	}
-	else {
-		gamma_board = board_for_multiple_digits_players(g, max_num_of_digits);
+
+	if(rows > g->height - first_row) {
+		rows = g->height - first_row;
 	}
+	lock_for_reading(g);
+	char *gamma_board = board_rows(g, first_row, rows, length);
+	unlock_game(g);
 
 	return gamma_board;
 }
+
+char* gamma_board_rle(gamma_t *g, size_t *length) {
+	if(g == NULL || length == NULL) {
+		return NULL;
+	}
+
+	rle_buffer_t buffer = {NULL, 0, 0, g->memory};
+	rle_band_t band;
+	for(uint32_t r = 0; r < RLE_BAND_ROWS; r++) {
+		band.rows[r] = buffer;
+	}
+	bool correct = reserve_rle_buffer(&buffer, RLE_MAGIC_LENGTH);
+	if(correct) {
+		memcpy(buffer.data, RLE_MAGIC, RLE_MAGIC_LENGTH);
+		buffer.length = RLE_MAGIC_LENGTH;
+	}
+	correct = correct && append_rle_number(&buffer, g->width)
+	          && append_rle_number(&buffer, g->height)
+	          && append_rle_number(&buffer, g->players);
+	
+	uint32_t top = g->height;
+	lock_for_reading(g);
+	while(correct && top > 0) {
+		uint32_t rows = top < RLE_BAND_ROWS ? top : RLE_BAND_ROWS;
+		top -= rows;
+		correct = encode_rle_band(g, &band, top, rows);
+		for(uint32_t r = rows; correct && r-- > 0;) {
+			correct = reserve_rle_buffer(&buffer, band.rows[r].length);
+			if(correct) {
+				memcpy(buffer.data + buffer.length, band.rows[r].data,
+				       band.rows[r].length);
+				buffer.length += band.rows[r].length;
+			}
+		}
+	}
+	unlock_game(g);
+	for(uint32_t r = 0; r < RLE_BAND_ROWS; r++) {
+		release_memory(g->memory, GAMMA_MEMORY_OUTPUT, band.rows[r].data,
+		               band.rows[r].capacity);
+	}
+	if(!correct) {
+		release_memory(g->memory, GAMMA_MEMORY_OUTPUT, buffer.data,
+		               buffer.capacity);
+		errno = 0;
+		return NULL;
+	}
+
+	discharge_memory(g->memory, GAMMA_MEMORY_OUTPUT, buffer.capacity);
+	*length = buffer.length;
+	return buffer.data;
+}
+
+uint32_t gamma_area_at(gamma_t *g, uint32_t x, uint32_t y) {
+	if(g == NULL || x >= g->width || y >= g->height) {
+		return 0;
+	}
+	lock_for_reading(g);
+	uint32_t area = g->area_ids[x][y];
+	unlock_game(g);
+	return area;
+}
+
+bool gamma_area_info(gamma_t *g, uint32_t area, gamma_area_t *info) {
+	if(g == NULL || info == NULL || area == 0) {
+		return false;
+	}
+
+	lock_for_reading(g);
+	bool exists = area < g->next_area_id && g->area_list[area].info.size != 0;
+	if(exists) {
+		*info = g->area_list[area].info;
+	}
+	unlock_game(g);
+	return exists;
+}
+
+uint32_t gamma_first_area(gamma_t *g, uint32_t player) {
+	if(g == NULL || player > g->players || player <= 0) {
+		return 0;
+	}
+	lock_for_reading(g);
+	uint32_t area = player_state(g, player)->first_area;
+	unlock_game(g);
+	return area;
+}
+
+uint32_t gamma_next_area(gamma_t *g, uint32_t area) {
+	if(g == NULL || area == 0) {
+		return 0;
+	}
+
+	lock_for_reading(g);
+	uint32_t next = 0;
+	if(area < g->next_area_id && g->area_list[area].info.size != 0) {
+		next = g->area_list[area].next;
+	}
+	unlock_game(g);
+	return next;
+}
+
+bool gamma_influence_map(gamma_t *g, uint32_t threads, uint32_t *nearest,
+                         uint32_t *distance, gamma_territory_t **territory,
+                         uint32_t *count) {
+	if(g == NULL || (territory != NULL && count == NULL)) {
+		return false;
+	}
+
+	size_t fields = (size_t)g->width * g->height;
+	if(threads == 0) {
+		long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = processors > 0 ? (uint32_t)processors : 1;
+	}
+	if(threads > MAX_INFLUENCE_THREADS) {
+		threads = MAX_INFLUENCE_THREADS;
+	}
+	if(threads > fields / INFLUENCE_CHUNK + 1) {
+		threads = (uint32_t)(fields / INFLUENCE_CHUNK + 1);
+	}
+
+	influence_t influence;
+	influence.g = g;
+	influence.states = allocate_memory(g->memory, GAMMA_MEMORY_INFLUENCE,
+	                                   fields * sizeof(_Atomic uint64_t),
+	                                   false);
+	influence.workers = allocate_memory(g->memory, GAMMA_MEMORY_INFLUENCE,
+	                                    threads * sizeof(influence_worker_t),
+	                                    true);
+	influence.frontier = (field_list_t){NULL, 0, 0, g->memory};
+	bool correct = influence.states && influence.workers;
+	for(uint32_t i = 0; correct && i < threads; i++) {
+		influence_worker_t *worker = &influence.workers[i];
+		worker->influence = &influence;
+		worker->next.memory = g->memory;
+	}
+	if(correct) {
+		atomic_init(&influence.next_chunk, 0);
+		atomic_init(&influence.failed, false);
+		influence.started = influence.finished = false;
+		influence.level = 0;
+		influence.nearest = nearest;
+		influence.distance = distance;
+		influence.threads = threads;
+		init_influence_barrier(&influence.barrier, threads);
+		lock_for_reading(g);
+		uint32_t started = 1;
+		for(uint32_t i = 1; i < threads; i++) {
+			if(pthread_create(&influence.workers[started].thread, NULL,
+			                  influence_thread, &influence.workers[started]) == 0) {
+				started++;
+			}
+			else {
+				leave_influence_barrier(&influence.barrier);
+			}
+		}
+		influence.threads = started;
+		influence_thread(&influence.workers[0]);
+		for(uint32_t i = 1; i < started; i++) {
+			pthread_join(influence.workers[i].thread, NULL);
+		}
+		pthread_cond_destroy(&influence.barrier.passed);
+		pthread_mutex_destroy(&influence.barrier.lock);
+		correct = !atomic_load(&influence.failed);
+		if(correct && territory != NULL) {
+			correct = count_territory(&influence, territory, count);
+		}
+		unlock_game(g);
+	}
+	for(uint32_t i = 0; influence.workers && i < threads; i++) {
+		release_memory(g->memory, GAMMA_MEMORY_INFLUENCE,
+		               influence.workers[i].next.fields,
+		               influence.workers[i].next.capacity * sizeof(field_t));
+	}
+	release_memory(g->memory, GAMMA_MEMORY_INFLUENCE, influence.workers,
+	               threads * sizeof(influence_worker_t));
+	release_memory(g->memory, GAMMA_MEMORY_INFLUENCE, influence.frontier.fields,
+	               influence.frontier.capacity * sizeof(field_t));
+	release_memory(g->memory, GAMMA_MEMORY_INFLUENCE, influence.states,
+	               fields * sizeof(_Atomic uint64_t));
+	if(!correct) {
+		errno = 0;
+	}
+	return correct;
+}
@@ -11,6 +11,7 @@
 #define GAMMA_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -18,6 +19,128 @@
  */
 typedef struct gamma gamma_t;
 
+/**
+ * Sposób, w jaki pola planszy sąsiadują ze sobą. Od topologii zależy, które
+ * pola tworzą obszar i na które pola może wejść gracz, który osiągnął limit
+ * obszarów. Na planszy @ref GAMMA_HEX sąsiadami pola (x, y) są pola
+ * (x ± 1, y), (x, y ± 1), (x + 1, y - 1) i (x - 1, y + 1).
+ */
+typedef enum gamma_topology {
+	GAMMA_SQUARE, 			///< sąsiedzi w poziomie i w pionie
+	GAMMA_SQUARE_DIAGONAL, 	///< sąsiedzi także po przekątnych
+	GAMMA_HEX, 				///< pola sześciokątne na planszy w kształcie rombu
+	GAMMA_TORUS 			///< jak @ref GAMMA_SQUARE, przeciwne brzegi sklejone
+} gamma_topology_t;
+
+/**
+ * Rodzaj pamięci używanej przez grę, zob. @ref gamma_memory_usage.
+ */
+typedef enum gamma_memory_category {
+	GAMMA_MEMORY_GAME, 		///< struktura gry i zamek trybu współbieżnego
+	GAMMA_MEMORY_BOARD, 	///< plansza i identyfikatory obszarów jej pól
+	GAMMA_MEMORY_PLAYERS, 	///< stany graczy, którzy wykonali ruch
+	GAMMA_MEMORY_AREAS, 	///< tablica obszarów
+	GAMMA_MEMORY_SEARCH, 	/**< kolejki przeszukiwań BFS i zbiory
+ * 							odwiedzonych pól */
+	GAMMA_MEMORY_OUTPUT, 	/**< napisy i zrzuty planszy, do chwili
+ * 							przekazania ich wywołującemu */
+	GAMMA_MEMORY_INFLUENCE, ///< dane pomocnicze mapy wpływów
+	GAMMA_MEMORY_CATEGORIES ///< liczba rodzajów pamięci
+} gamma_memory_category_t;
+
+/**
+ * Zużycie pamięci przez grę, wypełniane przez @ref gamma_memory_usage.
+ * Liczone są bajty zaalokowane przez silnik, bez narzutu alokatora.
+ */
+typedef struct gamma_memory {
+	uint64_t current[GAMMA_MEMORY_CATEGORIES]; ///< bieżące zużycie każdego rodzaju
+	uint64_t peak[GAMMA_MEMORY_CATEGORIES]; ///< największe zużycie każdego rodzaju
+	uint64_t total; 		///< bieżące zużycie łącznie
+	uint64_t peak_total; 	///< największe zużycie łącznie
+	uint64_t budget; 		///< limit łącznego zużycia lub 0, jeśli go nie ma
+} gamma_memory_t;
+
+/**
+ * Alokator, z którego gra bierze pamięć zamiast z funkcji malloc.
+ * Funkcje alokatora dostają rozmiar każdego bloku także przy jego zmianie
+ * i zwalnianiu, więc mogą nie przechowywać go same. W trybie współbieżnym
+ * (@ref gamma_enable_concurrency) i przy liczeniu mapy wpływów mogą być
+ * wywoływane z kilku wątków jednocześnie. Napisy i zrzuty planszy
+ * przekazywane wywołującemu są zawsze alokowane funkcją malloc.
+ */
+typedef struct gamma_allocator {
+	void* (*allocate)(void *context, size_t size); /**< alokuje blok lub daje
+ * 								NULL, jeśli zabrakło pamięci */
+	void* (*resize)(void *context, void *pointer, size_t old_size,
+	                size_t new_size); /**< zmienia rozmiar bloku jak funkcja
+ * 								realloc, przy czym @p pointer nie jest NULL */
+	void (*release)(void *context, void *pointer, size_t size); ///< zwalnia blok
+	void *context; 				///< dane przekazywane funkcjom alokatora
+} gamma_allocator_t;
+
+/**
+ * Parametry tworzenia gry przez @ref gamma_new_with_options, inne niż
+ * rozmiary planszy i liczby graczy i obszarów. Wyzerowana struktura
+ * z ustawioną topologią daje grę taką jak @ref gamma_new_ex.
+ */
+typedef struct gamma_options {
+	gamma_topology_t topology; 	///< topologia planszy
+	uint64_t memory_budget; 	/**< limit pamięci gry w bajtach lub 0, jeśli
+ * 								zużycie pamięci nie jest ograniczone */
+	const gamma_allocator_t *allocator; /**< alokator pamięci gry lub NULL,
+ * 								jeśli gra używa funkcji malloc */
+	size_t arena_size; 			/**< rozmiar jednego bloku, z którego gra
+ * 								bierze całą swoją pamięć, lub 0, jeśli
+ * 								każda struktura jest alokowana osobno */
+} gamma_options_t;
+
+/**
+ * Statystyki jednego obszaru, czyli spójnego zbioru pól jednego gracza.
+ * Są aktualizowane przy każdym ruchu, który łączy lub dzieli obszary.
+ */
+typedef struct gamma_area {
+	uint32_t owner; 		///< numer gracza, do którego należy obszar
+	uint64_t size; 			///< liczba pól obszaru
+	uint32_t min_x; 		///< najmniejsza współrzędna x pola obszaru
+	uint32_t min_y; 		///< najmniejsza współrzędna y pola obszaru
+	uint32_t max_x; 		///< największa współrzędna x pola obszaru
+	uint32_t max_y; 		///< największa współrzędna y pola obszaru
+	uint64_t free_edges; 	/**< liczba par sąsiednich pól, z których jedno
+ * 							należy do obszaru, a drugie jest wolne */
+} gamma_area_t;
+
+/**
+ * Przewidywany skutek legalnego ruchu, wyznaczany przez @ref gamma_try_move
+ * i @ref gamma_try_golden_move bez zmieniania stanu gry.
+ */
+typedef struct gamma_probe {
+	uint32_t owner; 		/**< dotychczasowy właściciel pola, 0 dla
+ * 							wolnego pola */
+	int32_t player_areas; 	///< zmiana liczby obszarów gracza wykonującego ruch
+	int32_t owner_areas; 	///< zmiana liczby obszarów właściciela pola
+	int64_t player_busy; 	///< zmiana liczby pól zajętych przez gracza
+	int64_t owner_busy; 	///< zmiana liczby pól zajętych przez właściciela
+} gamma_probe_t;
+
+/**
+ * Jeden ruch z serii wykonywanej przez @ref gamma_move_batch.
+ */
+typedef struct gamma_move {
+	uint32_t player; 	///< numer gracza wykonującego ruch
+	uint32_t x; 		///< numer kolumny
+	uint32_t y; 		///< numer wiersza
+	bool golden; 		///< informacja czy to złoty ruch
+} gamma_move_t;
+
+/**
+ * Liczba wolnych pól, dla których gracz jest jedynym najbliższym graczem,
+ * wyznaczana przez @ref gamma_influence_map.
+ */
+typedef struct gamma_territory {
+	uint32_t player; 	///< numer gracza, 0 dla pól remisowych i nieosiągalnych
+	uint64_t fields; 	///< liczba wolnych pól
+} gamma_territory_t;
+
 /** @brief Podaje liczbę graczy.
  * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
  * @return Liczba graczy, liczba dodatnia.
@@ -36,6 +159,23 @@ uint32_t gamma_width(gamma_t *g);
  */
 uint32_t gamma_height(gamma_t *g);
 
+/** @brief Podaje topologię planszy.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Topologia planszy podana przy tworzeniu gry.
+ */
+gamma_topology_t gamma_topology(gamma_t *g);
+
+/** @brief Podaje właściciela pola.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
+ *                      @p width z funkcji @ref gamma_new,
+ * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
+ *                      @p height z funkcji @ref gamma_new.
+ * @return Numer gracza, do którego należy pole (@p x, @p y) lub 0, jeśli pole
+ * jest wolne lub któryś z parametrów jest niepoprawny.
+ */
+uint32_t gamma_field_owner(gamma_t *g, uint32_t x, uint32_t y);
+
 /** @brief Tworzy strukturę przechowującą stan gry.
  * Alokuje pamięć na nową strukturę przechowującą stan gry.
  * Inicjuje tę strukturę tak, aby reprezentowała początkowy stan gry.
@@ -50,6 +190,63 @@ uint32_t gamma_height(gamma_t *g);
 gamma_t* gamma_new(uint32_t width, uint32_t height,
                    uint32_t players, uint32_t areas);
 
+/** @brief Tworzy strukturę przechowującą stan gry na planszy o zadanej
+ * topologii.
+ * Działa jak @ref gamma_new, która tworzy planszę @ref GAMMA_SQUARE. Każda
+ * topologia ma własne wersje pętli przeszukujących planszę, więc wybór
+ * topologii nie spowalnia gry.
+ * @param[in] width   – szerokość planszy, liczba dodatnia,
+ * @param[in] height  – wysokość planszy, liczba dodatnia,
+ * @param[in] players – liczba graczy, liczba dodatnia,
+ * @param[in] areas   – maksymalna liczba obszarów,
+ *                      jakie może zająć jeden gracz, liczba dodatnia,
+ * @param[in] topology – topologia planszy.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci lub któryś z parametrów jest niepoprawny.
+ */
+gamma_t* gamma_new_ex(uint32_t width, uint32_t height, uint32_t players,
+                      uint32_t areas, gamma_topology_t topology);
+
+/** @brief Tworzy strukturę przechowującą stan gry z zadanymi parametrami.
+ * Działa jak @ref gamma_new_ex. Jeśli w @p options podano limit pamięci,
+ * gra nigdy go nie przekracza: funkcje, którym zabrakłoby pamięci w ramach
+ * limitu, kończą się tak samo jak przy braku pamięci w systemie, a tam,
+ * gdzie to możliwe, używają oszczędniejszych struktur. Napisy i zrzuty
+ * planszy liczą się do limitu, dopóki nie zostaną przekazane wywołującemu,
+ * a plansza, której napis nie mieści się w limicie, może zostać pobrana po
+ * kawałku przez @ref gamma_board_rows.
+ * Jeśli podano rozmiar areny, cała pamięć gry pochodzi z jednego bloku
+ * alokowanego przy tworzeniu gry, a usunięcie gry zwalnia tylko ten blok.
+ * Pamięć zwolniona w arenie wraca do użytku tylko wtedy, gdy była
+ * zaalokowana jako ostatnia, więc arena powinna być nieco większa niż
+ * największe zużycie pamięci gry (@ref gamma_memory_t). Gdy arena się
+ * zapełni, gra zachowuje się tak jak po przekroczeniu limitu pamięci.
+ * @param[in] width   – szerokość planszy, liczba dodatnia,
+ * @param[in] height  – wysokość planszy, liczba dodatnia,
+ * @param[in] players – liczba graczy, liczba dodatnia,
+ * @param[in] areas   – maksymalna liczba obszarów,
+ *                      jakie może zająć jeden gracz, liczba dodatnia,
+ * @param[in] options – wskaźnik na parametry gry.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
+ * zaalokować pamięci, początkowy stan gry nie mieści się w limicie pamięci
+ * lub któryś z parametrów jest niepoprawny.
+ */
+gamma_t* gamma_new_with_options(uint32_t width, uint32_t height,
+                                uint32_t players, uint32_t areas,
+                                const gamma_options_t *options);
+
+/** @brief Podaje zużycie pamięci przez grę.
+ * Zużycie jest liczone przy każdej alokacji, więc funkcja działa w czasie
+ * stałym i może być wywoływana w trakcie działania innych funkcji na tej
+ * samej grze.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] usage  – wskaźnik na strukturę, do której zostaje zapisane
+ *                      zużycie pamięci.
+ * @return Wartość @p true, jeśli zapisano zużycie pamięci lub @p false, jeśli
+ * któryś z parametrów ma wartość NULL.
+ */
+bool gamma_memory_usage(gamma_t *g, gamma_memory_t *usage);
+
 /** @brief Usuwa strukturę przechowującą stan gry.
  * Usuwa z pamięci strukturę wskazywaną przez @p g.
  * Nic nie robi, jeśli wskaźnik ten ma wartość NULL.
@@ -57,6 +254,23 @@ gamma_t* gamma_new(uint32_t width, uint32_t height,
  */
 void gamma_delete(gamma_t *g);
 
+/** @brief Włącza tryb współbieżny.
+ * Od tej pory z gry mogą jednocześnie korzystać różne wątki: funkcje
+ * odczytujące stan gry (w tym @ref gamma_board, @ref gamma_try_move
+ * i @ref gamma_influence_map) działają równolegle ze sobą, a ruchy są
+ * wykonywane pojedynczo, gdy żaden odczyt nie trwa. Oczekujący ruch ma
+ * pierwszeństwo przed nowymi odczytami, więc ciągłe odpytywanie gry nie
+ * zagładza wątku wykonującego ruchy. Funkcję trzeba wywołać, zanim gra
+ * zostanie udostępniona innym wątkom. Usuwanie gry nadal wymaga, aby żaden
+ * inny wątek z niej nie korzystał. Bez tego trybu gra nie ponosi kosztu
+ * blokowania.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli tryb współbieżny jest włączony lub
+ * @p false, jeśli nie udało się zaalokować pamięci lub parametr @p g jest
+ * niepoprawny.
+ */
+bool gamma_enable_concurrency(gamma_t *g);
+
 /** @brief Wykonuje ruch.
  * Ustawia pionek gracza @p player na polu (@p x, @p y).
  * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
@@ -87,6 +301,64 @@ bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
  */
 bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
 
+/** @brief Wykonuje serię ruchów.
+ * Wykonuje po kolei ruchy z tablicy @p moves, każdy tak, jak zrobiłaby to
+ * @ref gamma_move lub @ref gamma_golden_move. W trybie współbieżnym
+ * (@ref gamma_enable_concurrency) blokuje grę raz na całą serię.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] moves   – tablica ruchów,
+ * @param[in] count   – liczba ruchów,
+ * @param[out] results – mapa bitowa wyników, tablica ⌈count / 64⌉ słów lub
+ *                      NULL; bit i % 64 słowa i / 64 jest ustawiany, jeśli
+ *                      ruch i został wykonany, a pozostałe bity są zerowane.
+ * @return Liczba wykonanych ruchów.
+ */
+uint64_t gamma_move_batch(gamma_t *g, const gamma_move_t *moves, size_t count,
+                          uint64_t *results);
+
+/** @brief Sprawdza ruch bez wykonywania go.
+ * Sprawdza, czy @ref gamma_move z tymi samymi parametrami wykonałaby ruch,
+ * i przewiduje jego skutek. Nie zmienia stanu gry, więc wiele wątków może
+ * jednocześnie sprawdzać ruchy w tej samej pozycji, o ile żaden w tym czasie
+ * jej nie zmienia.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
+ *                      @p width z funkcji @ref gamma_new,
+ * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
+ *                      @p height z funkcji @ref gamma_new,
+ * @param[out] probe  – wskaźnik, pod który zostaje zapisany skutek legalnego
+ *                      ruchu lub NULL.
+ * @return Wartość @p true, jeśli ruch jest legalny, a @p false,
+ * gdy ruch jest nielegalny lub któryś z parametrów jest niepoprawny.
+ */
+bool gamma_try_move(const gamma_t *g, uint32_t player, uint32_t x, uint32_t y,
+                    gamma_probe_t *probe);
+
+/** @brief Sprawdza złoty ruch bez wykonywania go.
+ * Sprawdza, czy @ref gamma_golden_move z tymi samymi parametrami wykonałaby
+ * ruch, i przewiduje jego skutek, w tym liczbę fragmentów, na które rozpadnie
+ * się obszar właściciela pola. Nie zmienia stanu gry, więc wiele wątków może
+ * jednocześnie sprawdzać ruchy w tej samej pozycji, o ile żaden w tym czasie
+ * jej nie zmienia. Jeśli pole nie jest punktem rozcięcia widocznym z jego
+ * najbliższego otoczenia, przeszukuje obszar właściciela metodą BFS.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
+ *                      @p width z funkcji @ref gamma_new,
+ * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
+ *                      @p height z funkcji @ref gamma_new,
+ * @param[out] probe  – wskaźnik, pod który zostaje zapisany skutek legalnego
+ *                      ruchu lub NULL.
+ * @return Wartość @p true, jeśli ruch jest legalny, a @p false,
+ * gdy gracz wykorzystał już swój złoty ruch, ruch jest nielegalny,
+ * któryś z parametrów jest niepoprawny lub zabrakło pamięci.
+ */
+bool gamma_try_golden_move(const gamma_t *g, uint32_t player, uint32_t x,
+                           uint32_t y, gamma_probe_t *probe);
+
 /** @brief Podaje liczbę pól zajętych przez gracza.
  * Podaje liczbę pól zajętych przez gracza @p player.
  * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
@@ -110,7 +382,9 @@ uint64_t gamma_free_fields(gamma_t *g, uint32_t player);
 
 /** @brief Sprawdza, czy gracz może wykonać złoty ruch.
  * Sprawdza, czy gracz @p player jeszcze nie wykonał w tej rozgrywce złotego
- * ruchu i jest przynajmniej jedno pole zajęte przez innego gracza.
+ * ruchu i jest przynajmniej jedno pole zajęte przez innego gracza. Pola
+ * innych graczy są liczone z liczby wszystkich zajętych pól, więc funkcja
+ * działa w czasie stałym.
  * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
  * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
  *                      @p players z funkcji @ref gamma_new.
@@ -120,6 +394,42 @@ uint64_t gamma_free_fields(gamma_t *g, uint32_t player);
  */
 bool gamma_golden_possible(gamma_t *g, uint32_t player);
 
+/** @brief Sprawdza, czy gra się zakończyła.
+ * Gra kończy się, gdy żaden gracz nie może wykonać ruchu, czyli dla każdego
+ * gracza @ref gamma_free_fields daje 0, a @ref gamma_golden_possible daje
+ * @p false. Informacja jest uaktualniana przy każdym ruchu, więc funkcja
+ * działa w czasie stałym.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli żaden gracz nie może wykonać ruchu,
+ * a @p false w przeciwnym przypadku lub gdy @p g ma wartość NULL.
+ */
+bool gamma_game_over(gamma_t *g);
+
+/** @brief Wyznacza następnego gracza, który może wykonać ruch.
+ * Szuka gracza, dla którego @ref gamma_free_fields daje wartość dodatnią lub
+ * @ref gamma_golden_possible daje @p true, wśród graczy o numerach większych
+ * od @p from, a jeśli takiego nie ma - od gracza 1. Działa w czasie
+ * O(log players).
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] from    – numer gracza, po którym zaczyna się szukanie, 0, aby
+ *                      zacząć od gracza 1.
+ * @return Numer gracza lub 0, jeśli żaden gracz nie może wykonać ruchu
+ * lub @p g ma wartość NULL.
+ */
+uint32_t gamma_next_player_with_move(gamma_t *g, uint32_t from);
+
+/** @brief Daje numery graczy, którzy wykonali ruch.
+ * Tylko dla tych graczy gra przechowuje stan, więc pozostali gracze nie mają
+ * pól i mogą wykonać ruch. Działa w czasie zależnym od liczby graczy, którzy
+ * wykonali ruch, a nie od wartości @p players z funkcji @ref gamma_new.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] count  – wskaźnik, pod który zostaje zapisana liczba graczy.
+ * @return Wskaźnik na zaalokowaną tablicę numerów graczy w kolejności
+ * rosnącej, którą należy zwolnić funkcją free, lub NULL, jeśli zabrakło
+ * pamięci albo któryś z parametrów jest niepoprawny.
+ */
+uint32_t* gamma_active_players(gamma_t *g, uint32_t *count);
+
 /** @brief Daje napis opisujący stan planszy.
  * Alokuje w pamięci bufor, w którym umieszcza napis zawierający tekstowy
  * opis aktualnego stanu planszy. Przykład znajduje się w pliku gamma_test.c.
@@ -130,4 +440,118 @@ bool gamma_golden_possible(gamma_t *g, uint32_t player);
  */
 char* gamma_board(gamma_t *g);
 
+/** @brief Daje fragment napisu opisującego stan planszy.
+ * Fragment składa się z kolejnych linijek napisu tworzonego przez
+ * @ref gamma_board, dzięki czemu planszę można wypisać kawałkami, gdy cały
+ * napis nie mieści się w pamięci. Funkcja wywołująca musi zwolnić bufor.
+ * @param[in] g         – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] first_row – numer pierwszej linijki fragmentu, licząc od
+ *                        górnego wiersza planszy, od 0,
+ * @param[in] rows      – największa liczba linijek fragmentu,
+ * @param[out] length   – wskaźnik, pod który zostaje zapisana długość
+ *                        fragmentu.
+ * @return Wskaźnik na zaalokowany bufor zakończony znakiem '\0' lub NULL,
+ * jeśli nie udało się zaalokować pamięci, fragment byłby pusty lub któryś
+ * z parametrów jest niepoprawny.
+ */
+char* gamma_board_rows(gamma_t *g, uint32_t first_row, uint32_t rows,
+                       size_t *length);
+
+/** @brief Daje planszę zakodowaną długościami serii.
+ * Alokuje w pamięci bufor z binarnym zrzutem planszy, zwykle wielokrotnie
+ * krótszym niż napis tworzony przez @ref gamma_board. Zrzut zaczyna się
+ * nagłówkiem: 8 bajtów "GAMMARLE", a po nich liczby width, height, players.
+ * Dalej następują wiersze planszy, od górnego, jak w @ref gamma_board.
+ * Każdy wiersz to ciąg par liczb: numer gracza (0 dla wolnych pól) i długość
+ * serii kolejnych pól tego gracza, od lewej. Sąsiednie serie w wierszu mają
+ * różnych właścicieli, a suma ich długości jest równa szerokości planszy.
+ * Liczby są zapisywane w kodowaniu varint (po 7 bitów na bajt, od najmniej
+ * znaczących). Funkcja wywołująca musi zwolnić ten bufor.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] length – wskaźnik, pod który zostaje zapisana długość zrzutu.
+ * @return Wskaźnik na zaalokowany bufor zawierający zrzut planszy lub NULL,
+ * jeśli nie udało się zaalokować pamięci.
+ */
+char* gamma_board_rle(gamma_t *g, size_t *length);
+
+/** @brief Podaje obszar, do którego należy pole.
+ * Identyfikator obszaru nie zmienia się, dopóki obszar nie zostanie
+ * połączony z innym lub podzielony. Przy łączeniu identyfikator zachowuje
+ * największy z łączonych obszarów. Identyfikatory usuniętych obszarów mogą
+ * zostać użyte ponownie.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x       – numer kolumny,
+ * @param[in] y       – numer wiersza.
+ * @return Dodatni identyfikator obszaru lub 0, jeśli pole jest wolne lub
+ * któryś z parametrów jest niepoprawny.
+ */
+uint32_t gamma_area_at(gamma_t *g, uint32_t x, uint32_t y);
+
+/** @brief Podaje statystyki obszaru.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] area    – identyfikator obszaru,
+ * @param[out] info   – wskaźnik, pod który zostają zapisane statystyki.
+ * @return Wartość @p true, jeśli obszar istnieje lub @p false w przeciwnym
+ * wypadku.
+ */
+bool gamma_area_info(gamma_t *g, uint32_t area, gamma_area_t *info);
+
+/** @brief Rozpoczyna przeglądanie obszarów gracza.
+ * Kolejne obszary podaje @ref gamma_next_area. Kolejność obszarów nie jest
+ * określona, a ruch wykonany w trakcie przeglądania może ją zmienić.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new.
+ * @return Identyfikator pierwszego obszaru gracza lub 0, jeśli gracz nie ma
+ * obszarów lub któryś z parametrów jest niepoprawny.
+ */
+uint32_t gamma_first_area(gamma_t *g, uint32_t player);
+
+/** @brief Podaje kolejny obszar tego samego gracza.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] area    – identyfikator obszaru.
+ * @return Identyfikator kolejnego obszaru gracza, do którego należy obszar
+ * @p area lub 0, jeśli to ostatni obszar lub któryś z parametrów jest
+ * niepoprawny.
+ */
+uint32_t gamma_next_area(gamma_t *g, uint32_t area);
+
+/** @brief Oblicza mapę wpływów graczy.
+ * Dla każdego wolnego pola wyznacza najbliższego gracza i odległość do
+ * najbliższego pola tego gracza, liczoną w krokach między sąsiednimi polami
+ * (w topologii planszy) i tylko przez wolne pola. Pole w tej samej
+ * odległości od pól kilku graczy jest remisowe. Przeszukiwanie BFS zaczyna się
+ * od wszystkich pól graczy jednocześnie, a każdy jego krok jest dzielony
+ * między wątki. W czasie obliczania stan gry nie może się zmieniać.
+ * Tablice @p nearest i @p distance mają po width * height elementów i taki
+ * sam układ jak plansza w pamięci: pole (x, y) znajduje się pod indeksem
+ * x * height + y. Każda z tablic może mieć wartość NULL, jeśli wynik nie jest
+ * potrzebny.
+ * @param[in] g           – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] threads     – maksymalna liczba wątków, 0 oznacza jeden wątek na
+ *                          procesor; małe plansze są przetwarzane przez mniej
+ *                          wątków,
+ * @param[out] nearest    – tablica, do której zostają zapisani najbliżsi
+ *                          gracze: właściciel dla zajętych pól, 0 dla pól
+ *                          remisowych i nieosiągalnych,
+ * @param[out] distance   – tablica, do której zostają zapisane odległości:
+ *                          0 dla zajętych pól, UINT32_MAX dla pól
+ *                          nieosiągalnych,
+ * @param[out] territory  – wskaźnik lub NULL; pod wskaźnik zostaje zapisana
+ *                          zaalokowana tablica, którą należy zwolnić funkcją
+ *                          free: najpierw element dla gracza 0 z liczbą pól
+ *                          remisowych i nieosiągalnych, a po nim elementy dla
+ *                          graczy mających pola, w kolejności rosnącej;
+ *                          jej rozmiar zależy od liczby graczy, którzy
+ *                          wykonali ruch, a nie od wartości @p players,
+ * @param[out] count      – wskaźnik, pod który zostaje zapisana liczba
+ *                          elementów tablicy @p territory, lub NULL, jeśli
+ *                          @p territory ma wartość NULL.
+ * @return Wartość @p true, jeśli udało się obliczyć mapę lub @p false, jeśli
+ * zabrakło pamięci lub któryś z parametrów jest niepoprawny.
+ */
+bool gamma_influence_map(gamma_t *g, uint32_t threads, uint32_t *nearest,
+                         uint32_t *distance, gamma_territory_t **territory,
+                         uint32_t *count);
+
 #endif /* GAMMA_H */
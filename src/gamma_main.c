@@ -4,58 +4,246 @@
  * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
  */
 
+#define _POSIX_C_SOURCE 200809L ///< udostępnia funkcję getopt
+
 #include <stdio.h>
+#include <string.h>
 #include <errno.h>
+#include <unistd.h>
 #include "gamma.h"
 #include "first_command.h"
 #include "batch_mode.h"
 #include "interactive_mode.h"
+#include "multi_game.h"
+#include "binary_mode.h"
+#include "server.h"
+#include "move_log.h"
+#include "spectator.h"
+#include "board_dump.h"
+#include "contention.h"
+#include "parsing_benchmark.h"
 #include "auxiliary_functions.h"
+#include "input.h"
+#include "output.h"
+
+
+static void flush_before_read(void);
 
 
+/** @brief Opróżnia bufory przed czytaniem wejścia.
+ * Wypisuje zbuforowane odpowiedzi i zapisuje zmiany opublikowane dla
+ * obserwatorów, bo czytanie może się zablokować.
+ */
+void flush_before_read(void) {
+	flush_output();
+	flush_spectator_stream();
+}
+
 /** @brief Główna funkcja programu.
- * Na początku funkcja próbuje uzyskać pierwsze polecenie zadające dalszy tryb
+ * Na początku funkcja inicjalizuje buforowane wejście, a następnie próbuje uzyskać pierwsze polecenie zadające dalszy tryb
  * działania. Następnie, jeśli polecenie zostało uzyskane i nie otrzymano
- * komunikatu o błędach, funkcja próbuje utworzyć nową grę. Jeśli się to udało
+ * komunikatu o błędach, funkcja próbuje utworzyć nową grę (poza trybem wielu
+ * gier, w którym gry tworzone są dopiero kolejnymi poleceniami). Jeśli się to udało
  * funkcja przechodzi do odpowiedniego trybu rozgrywki. W przeciwnym przypadku,
  * próbuje uzyskać polecenie jeszcze raz. W sytuacji, gdy pojawia się komunikat
  * o błędzie krytycznym, funkcja kończy działanie z kodem 1.
+ * Program przyjmuje opcje:
+ * -l - odpowiedzi trybu wsadowego są wypisywane od razu po wykonaniu każdego
+ * polecenia,
+ * -p - tryb wsadowy działa potokowo, w osobnych wątkach (@ref pipeline.h),
+ * -s path - program działa jako serwer gier nasłuchujący na gnieździe
+ * o podanej ścieżce (@ref server.h) i nie czyta standardowego wejścia,
+ * -r path - ruchy przyjęte w trybie wsadowym, binarnym lub interaktywnym są
+ * zapisywane w dzienniku o podanej ścieżce (@ref move_log.h),
+ * -R path - program odtwarza dziennik ruchów o podanej ścieżce i nie czyta
+ * standardowego wejścia,
+ * -d path - zmiany planszy w trybie wsadowym, binarnym lub interaktywnym są
+ * publikowane dla obserwatorów w pliku lub potoku o podanej ścieżce
+ * (@ref spectator.h),
+ * -v path - program działa jako obserwator strumienia zmian o podanej
+ * ścieżce i nie czyta standardowego wejścia,
+ * -u path - program wypisuje planszę ze zrzutu o podanej ścieżce
+ * (@ref board_dump.h) i nie czyta standardowego wejścia,
+ * -c readers - program mierzy wydajność gry w trybie współbieżnym z podaną
+ * liczbą wątków czytających (@ref contention.h) i nie czyta standardowego
+ * wejścia,
+ * -t lines - program mierzy szybkość konwersji podanej liczby poleceń trybu
+ * wsadowego (@ref parsing_benchmark.h) i nie czyta standardowego wejścia,
+ * -m megabytes - gra utworzona pierwszym poleceniem może zająć co najwyżej
+ * podaną liczbę megabajtów pamięci (@ref gamma_memory_usage).
+ * @param[in] argc 	- liczba argumentów wywołania programu,
+ * @param[in] argv 	- argumenty wywołania programu.
  * @return Wartość 0, jeśli program zakończył działanie pomyślnie lub
  * wartość 1, jeśli wystąpiły błędy (z pamięcią lub żądana plansza w interactive
  * mode była zbyt duża).
  */
-int main(void) {
+int main(int argc, char *argv[]) {
 	bool board_created = false,
-	eof = false;
+	eof = false,
+	flush_every_command = false,
+	pipelined = false;
 	int counter = 0,
 	exit_code = 0;
-	command_t first_command;
+	command_t first_command = init_command();
 	gamma_t *g = NULL;
+	input_t input;
+	const char *socket_path = NULL,
+	*record_path = NULL,
+	*replay_path = NULL,
+	*spectator_path = NULL,
+	*viewer_path = NULL,
+	*dump_path = NULL,
+	*readers = NULL,
+	*lines = NULL,
+	*megabytes = NULL;
+	gamma_options_t options = {GAMMA_SQUARE, 0, NULL, 0};
+	int option;
+	while((option = getopt(argc, argv, "lps:r:R:d:v:u:c:t:m:")) != -1) {
+		if(option == 'l') {
+			flush_every_command = true;
+		}
+		else if(option == 'p') {
+			pipelined = true;
+		}
+		else if(option == 's') {
+			socket_path = optarg;
+		}
+		else if(option == 'r') {
+			record_path = optarg;
+		}
+		else if(option == 'R') {
+			replay_path = optarg;
+		}
+		else if(option == 'd') {
+			spectator_path = optarg;
+		}
+		else if(option == 'v') {
+			viewer_path = optarg;
+		}
+		else if(option == 'u') {
+			dump_path = optarg;
+		}
+		else if(option == 'c') {
+			readers = optarg;
+		}
+		else if(option == 't') {
+			lines = optarg;
+		}
+		else if(option == 'm') {
+			megabytes = optarg;
+		}
+		else {
+			return 1;
+		}
+	}
+	if(megabytes != NULL) {
+		const char *end = megabytes + strlen(megabytes);
+		uint32_t count;
+		if(!read_number(&megabytes, end, &count) || megabytes != end) {
+			return 1;
+		}
+		options.memory_budget = (uint64_t)count << 20;
+	}
+	init_output(flush_every_command);
+	if(socket_path != NULL) {
+		return server_mode(socket_path, 0);
+	}
+	if(replay_path != NULL) {
+		return replay_mode(replay_path);
+	}
+	if(viewer_path != NULL) {
+		return viewer_mode(viewer_path);
+	}
+	if(dump_path != NULL) {
+		return decode_board_dump(dump_path);
+	}
+	if(readers != NULL) {
+		const char *end = readers + strlen(readers);
+		uint32_t count;
+		if(!read_number(&readers, end, &count) || readers != end) {
+			return 1;
+		}
+		return contention_benchmark(count);
+	}
+	if(lines != NULL) {
+		const char *end = lines + strlen(lines);
+		uint32_t count;
+		if(!read_number(&lines, end, &count) || lines != end) {
+			return 1;
+		}
+		return parsing_benchmark(count);
+	}
+	if(!init_input(&input, STDIN_FILENO)) {
+		return 1;
+	}
 	while(!board_created && !eof) {
-		first_command = read_first_command(&counter, &eof);
+		first_command = read_first_command(&input, &counter, &eof);
 		if(errno == ENOMEM) {
+			flush_output();
+			close_input(&input);
 			return 1;
 		}
-		if(!eof) {
+		if(!eof && first_command.name == 'M') {
+			board_created = true;
+		}
+		else if(!eof) {
 			uint32_t *args = first_command.args;
-			g = gamma_new(args[0], args[1], args[2], args[3]);
+			g = gamma_new_with_options(args[0], args[1], args[2], args[3],
+			                           &options);
 			if(g != NULL) {
 				board_created = true;
 			}
 			else {
-				fprintf(stderr, "ERROR %d\n", counter);
+				print_error(counter);
 			}
 		}
 	}
+	if(!eof && record_path != NULL && first_command.name != 'M') {
+		uint32_t *args = first_command.args;
+		if(!open_move_log(record_path, args[0], args[1], args[2], args[3])) {
+			flush_output();
+			gamma_delete(g);
+			close_input(&input);
+			return 1;
+		}
+	}
+	if(!eof && spectator_path != NULL && first_command.name != 'M') {
+		uint32_t *args = first_command.args;
+		if(!open_spectator_stream(spectator_path, args[0], args[1], args[2],
+		                          args[3])) {
+			flush_output();
+			close_move_log(g);
+			gamma_delete(g);
+			close_input(&input);
+			return 1;
+		}
+		input.before_read = flush_before_read;
+	}
 	if(!eof) {
 		if(first_command.name == 'B') {
-			fprintf(stdout, "OK %d\n", counter);
-			exit_code = batch_mode(g, counter);
+			print_ok(counter);
+			end_of_command();
+			exit_code = batch_mode(g, &input, counter, pipelined);
+		}
+		else if(first_command.name == 'X') {
+			print_ok(counter);
+			end_of_command();
+			exit_code = binary_mode(g, &input);
+		}
+		else if(first_command.name == 'M') {
+			print_ok(counter);
+			end_of_command();
+			exit_code = multi_game_mode(&input, counter, first_command.args[0]);
 		}
 		else if(first_command.name == 'I') {
-			exit_code = interactive_mode(g);
+			flush_output();
+			exit_code = interactive_mode(g, &input);
 		}
 	}
+	flush_output();
+	close_move_log(g);
+	close_spectator_stream();
 	gamma_delete(g);
+	close_input(&input);
 	return exit_code;
 }
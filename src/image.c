@@ -0,0 +1,331 @@
+/** @file
+ * Implementacja klasy eksportującej planszę jako obraz.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< udostępnia funkcję sysconf
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "image.h"
+#include "output.h"
+
+
+#define BAND_SIZE (1 << 18) ///< docelowy rozmiar jednego pasa obrazu w bajtach
+
+#define MAX_RENDERERS 64 ///< maksymalna liczba wątków renderujących
+
+#define SLOTS_PER_RENDERER 2 ///< liczba pasów w pamięci na jeden wątek renderujący
+
+#define HEADER_LIMIT (2 * UINT64_LIMIT + 12) ///< maksymalna długość nagłówka obrazu
+
+#define PALETTE_MULTIPLIER 2654435761u ///< mnożnik mieszający numer gracza w kolor
+
+#define PALETTE_BASE 64 ///< najciemniejsza składowa koloru gracza
+
+#define PALETTE_RANGE 192 ///< liczba możliwych wartości składowej koloru gracza
+
+
+/**
+ * Miejsce w pamięci na jeden pas obrazu.
+ */
+typedef struct band_slot {
+	unsigned char *pixels; 	///< piksele pasa
+	uint64_t *sums; 		/**< sumy składowych kolorów pól dla jednego wiersza
+ * 							obrazu, używane przy pomniejszaniu */
+	bool ready; 			///< informacja czy pas czeka na zapisanie
+} band_slot_t;
+
+/**
+ * Stan eksportu współdzielony przez wątki.
+ */
+typedef struct export {
+	gamma_t *g; 			///< wskaźnik na strukturę przechowującą stan gry
+	uint32_t width; 		///< szerokość planszy
+	uint32_t height; 		///< wysokość planszy
+	uint32_t scale; 		///< bok kwadratu pól odpowiadającego pikselowi
+	uint32_t channels; 		///< liczba kanałów obrazu
+	uint64_t image_width; 	///< szerokość obrazu w pikselach
+	uint64_t image_height; 	///< wysokość obrazu w pikselach
+	size_t row_bytes; 		///< liczba bajtów jednego wiersza obrazu
+	uint64_t band_rows; 	///< liczba wierszy obrazu w jednym pasie
+	uint64_t bands; 		///< liczba pasów
+	band_slot_t *slots; 	///< miejsca na pasy, pas b trafia do miejsca b % slot_count
+	uint64_t slot_count; 	///< liczba miejsc na pasy
+	uint64_t next_band; 	///< pierwszy pas, którego żaden wątek jeszcze nie renderuje
+	uint64_t written; 		///< liczba zapisanych pasów
+	pthread_mutex_t lock; 	///< zamek chroniący next_band, written i pola ready
+	pthread_cond_t changed; ///< zmienna warunkowa budzona po zmianie stanu pasów
+} export_t;
+
+
+static void field_colour(uint32_t owner, uint32_t channels, unsigned char *pixel);
+
+static void render_row(export_t *export, uint64_t row, unsigned char *pixels,
+                       uint64_t *sums);
+
+static void render_band(export_t *export, uint64_t band, band_slot_t *slot);
+
+static size_t band_length(const export_t *export, uint64_t band);
+
+static void* render_thread(void *arg);
+
+static bool init_slots(export_t *export);
+
+static void delete_slots(export_t *export);
+
+
+/** @brief Wyznacza kolor pola.
+ * Wolne pole jest czarne. Kolor gracza powstaje z bajtów jego numeru
+ * pomnożonego przez stałą mieszającą, więc sąsiednie numery mają wyraźnie
+ * różne kolory.
+ * @param[in] owner 	- numer gracza zajmującego pole lub 0,
+ * @param[in] channels 	- liczba kanałów obrazu,
+ * @param[out] pixel 	- wskaźnik na @p channels składowych koloru.
+ */
+void field_colour(uint32_t owner, uint32_t channels, unsigned char *pixel) {
+	uint32_t mix = owner * PALETTE_MULTIPLIER;
+	for(uint32_t k = 0; k < channels; k++) {
+		pixel[k] = owner == 0 ? 0
+		           : (unsigned char)(PALETTE_BASE
+		                             + ((mix >> (24 - 8 * k)) & 0xFF) % PALETTE_RANGE);
+	}
+}
+
+/** @brief Renderuje jeden wiersz obrazu.
+ * Przy pomniejszeniu kolor piksela jest średnią kolorów pól kwadratu,
+ * zaokrągloną do najbliższej liczby całkowitej. Kwadraty przy prawej
+ * i dolnej krawędzi planszy mogą być niepełne.
+ * @param[in] export 	- wskaźnik na stan eksportu,
+ * @param[in] row 		- numer wiersza obrazu, liczony od góry,
+ * @param[out] pixels 	- wskaźnik na piksele wiersza,
+ * @param[in,out] sums 	- wskaźnik na sumy składowych, używane przy
+ * 						pomniejszaniu.
+ */
+void render_row(export_t *export, uint64_t row, unsigned char *pixels,
+                uint64_t *sums) {
+	uint32_t channels = export->channels, scale = export->scale;
+	uint64_t top = row * scale;
+	uint32_t first_y = (uint32_t)(export->height - 1 - top);
+	if(scale == 1) {
+		for(uint32_t x = 0; x < export->width; x++) {
+			field_colour(gamma_field_owner(export->g, x, first_y), channels,
+			             pixels + (size_t)x * channels);
+		}
+		return;
+	}
+	uint64_t block_rows = export->height - top < scale ? export->height - top
+	                                                   : scale;
+	memset(sums, 0, export->row_bytes * sizeof(uint64_t));
+	unsigned char pixel[IMAGE_COLOUR];
+	for(uint64_t dy = 0; dy < block_rows; dy++) {
+		uint32_t y = first_y - (uint32_t)dy, x = 0;
+		for(uint64_t column = 0; column < export->image_width; column++) {
+			uint64_t end = (uint64_t)x + scale;
+			if(end > export->width) {
+				end = export->width;
+			}
+			uint64_t *sum = sums + column * channels;
+			for(; x < end; x++) {
+				field_colour(gamma_field_owner(export->g, x, y), channels, pixel);
+				for(uint32_t k = 0; k < channels; k++) {
+					sum[k] += pixel[k];
+				}
+			}
+		}
+	}
+	for(uint64_t column = 0; column < export->image_width; column++) {
+		uint64_t left = column * scale;
+		uint64_t block_columns = export->width - left < scale ? export->width - left
+		                                                      : scale;
+		uint64_t count = block_rows * block_columns;
+		for(uint32_t k = 0; k < channels; k++) {
+			size_t i = (size_t)column * channels + k;
+			pixels[i] = (unsigned char)((sums[i] + count / 2) / count);
+		}
+	}
+}
+
+/** @brief Renderuje jeden pas obrazu.
+ * @param[in] export 	- wskaźnik na stan eksportu,
+ * @param[in] band 		- numer pasa,
+ * @param[in,out] slot 	- wskaźnik na miejsce, do którego trafia pas.
+ */
+void render_band(export_t *export, uint64_t band, band_slot_t *slot) {
+	uint64_t first = band * export->band_rows;
+	uint64_t end = first + export->band_rows;
+	if(end > export->image_height) {
+		end = export->image_height;
+	}
+	for(uint64_t row = first; row < end; row++) {
+		render_row(export, row, slot->pixels + (size_t)(row - first) * export->row_bytes,
+		           slot->sums);
+	}
+}
+
+/** @brief Podaje liczbę bajtów pasa.
+ * @param[in] export 	- wskaźnik na stan eksportu,
+ * @param[in] band 		- numer pasa.
+ * @return Liczba bajtów pasa; ostatni pas może być krótszy od pozostałych.
+ */
+size_t band_length(const export_t *export, uint64_t band) {
+	uint64_t rows = export->image_height - band * export->band_rows;
+	if(rows > export->band_rows) {
+		rows = export->band_rows;
+	}
+	return (size_t)rows * export->row_bytes;
+}
+
+/** @brief Renderuje kolejne pasy obrazu.
+ * Wątek bierze pierwszy pas, którego nikt jeszcze nie renderuje, czeka, aż
+ * jego miejsce zostanie zwolnione przez zapisanie wcześniejszego pasa,
+ * i renderuje go. Kończy działanie, gdy wszystkie pasy są rozdzielone.
+ * @param[in,out] arg 	- wskaźnik na stan eksportu (@ref export_t).
+ * @return Wartość NULL.
+ */
+void* render_thread(void *arg) {
+	export_t *export = arg;
+	pthread_mutex_lock(&export->lock);
+	while(export->next_band < export->bands) {
+		uint64_t band = export->next_band++;
+		band_slot_t *slot = &export->slots[band % export->slot_count];
+		while(export->written + export->slot_count <= band) {
+			pthread_cond_wait(&export->changed, &export->lock);
+		}
+		pthread_mutex_unlock(&export->lock);
+		render_band(export, band, slot);
+		pthread_mutex_lock(&export->lock);
+		slot->ready = true;
+		pthread_cond_broadcast(&export->changed);
+	}
+	pthread_mutex_unlock(&export->lock);
+	return NULL;
+}
+
+/** @brief Alokuje miejsca na pasy obrazu.
+ * @param[in,out] export 	- wskaźnik na stan eksportu z ustaloną liczbą
+ * 							miejsc.
+ * @return Wartość @p true, jeśli się udało lub @p false, jeśli zabrakło
+ * pamięci.
+ */
+bool init_slots(export_t *export) {
+	export->slots = calloc(export->slot_count, sizeof(band_slot_t));
+	if(!export->slots) {
+		return false;
+	}
+	for(uint64_t i = 0; i < export->slot_count; i++) {
+		band_slot_t *slot = &export->slots[i];
+		slot->pixels = malloc((size_t)export->band_rows * export->row_bytes);
+		if(export->scale > 1) {
+			slot->sums = malloc(export->row_bytes * sizeof(uint64_t));
+		}
+		if(!slot->pixels || (export->scale > 1 && !slot->sums)) {
+			delete_slots(export);
+			return false;
+		}
+	}
+	return true;
+}
+
+/** @brief Zwalnia miejsca na pasy obrazu.
+ * @param[in,out] export 	- wskaźnik na stan eksportu.
+ */
+void delete_slots(export_t *export) {
+	for(uint64_t i = 0; i < export->slot_count; i++) {
+		free(export->slots[i].pixels);
+		free(export->slots[i].sums);
+	}
+	free(export->slots);
+	export->slots = NULL;
+}
+
+
+bool export_image(gamma_t *g, uint32_t scale, uint32_t channels,
+                  image_writer_t *writer, void *context) {
+	if(g == NULL || scale == 0
+	   || (channels != IMAGE_GREY && channels != IMAGE_COLOUR)) {
+		return false;
+	}
+	export_t export;
+	export.g = g;
+	export.width = gamma_width(g);
+	export.height = gamma_height(g);
+	export.scale = scale;
+	export.channels = channels;
+	export.image_width = ((uint64_t)export.width + scale - 1) / scale;
+	export.image_height = ((uint64_t)export.height + scale - 1) / scale;
+	export.row_bytes = (size_t)export.image_width * channels;
+	export.band_rows = BAND_SIZE / export.row_bytes;
+	if(export.band_rows == 0) {
+		export.band_rows = 1;
+	}
+	if(export.band_rows > export.image_height) {
+		export.band_rows = export.image_height;
+	}
+	export.bands = (export.image_height + export.band_rows - 1) / export.band_rows;
+	long processors = sysconf(_SC_NPROCESSORS_ONLN);
+	uint64_t renderers = processors > 0 ? (uint64_t)processors : 1;
+	if(renderers > MAX_RENDERERS) {
+		renderers = MAX_RENDERERS;
+	}
+	if(renderers > export.bands) {
+		renderers = export.bands;
+	}
+	export.slot_count = renderers * SLOTS_PER_RENDERER;
+	if(export.slot_count > export.bands) {
+		export.slot_count = export.bands;
+	}
+	export.next_band = export.written = 0;
+	if(!init_slots(&export)) {
+		return false;
+	}
+
+	char header[HEADER_LIMIT];
+	size_t length = 0;
+	header[length++] = 'P';
+	header[length++] = channels == IMAGE_GREY ? '5' : '6';
+	header[length++] = '\n';
+	length += format_number(header + length, export.image_width);
+	header[length++] = ' ';
+	length += format_number(header + length, export.image_height);
+	memcpy(header + length, "\n255\n", 5);
+	writer(context, header, length + 5);
+
+	pthread_mutex_init(&export.lock, NULL);
+	pthread_cond_init(&export.changed, NULL);
+	pthread_t threads[MAX_RENDERERS];
+	uint64_t started = 0;
+	while(started < renderers
+	      && pthread_create(&threads[started], NULL, render_thread, &export) == 0) {
+		started++;
+	}
+	for(uint64_t band = 0; band < export.bands; band++) {
+		band_slot_t *slot = &export.slots[band % export.slot_count];
+		if(started == 0) {
+			render_band(&export, band, slot);
+		}
+		else {
+			pthread_mutex_lock(&export.lock);
+			while(!slot->ready) {
+				pthread_cond_wait(&export.changed, &export.lock);
+			}
+			pthread_mutex_unlock(&export.lock);
+		}
+		writer(context, (const char *)slot->pixels, band_length(&export, band));
+		pthread_mutex_lock(&export.lock);
+		slot->ready = false;
+		export.written++;
+		pthread_cond_broadcast(&export.changed);
+		pthread_mutex_unlock(&export.lock);
+	}
+	for(uint64_t i = 0; i < started; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	pthread_cond_destroy(&export.changed);
+	pthread_mutex_destroy(&export.lock);
+	delete_slots(&export);
+	return true;
+}
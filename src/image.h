@@ -0,0 +1,55 @@
+/** @file
+ * Interfejs klasy eksportującej planszę jako obraz.
+ * Plansza jest zapisywana w binarnym formacie PGM (P5, odcienie szarości)
+ * lub PPM (P6, kolor), jeden piksel na pole lub, przy pomniejszeniu, na
+ * kwadrat scale x scale pól, którego kolor jest średnią kolorów pól.
+ * Górny wiersz obrazu odpowiada górnemu wierszowi planszy, tak jak w napisie
+ * tworzonym przez @ref gamma_board. Wolne pola są czarne, a każdy gracz ma
+ * stały, jasny kolor wyznaczony przez jego numer.
+ * Obraz jest dzielony na pasy wierszy, renderowane równolegle przez kilka
+ * wątków i przekazywane do zapisu po kolei, więc w pamięci jest tylko kilka
+ * pasów naraz, a nie cały obraz.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "gamma.h"
+
+
+#define IMAGE_GREY 1 ///< liczba kanałów obrazu PGM
+
+#define IMAGE_COLOUR 3 ///< liczba kanałów obrazu PPM
+
+
+/**
+ * Funkcja zapisująca kolejne fragmenty obrazu.
+ * Pierwszym argumentem jest wskaźnik przekazany do @ref export_image,
+ * drugim początek fragmentu, a trzecim jego długość.
+ */
+typedef void image_writer_t(void *context, const char *data, size_t length);
+
+
+/** @brief Eksportuje planszę jako obraz.
+ * Zapisuje nagłówek i kolejne pasy obrazu za pomocą funkcji @p writer,
+ * wywoływanej zawsze z wątku, który wywołał tę funkcję. W czasie eksportu
+ * stan gry nie może się zmieniać.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] scale 	- bok kwadratu pól odpowiadającego jednemu pikselowi,
+ * 						liczba dodatnia,
+ * @param[in] channels 	- @ref IMAGE_GREY lub @ref IMAGE_COLOUR,
+ * @param[in] writer 	- funkcja zapisująca fragmenty obrazu,
+ * @param[in] context 	- wskaźnik przekazywany do funkcji @p writer.
+ * @return Wartość @p true, jeśli obraz został zapisany lub @p false, jeśli
+ * parametry są niepoprawne albo zabrakło pamięci (wtedy nic nie zostało
+ * zapisane).
+ */
+bool export_image(gamma_t *g, uint32_t scale, uint32_t channels,
+                  image_writer_t *writer, void *context);
+
+#endif /* IMAGE_H */
@@ -0,0 +1,214 @@
+/** @file
+ * Implementacja klasy buforującej dane wejściowe.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< udostępnia funkcje posix_madvise i ssize_t
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "input.h"
+#include "output.h"
+
+
+#define INPUT_BLOCK_SIZE (1 << 16) ///< rozmiar bloku czytanego jednym wywołaniem read
+
+
+static bool map_input(input_t *input);
+
+static bool fill_buffer(input_t *input);
+
+
+/** @brief Próbuje zmapować wejście do pamięci.
+ * Udaje się to tylko wtedy, gdy deskryptor wskazuje na niepusty zwykły plik.
+ * Czytanie zaczyna się od bieżącej pozycji w pliku.
+ * @param[in,out] input 	- wskaźnik na strukturę wejścia.
+ * @return Wartość @p true, jeśli plik został zmapowany lub @p false
+ * w przeciwnym wypadku.
+ */
+bool map_input(input_t *input) {
+	struct stat st;
+	if(fstat(input->fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+		return false;
+	}
+	off_t offset = lseek(input->fd, 0, SEEK_CUR);
+	if(offset < 0 || offset >= st.st_size) {
+		return false;
+	}
+	void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE,
+	                  input->fd, 0);
+	if(data == MAP_FAILED) {
+		errno = 0;
+		return false;
+	}
+	posix_madvise(data, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+	input->buffer = data;
+	input->capacity = (size_t)st.st_size;
+	input->start = input->scanned = (size_t)offset;
+	input->end = (size_t)st.st_size;
+	input->mapped = true;
+	input->eof = true;
+	return true;
+}
+
+/** @brief Dopełnia bufor kolejnym blokiem danych.
+ * Przesuwa nieprzeczytane dane na początek bufora, w razie potrzeby
+ * dwukrotnie go powiększa, a następnie czyta kolejny blok z wejścia.
+ * Ponieważ czytanie może się zablokować, najpierw wywołuje funkcję
+ * before_read, która zwykle wypisuje zbuforowane odpowiedzi, na które może
+ * czekać program po drugiej stronie potoku.
+ * @param[in,out] input 	- wskaźnik na strukturę wejścia.
+ * @return Wartość @p true, jeśli do bufora dopisano nowe dane lub @p false,
+ * jeśli napotkano koniec danych lub zabrakło pamięci.
+ */
+bool fill_buffer(input_t *input) {
+	if(input->eof) {
+		return false;
+	}
+	if(input->start > 0) {
+		size_t pending = input->end - input->start;
+		memmove(input->buffer, input->buffer + input->start, pending);
+		input->scanned -= input->start;
+		input->end = pending;
+		input->start = 0;
+	}
+	if(input->end == input->capacity) {
+		char *bigger = realloc(input->buffer, 2 * input->capacity);
+		if(!bigger) {
+			errno = ENOMEM;
+			return false;
+		}
+		input->buffer = bigger;
+		input->capacity *= 2;
+	}
+	if(input->before_read) {
+		input->before_read();
+	}
+	ssize_t bytes;
+	do {
+		bytes = read(input->fd, input->buffer + input->end,
+		             input->capacity - input->end);
+	} while(bytes < 0 && errno == EINTR);
+	if(bytes <= 0) {
+		errno = 0;
+		input->eof = true;
+		return false;
+	}
+	input->end += (size_t)bytes;
+	return true;
+}
+
+bool init_input(input_t *input, int fd) {
+	input->fd = fd;
+	input->buffer = NULL;
+	input->capacity = input->start = input->end = input->scanned = 0;
+	input->mapped = false;
+	input->eof = false;
+	input->before_read = flush_output;
+	if(map_input(input)) {
+		return true;
+	}
+	input->buffer = malloc(INPUT_BLOCK_SIZE);
+	if(!input->buffer) {
+		errno = ENOMEM;
+		return false;
+	}
+	input->capacity = INPUT_BLOCK_SIZE;
+	return true;
+}
+
+bool next_line(input_t *input, const char **line, size_t *length,
+               bool *terminated) {
+	char *newline;
+	while((newline = memchr(input->buffer + input->scanned, '\n',
+	                        input->end - input->scanned)) == NULL) {
+		input->scanned = input->end;
+		if(!fill_buffer(input)) {
+			if(errno == ENOMEM || input->start == input->end) {
+				return false;
+			}
+			*line = input->buffer + input->start;
+			*length = input->end - input->start;
+			*terminated = false;
+			input->start = input->scanned = input->end;
+			return true;
+		}
+	}
+	*line = input->buffer + input->start;
+	*length = (size_t)(newline - *line);
+	*terminated = true;
+	input->start = input->scanned = (size_t)(newline - input->buffer) + 1;
+	return true;
+}
+
+bool next_records(input_t *input, size_t record_size, const char **data,
+                  size_t *length) {
+	while(input->end - input->start < record_size && fill_buffer(input)) {
+	}
+	size_t available = input->end - input->start;
+	if(available == 0) {
+		return false;
+	}
+	if(available >= record_size) {
+		available -= available % record_size;
+	}
+	*data = input->buffer + input->start;
+	*length = available;
+	input->start += available;
+	input->scanned = input->start;
+	return true;
+}
+
+int next_char(input_t *input) {
+	if(input->start == input->end && !fill_buffer(input)) {
+		return EOF;
+	}
+	unsigned char c = (unsigned char)input->buffer[input->start++];
+	input->scanned = input->start;
+	return c;
+}
+
+bool end_of_input(input_t *input) {
+	return input->start == input->end && !fill_buffer(input);
+}
+
+bool next_varint(input_t *input, uint64_t *value) {
+	uint64_t result = 0;
+	for(int shift = 0; shift < 7 * VARINT_LIMIT; shift += 7) {
+		int byte = next_char(input);
+		if(byte == EOF) {
+			return false;
+		}
+		result |= (uint64_t)(byte & 0x7F) << shift;
+		if(!(byte & 0x80)) {
+			*value = result;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool next_uint32(input_t *input, uint32_t *value) {
+	uint64_t result;
+	if(!next_varint(input, &result) || result > UINT32_MAX) {
+		return false;
+	}
+	*value = (uint32_t)result;
+	return true;
+}
+
+void close_input(input_t *input) {
+	if(input->mapped) {
+		munmap(input->buffer, input->capacity);
+	}
+	else {
+		free(input->buffer);
+	}
+	input->buffer = NULL;
+}
@@ -0,0 +1,121 @@
+/** @file
+ * Interfejs klasy buforującej dane wejściowe.
+ * Dane są czytane dużymi blokami za pomocą funkcji read lub, jeśli wejście
+ * jest zwykłym plikiem, mapowane w całości do pamięci za pomocą mmap.
+ * Linijki są udostępniane bezpośrednio z bufora, bez kopiowania.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef INPUT_H
+#define INPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * Struktura przechowująca stan buforowanego wejścia.
+ */
+typedef struct input {
+	int fd; 			///< deskryptor pliku, z którego czytamy
+	char *buffer; 		///< bufor z danymi lub zmapowany plik
+	size_t capacity; 	///< rozmiar zaalokowanego bufora lub zmapowanego pliku
+	size_t start; 		///< indeks pierwszego nieprzeczytanego bajtu
+	size_t end; 		///< indeks za ostatnim bajtem w buforze
+	size_t scanned; 	/**< indeks, do którego bufor został przeszukany
+ * 						w poszukiwaniu znaku nowej linii */
+	bool mapped; 		///< informacja czy bufor jest zmapowanym plikiem
+	bool eof; 			///< informacja czy napotkano koniec danych
+	void (*before_read)(void); /**< funkcja wywoływana przed czytaniem
+ * 						z wejścia, które może się zablokować, np. wypisująca
+ * 						zbuforowane odpowiedzi, lub NULL */
+} input_t;
+
+
+/** @brief Inicjalizuje buforowane wejście.
+ * Jeśli deskryptor wskazuje na zwykły plik, próbuje zmapować jego zawartość
+ * do pamięci. W przeciwnym wypadku alokuje bufor, do którego dane będą
+ * czytane blokami. Domyślnie przed każdym czytaniem wywoływana jest funkcja
+ * @ref flush_output.
+ * @param[out] input 	- wskaźnik na inicjalizowaną strukturę,
+ * @param[in] fd 		- deskryptor pliku, z którego będziemy czytać.
+ * @return Wartość @p true, jeśli udało się zainicjalizować wejście lub
+ * @p false, jeśli zabrakło pamięci.
+ */
+bool init_input(input_t *input, int fd);
+
+/** @brief Podaje kolejną linijkę z wejścia.
+ * Linijka nie jest kopiowana, wskaźnik pokazuje na jej początek w buforze
+ * i pozostaje ważny do następnego wywołania funkcji operujących na @p input.
+ * Zwracana linijka nie zawiera znaku nowej linii.
+ * @param[in,out] input 	- wskaźnik na strukturę wejścia,
+ * @param[out] line 		- wskaźnik, pod który zostaje zapisany początek linijki,
+ * @param[out] length 		- wskaźnik, pod który zostaje zapisana długość linijki,
+ * @param[out] terminated 	- wskaźnik, pod który zostaje zapisana informacja czy
+ * 							linijka była zakończona znakiem nowej linii.
+ * @return Wartość @p true, jeśli przeczytano linijkę lub @p false, jeśli na
+ * wejściu nie ma już danych albo zabrakło pamięci (wtedy errno ma wartość
+ * ENOMEM).
+ */
+bool next_line(input_t *input, const char **line, size_t *length,
+               bool *terminated);
+
+/** @brief Podaje kolejny fragment wejścia złożony z całych rekordów.
+ * Fragment nie jest kopiowany, wskaźnik pokazuje na jego początek w buforze
+ * i pozostaje ważny do następnego wywołania funkcji operujących na @p input.
+ * Fragment zawiera wszystkie całe rekordy znajdujące się w buforze, a jeśli
+ * nie ma tam żadnego, funkcja czeka na kolejne dane. Na końcu danych fragment
+ * może zawierać niepełny rekord.
+ * @param[in,out] input 	- wskaźnik na strukturę wejścia,
+ * @param[in] record_size 	- rozmiar jednego rekordu w bajtach,
+ * @param[out] data 		- wskaźnik, pod który zostaje zapisany początek
+ * 							fragmentu,
+ * @param[out] length 		- wskaźnik, pod który zostaje zapisana długość
+ * 							fragmentu.
+ * @return Wartość @p true, jeśli przeczytano fragment lub @p false, jeśli na
+ * wejściu nie ma już danych albo zabrakło pamięci.
+ */
+bool next_records(input_t *input, size_t record_size, const char **data,
+                  size_t *length);
+
+/** @brief Podaje kolejny znak z wejścia.
+ * Najpierw zwraca znaki pozostałe w buforze, a gdy bufor jest pusty,
+ * czeka na kolejne dane.
+ * @param[in,out] input 	- wskaźnik na strukturę wejścia.
+ * @return Przeczytany znak lub EOF, jeśli na wejściu nie ma już danych.
+ */
+int next_char(input_t *input);
+
+/** @brief Sprawdza czy na wejściu nie ma już danych.
+ * Jeśli bufor jest pusty, czeka na kolejne dane.
+ * @param[in,out] input 	- wskaźnik na strukturę wejścia.
+ * @return Wartość @p true, jeśli dane się skończyły lub @p false w przeciwnym
+ * wypadku.
+ */
+bool end_of_input(input_t *input);
+
+/** @brief Podaje kolejną liczbę z wejścia, zapisaną w kodowaniu varint.
+ * @param[in,out] input 	- wskaźnik na strukturę wejścia,
+ * @param[out] value 		- wskaźnik, pod który zostaje zapisana liczba.
+ * @return Wartość @p true, jeśli przeczytano liczbę lub @p false, jeśli dane
+ * się skończyły albo liczba jest dłuższa niż @ref VARINT_LIMIT bajtów.
+ */
+bool next_varint(input_t *input, uint64_t *value);
+
+/** @brief Podaje kolejną liczbę 32-bitową z wejścia, zapisaną w kodowaniu
+ * varint.
+ * @param[in,out] input 	- wskaźnik na strukturę wejścia,
+ * @param[out] value 		- wskaźnik, pod który zostaje zapisana liczba.
+ * @return Wartość @p true, jeśli przeczytano liczbę mieszczącą się w typie
+ * uint32_t lub @p false w przeciwnym wypadku.
+ */
+bool next_uint32(input_t *input, uint32_t *value);
+
+/** @brief Zwalnia zasoby związane z wejściem.
+ * @param[in,out] input 	- wskaźnik na strukturę wejścia.
+ */
+void close_input(input_t *input);
+
+#endif /* INPUT_H */
@@ -6,511 +6,455 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <termios.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #include "interactive_mode.h"
+#include "keyboard.h"
 #include "auxiliary_functions.h"
+#include "move_log.h"
+#include "spectator.h"
+#include "output.h"
+#include "screen.h"
 
 
-#define EOT 4 	/**< End of Transmission, znak zwracany przez @ref getch
- * 				po wciśnięciu Ctrl + D */
+#define EOT 4 	/**< End of Transmission, znak odczytywany po wciśnięciu
+ * 				Ctrl + D */
 
-/** @name Makra zastępujące kody ANSI
- */
-///@{
-#define MOVE_CURSOR_UP "\x1b[A"			///< Przesunięcie w górę kursora w terminalu
-#define MOVE_CURSOR_DOWN "\x1b[B"		///< Przesunięcie w dół kursora w terminalu
-#define MOVE_CURSOR_FORWARD "\x1b[C"	/**< Przesunięcie do przodu (w prawo) kursora
- *											 w terminalu */
-#define MOVE_CURSOR_BACK "\x1b[D"		/**< Przesunięcie do tyłu (w lewo) kursora
- * 											w terminalu */
-
-#define MOVE_CURSOR_TO_TOP_LEFT "\x1b[H"/**< Przesunięcie kursora w lewy, górny róg
- * 											 terminala */
-
-#define SAVE_CURSOR_POSITION "\x1b[s"	///< Zapisanie pozycji kursora w terminalu
-#define RESTORE_CURSOR_POSITION "\x1b[u"///< Przywrócenie pozycji kursora w terminalu
-
-#define CLEAR_DISPLAY "\x1b[0J"			/**< Usunięcie całej zawartości wyświetlanego
- * 										 	 okna terminala */
-#define CLEAR_LINE "\x1b[2K"			///< Usunięcie całej linijki w terminalu
-
-
-#define MOVE_CURSOR_MANY_CELLS_FORWARD(num_of_cells) "\x1b[%uC", num_of_cells /**<
- * Przesunięcie kursora do przodu (w prawo) o zadaną liczbę komórek.
- * Uwaga: Makro nie może być używane z innymi makrami w jednym wywołaniu funkcji
- * printf. Żeby działało poprawnie należy je umieścić w osobnym wywołaniu funkcji
- * printf.
- */
- 
-#define MOVE_CURSOR_MANY_CELLS_BACK(num_of_cells) "\x1b[%uD", num_of_cells /**<
- * Przesunięcie kursora do tyłu (w lewo) o zadaną liczbę komórek.
- * Uwaga: Makro nie może być używane z innymi makrami w jednym wywołaniu funkcji
- * printf. Żeby działało poprawnie należy je umieścić w osobnym wywołaniu funkcji
- * printf.
- */
- 
-#define MOVE_CURSOR_MANY_LINES_DOWN(num_of_lines) "\x1b[%uE", num_of_lines /**<
- * Przesunięcie kursora w dół o zadaną liczbę linii, na początek linijki.
- * Uwaga: Makro nie może być używane z innymi makrami w jednym wywołaniu funkcji
- * printf. Żeby działało poprawnie należy je umieścić w osobnym wywołaniu funkcji
- * printf.
- */
+#define DEFAULT_TERMINAL_WIDTH 80 /**< szerokość terminala przyjmowana, gdy nie
+ * da się jej odczytać */
+
+#define DEFAULT_TERMINAL_HEIGHT 24 /**< wysokość terminala przyjmowana, gdy nie
+ * da się jej odczytać */
+
+#define INFO_LINES 1 ///< liczba linijek terminala pod planszą, na informacje
 
-#define ACTIVATE_REVERSE_FG_BG "\x1b[7m" /**< Kod ANSI aktywujący zamianę koloru
- * tła z kolorem tekstu.
+#define SCROLL_MARGIN 2 /**< liczba pól, które pozostają widoczne pomiędzy
+ * kursorem a krawędzią okna, o ile plansza na to pozwala */
+
+#define INFO_LIMIT 128 ///< maksymalna długość linijki z informacjami o graczu
+
+
+/**
+ * Widoczny fragment planszy i położenie kursora. Wszystkie współrzędne są
+ * współrzędnymi planszy, a nie terminala.
  */
- 
-#define RESET "\x1b[0m" /**< Resetuje poprzednio aktywowane kody ANSI modyfikujące
- * tekst.
+typedef struct view {
+	uint32_t cursor_x; 		///< kolumna pola, na którym jest kursor
+	uint32_t cursor_y; 		///< wiersz pola, na którym jest kursor
+	uint32_t left; 			///< pierwsza widoczna kolumna
+	uint32_t bottom; 		///< najniższy widoczny wiersz
+	uint32_t columns; 		///< liczba widocznych kolumn
+	uint32_t rows; 			///< liczba widocznych wierszy
+	uint32_t cell_width; 	///< liczba znaków zajmowanych przez jedno pole
+} view_t;
+
+
+static keyboard_t keyboard; /**< Klawiatura, z której czytane są wciskane
+ * klawisze. Część danych mogła zostać wczytana do bufora wejścia razem z
+ * pierwszym poleceniem, dlatego nie czytamy bezpośrednio ze standardowego
+ * wejścia.
  */
-///@}
 
+static screen_t screen; ///< ekran, na którym budowane są kolejne klatki gry
 
-static char getch();
+static view_t spectator_view; ///< widoczny fragment planszy w trybie obserwatora
 
-static void show_board(gamma_t *g);
+static bool spectating = false; /**< informacja czy ekran trybu obserwatora
+ * został zainicjalizowany */
 
-static void show_player_info(gamma_t *g, uint32_t player,
-											uint64_t free_fields, uint32_t y);
 
-static void print_summary(gamma_t *g, uint32_t y);
+static void init_view(gamma_t *g, view_t *view);
 
-static void manage_highlight(gamma_t *g, uint32_t x, uint32_t y, bool add);
+static void get_window_size(uint32_t *terminal_width, uint32_t *terminal_height);
 
-static void add_highlight(gamma_t *g, uint32_t x, uint32_t y);
+static void scroll_axis(uint32_t cursor, uint32_t *first, uint32_t visible,
+                        uint32_t size);
 
-static void delete_highlight(gamma_t *g, uint32_t x, uint32_t y);
+static void fit_view(gamma_t *g, view_t *view, uint32_t terminal_width,
+                     uint32_t terminal_height);
 
-static void move_cursor_up(gamma_t *g, const uint32_t *x, uint32_t *y);
+static void format_cell(char *destination, uint32_t owner, uint32_t cell_width);
 
-static void move_cursor_down(gamma_t *g, const uint32_t *x, uint32_t *y);
+static void show_board(gamma_t *g, const view_t *view);
 
-static void move_cursor_forward(gamma_t *g, uint32_t *x, const uint32_t *y);
+static void show_player_info(gamma_t *g, const view_t *view, uint32_t player,
+                             uint64_t free_fields);
 
-static void move_cursor_back(gamma_t *g, uint32_t *x, const uint32_t *y);
+static bool prepare_frame(gamma_t *g, view_t *view);
 
-static uint32_t count_real_x(gamma_t *g, uint32_t x);
+static void show_frame(gamma_t *g, view_t *view, uint32_t player,
+                       uint64_t free_fields);
 
-static void read_player_input(gamma_t *g, uint32_t player, uint32_t *x,
-														uint32_t *y, bool *end);
+static void print_summary(gamma_t *g, view_t *view);
 
-static void simulate_turn(gamma_t *g, bool *end, uint32_t *x, uint32_t *y);
+static uint32_t shift_coordinate(uint32_t coordinate, int64_t delta,
+                                 uint32_t size);
 
-static void get_window_size(uint32_t *terminal_width, uint32_t *terminal_height);
+static void move_cursor(gamma_t *g, view_t *view, int64_t dx, int64_t dy);
+
+static void read_player_input(gamma_t *g, uint32_t player, uint64_t free_fields,
+                              view_t *view, bool *end);
 
-static bool board_to_large(gamma_t *g);
+static void simulate_turn(gamma_t *g, bool *end, view_t *view);
 
 
-/** @brief Czyta znaki wprowadzane w konsoli.
- * Funkcja czyta w sposób ciągły kolejne znaki wprowadzane w konsoli.
- * @return Pobrany znak.
+/** @brief Inicjalizuje widoczny fragment planszy.
+ * Kursor jest ustawiany w lewym, górnym rogu planszy.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] view 	- wskaźnik na inicjalizowany opis fragmentu planszy.
  */
-char getch() {
-	char c;
-	struct termios new, old;
-	
-	tcgetattr(STDIN_FILENO, &old);
-	new = old;
-	new.c_lflag &= ~ICANON;
-	new.c_lflag &= ~ECHO;
-	
-	tcsetattr(STDIN_FILENO, TCSANOW, &new);
-	c = (char)getchar();
-	
-	tcsetattr(STDIN_FILENO, TCSANOW, &old);
-	return c;
+void init_view(gamma_t *g, view_t *view) {
+	view->cursor_x = view->left = view->bottom = 0;
+	view->cursor_y = gamma_height(g) - 1;
+	view->cell_width = gamma_players(g) > 9 ? number_of_digits(gamma_players(g)) + 1
+	                                         : 1;
 }
 
-/** @brief Wypisuje planszę z obecnym stanem rozgrywki.
- * Zachowuje położenie kursora tzn. po zakończeniu działania funkcji
- * jego położenie jest takie same jak przed wypisaniem.
- * @param[in] g 			- wskaźnik na strukturę przechowującą stan gry.
+/** @brief Sprawdza wielkość terminala i zapisuje wymiary na zmienne.
+ * Jeśli wymiarów nie da się odczytać (np. wyjście nie jest terminalem),
+ * przyjmuje wymiary domyślne.
+ * @param[out] terminal_width 	- zmienna, na którą zapisujemy szerokość terminala,
+ * @param[out] terminal_height 	- zmienna, na którą zapisujemy wysokość terminala.
  */
-void show_board(gamma_t *g) {
-	char *board = gamma_board(g);
-	if(board == NULL) {
-		return;
+void get_window_size(uint32_t *terminal_width, uint32_t *terminal_height) {
+	struct winsize winsize;
+	if(ioctl(STDOUT_FILENO, TIOCGWINSZ, &winsize) != 0
+	   || winsize.ws_col == 0 || winsize.ws_row == 0) {
+		winsize.ws_col = DEFAULT_TERMINAL_WIDTH;
+		winsize.ws_row = DEFAULT_TERMINAL_HEIGHT;
 	}
-	printf(SAVE_CURSOR_POSITION MOVE_CURSOR_TO_TOP_LEFT CLEAR_DISPLAY);
-	printf("%s", board);
-	printf(RESTORE_CURSOR_POSITION);
-	free(board);
+	*terminal_width = winsize.ws_col;
+	*terminal_height = winsize.ws_row;
 }
 
-/** @brief Wypisuje informacje dotyczące danego gracza.
- * Przesuwa kursor do pierwszej lini nie zajętej przez planszę i wypisuje
- * informacje dotyczące danego gracza. Zachowuje położenie kursora tzn.
- * po zakończeniu działania funkcji jego położenie jest takie same jak przed
- * wypisaniem.
- * @param[in] g 			- wskaźnik na strukturę przechowującą stan gry,
- * @param[in] player		- numer gracza, którego informacje wypisujemy,
- * @param[in] free_fields	- liczba wolnych pól, które może zająć dany gracza,
- * @param[in] y 			- wartość współrzędnej pionowej w terminalu.
+/** @brief Przesuwa okno wzdłuż jednej osi tak, aby kursor był widoczny.
+ * Okno jest przesuwane, gdy kursor zbliży się do jego krawędzi na mniej niż
+ * @ref SCROLL_MARGIN pól, ale nigdy poza planszę.
+ * @param[in] cursor 	- współrzędna kursora,
+ * @param[in,out] first - pierwsza widoczna współrzędna,
+ * @param[in] visible 	- liczba widocznych pól, dodatnia i nie większa niż
+ * 						@p size,
+ * @param[in] size 		- rozmiar planszy wzdłuż osi.
  */
-void show_player_info(gamma_t *g, uint32_t player, uint64_t free_fields, uint32_t y) {
-	uint64_t busy_fields = gamma_busy_fields(g, player);
-	uint32_t num_of_lines = gamma_height(g) - y + 1;
-	
-	printf(SAVE_CURSOR_POSITION MOVE_CURSOR_MANY_LINES_DOWN(num_of_lines));
-	printf(CLEAR_LINE);
-	printf("PLAYER %d BUSY_FIELDS %lu FREE_FIELDS %lu", player,
-			busy_fields, free_fields);
-	if(gamma_golden_possible(g, player)) {
-		printf(" GOLDEN_MOVE_AVAILABLE");
+void scroll_axis(uint32_t cursor, uint32_t *first, uint32_t visible,
+                 uint32_t size) {
+	uint32_t margin = SCROLL_MARGIN;
+	if(2 * margin + 1 > visible) {
+		margin = (visible - 1) / 2;
+	}
+	if(cursor < *first + margin) {
+		*first = cursor > margin ? cursor - margin : 0;
+	}
+	else if((uint64_t)cursor + margin >= (uint64_t)*first + visible) {
+		*first = cursor + margin + 1 - visible;
+	}
+	if(*first > size - visible) {
+		*first = size - visible;
 	}
-	printf("\n");
-	printf(RESTORE_CURSOR_POSITION);
 }
 
-/** @brief Wypisuje podsumowanie gry.
- * Przesuwa kursor do pierwszej lini nie zajętej przez planszę i wypisuje
- * podsumowanie gry dla wszystkich graczy.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[in] y 		- wartość współrzędnej pionowej w terminalu.
+/** @brief Dopasowuje okno do rozmiaru terminala i położenia kursora.
+ * @param[in] g 				- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] view 			- wskaźnik na opis widocznego fragmentu planszy,
+ * @param[in] terminal_width 	- szerokość terminala,
+ * @param[in] terminal_height 	- wysokość terminala.
  */
-void print_summary(gamma_t *g, uint32_t y) {
-	uint32_t num_of_lines = gamma_height(g) - y + 1;
-	
-	printf(MOVE_CURSOR_MANY_LINES_DOWN(num_of_lines));
-	printf(CLEAR_LINE);
-	uint32_t players = gamma_players(g);
-	for(uint32_t i = 1; i <= players; i++) {
-		uint64_t owned_fields = gamma_busy_fields(g, i);
-		printf("PLAYER %d OWNED_FIELDS %lu\n", i, owned_fields);
+void fit_view(gamma_t *g, view_t *view, uint32_t terminal_width,
+              uint32_t terminal_height) {
+	view->columns = terminal_width / view->cell_width;
+	view->rows = terminal_height > INFO_LINES ? terminal_height - INFO_LINES : 0;
+	if(view->columns > gamma_width(g)) {
+		view->columns = gamma_width(g);
+	}
+	if(view->rows > gamma_height(g)) {
+		view->rows = gamma_height(g);
+	}
+	if(view->columns == 0) {
+		view->columns = 1;
 	}
+	if(view->rows == 0) {
+		view->rows = 1;
+	}
+	scroll_axis(view->cursor_x, &view->left, view->columns, gamma_width(g));
+	scroll_axis(view->cursor_y, &view->bottom, view->rows, gamma_height(g));
 }
 
-/** @brief Dodaje lub usuwa podświetlenie.
- * Funkcja, w zależności od wartości zmiennej add, dodaje lub usuwa
- * podświetlenie. Zmienna lokalna position to numer znaku w napisie z
- * planszą, na którym obecnie znajduje się kursor w terminalu. Wartość ta wynika z
- * przyjętego, w @ref gamma_board, sposobu wypisywania graczy o wielu cyfrach.
- * Dodając lub usuwając podświetlenie wypisujemy (num_of_digits - 1) znaków z
- * napisu, zaczynając od znaku pod numerem (position + 1), ponieważ pierwszy znak
- * numeru gracza będzie zawsze podświetlony przez kursor. W ten sposób nie
- * wypisujemy po raz kolejny całej planszy, a jednynie kawałek wymagający
- * modyfikacji.
- * @param[in] g 				- wskaźnik na strukturę przechowującą stan gry,
- * @param[in] x 				- aktualna wartość współrzędnej poziomej położenia
- * 								kursora w terminalu,
- * @param[in] y 				- aktualna wartość współrzędnej pionowej położenia
- * 								kursora w terminalu,
- * @param[in] add 				- zmienna, której wartość określa sposób
- * działania funkcji. Jeśli ma wartość true to funkcja dodaje podświetlenie,
- * jeśli false usuwa.
+/** @brief Zapisuje wygląd jednego pola planszy.
+ * Pole ma taki sam wygląd jak w napisie tworzonym przez @ref gamma_board.
+ * @param[out] destination 	- wskaźnik na bufor mieszczący @p cell_width znaków,
+ * @param[in] owner 		- numer gracza zajmującego pole lub 0,
+ * @param[in] cell_width 	- liczba znaków zajmowanych przez jedno pole.
  */
-void manage_highlight(gamma_t *g, uint32_t x, uint32_t y, bool add) {
-	char *board = gamma_board(g);
-	if(board == NULL) {
-		return;
+void format_cell(char *destination, uint32_t owner, uint32_t cell_width) {
+	size_t length = 1;
+	if(owner == 0) {
+		destination[0] = '.';
 	}
-	uint32_t players = gamma_players(g),
-			width = gamma_width(g);
-	int num_of_digits = number_of_digits(players);
-	uint64_t position = (y - 1) * (width * (num_of_digits + 1) + 1) + x;
-	
-	printf(SAVE_CURSOR_POSITION);
-	
-	printf(MOVE_CURSOR_FORWARD);
-	if(add) {
-		printf(ACTIVATE_REVERSE_FG_BG "%.*s" RESET,
-			   num_of_digits - 1, board + position);
+	else if(cell_width == 1) {
+		destination[0] = (char)(owner + '0');
 	}
-	else { //delete_highlight
-		printf("%.*s",
-			   num_of_digits - 1, board + position);
+	else {
+		length = format_number(destination, owner);
 	}
-	
-	printf(RESTORE_CURSOR_POSITION);
-	free(board);
+	memset(destination + length, ' ', cell_width - length);
 }
 
-/** @brief Dodaje podświetlenie.
- * Funkcja dodaje podświetlenie wołając funkcję @ref manage_highlight z odpowiednią
- * wartością ostatniego argumentu.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[out] x		- aktualna wartość współrzędnej poziomej położenia
- * 						kursora w terminalu,
- * @param[out] y 		- aktualna wartość współrzędnej pionowej położenia
- * 						kursora w terminalu.
+/** @brief Wpisuje widoczny fragment planszy do budowanej klatki.
+ * Koszt zależy od rozmiaru terminala, a nie planszy. Przy więcej niż
+ * 9 graczach pole, na którym jest kursor, jest podświetlone.
+ * @param[in] g 			- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] view 			- wskaźnik na opis widocznego fragmentu planszy.
  */
-void add_highlight(gamma_t *g, uint32_t x, uint32_t y) {
-	manage_highlight(g, x, y, true);
+void show_board(gamma_t *g, const view_t *view) {
+	bool highlight = gamma_players(g) > 9;
+	char cell[UINT64_LIMIT + 1];
+	for(uint32_t row = 0; row < view->rows; row++) {
+		uint32_t y = view->bottom + view->rows - 1 - row;
+		for(uint32_t column = 0; column < view->columns; column++) {
+			uint32_t x = view->left + column;
+			bool cursor = highlight && x == view->cursor_x && y == view->cursor_y;
+			format_cell(cell, gamma_field_owner(g, x, y), view->cell_width);
+			put_text(&screen, row, column * view->cell_width, cell,
+			         view->cell_width, cursor);
+		}
+	}
 }
 
-/** @brief Usuwa podświetlenie.
- * Funkcja usuwa podświetlenie wołając funkcję @ref manage_highlight z odpowiednią
- * wartością ostatniego argumentu.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[out] x 		- aktualna wartość współrzędnej poziomej położenia
- * 						kursora w terminalu,
- * @param[out] y 		- aktualna wartość współrzędnej pionowej położenia
- * 						kursora w terminalu.
+/** @brief Wpisuje informacje dotyczące danego gracza do budowanej klatki.
+ * Informacje trafiają do pierwszej linijki pod planszą.
+ * @param[in] g 			- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] view 			- wskaźnik na opis widocznego fragmentu planszy,
+ * @param[in] player		- numer gracza, którego informacje wypisujemy,
+ * @param[in] free_fields	- liczba wolnych pól, które może zająć dany gracza.
  */
-void delete_highlight(gamma_t *g, uint32_t x, uint32_t y) {
-	manage_highlight(g, x, y, false);
+void show_player_info(gamma_t *g, const view_t *view, uint32_t player,
+                      uint64_t free_fields) {
+	char info[INFO_LIMIT];
+	uint64_t busy_fields = gamma_busy_fields(g, player);
+	int length = snprintf(info, INFO_LIMIT, "PLAYER %u BUSY_FIELDS %lu FREE_FIELDS %lu%s",
+	                      player, busy_fields, free_fields,
+	                      gamma_golden_possible(g, player) ? " GOLDEN_MOVE_AVAILABLE" : "");
+	put_text(&screen, view->rows, 0, info, (size_t)length, false);
 }
 
-/** @brief Przesuwa kursor w górę.
- * Przesuwa kursor w górę, o ile nie jest już na krawędzi planszy.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[out] x		- wskaźnik na aktualną wartość współrzędnej poziomej
- * 						położenia kursora w terminalu,
- * @param[in,out] y 	- wskaźnik na aktualną wartość współrzędnej pionowej
- * 						położenia kursora w terminalu.
+/** @brief Przygotowuje ekran do zbudowania klatki.
+ * Dopasowuje wymiary ekranu do terminala, a okno do kursora.
+ * @param[in] g 			- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] view 		- wskaźnik na opis widocznego fragmentu planszy.
+ * @return Wartość @p true, jeśli się udało lub @p false, jeśli zabrakło
+ * pamięci na klatkę.
  */
-void move_cursor_up(gamma_t *g, const uint32_t *x, uint32_t *y) {
-	if((*y) > 1) {
-		if(gamma_players(g) > 9) {
-			delete_highlight(g, *x, *y);
-		}
-		printf(MOVE_CURSOR_UP);
-		--(*y);
-	}
+bool prepare_frame(gamma_t *g, view_t *view) {
+	uint32_t terminal_width, terminal_height;
+	get_window_size(&terminal_width, &terminal_height);
+	fit_view(g, view, terminal_width, terminal_height);
+	return resize_screen(&screen, terminal_height, terminal_width);
 }
 
-/** @brief Przesuwa kursor w dół.
- * Przesuwa kursor w dół, o ile nie jest już na krawędzi planszy.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[out] x		- wskaźnik na aktualną wartość współrzędnej poziomej
- * 						położenia kursora w terminalu,
- * @param[in,out] y 	- wskaźnik na aktualną wartość współrzędnej pionowej
- * 						położenia kursora w terminalu.
+/** @brief Wyświetla cały ekran gry.
+ * Buduje klatkę z widocznym fragmentem planszy i informacjami o graczu,
+ * a następnie wyświetla ją, ustawiając kursor terminala na polu, na którym
+ * jest kursor gry. Do terminala trafiają tylko zmiany względem poprzedniej
+ * klatki.
+ * @param[in] g 			- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] view 		- wskaźnik na opis widocznego fragmentu planszy,
+ * @param[in] player		- numer gracza wykonującego ruch,
+ * @param[in] free_fields	- liczba wolnych pól, które może zająć dany gracza.
  */
-void move_cursor_down(gamma_t *g, const uint32_t *x, uint32_t *y) {
-	if((*y) < gamma_height(g)) {
-		if(gamma_players(g) > 9) {
-			delete_highlight(g, *x, *y);
-		}
-		printf(MOVE_CURSOR_DOWN);
-		(*y)++;
+void show_frame(gamma_t *g, view_t *view, uint32_t player, uint64_t free_fields) {
+	if(!prepare_frame(g, view)) {
+		return;
 	}
+	show_board(g, view);
+	show_player_info(g, view, player, free_fields);
+	present_frame(&screen, view->bottom + view->rows - 1 - view->cursor_y,
+	              (view->cursor_x - view->left) * view->cell_width);
 }
 
-/** @brief Przesuwa kursor do przodu (w prawo).
- * Przesuwa kursor do przodu (w prawo), o ile nie jest już na krawędzi planszy.
+/** @brief Wypisuje podsumowanie gry.
+ * Wyświetla widoczny fragment planszy, a pod nim podsumowanie gry dla
+ * graczy, którzy wykonali ruch. Pozostali gracze nie mają pól, a ich liczba
+ * może sięgać UINT32_MAX.
  * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[in,out] x 	- wskaźnik na aktualną wartość współrzędnej poziomej
- * 						położenia kursora w terminalu,
- * @param[out] y 		- wskaźnik na aktualną wartość współrzędnej pionowej
- * 						położenia kursora w terminalu.
+ * @param[in,out] view 	- wskaźnik na opis widocznego fragmentu planszy.
  */
-void move_cursor_forward(gamma_t *g, uint32_t *x, const uint32_t *y) {
-	uint32_t players = gamma_players(g);
-	uint32_t num_of_digits = number_of_digits(players);
-	if(players > 9 && (*x)/(num_of_digits + 1) + 1 < gamma_width(g)) {
-		delete_highlight(g, *x, *y);
-		
-		printf(MOVE_CURSOR_MANY_CELLS_FORWARD(num_of_digits + 1));
-		(*x) += num_of_digits + 1;
+void print_summary(gamma_t *g, view_t *view) {
+	if(prepare_frame(g, view)) {
+		show_board(g, view);
+		present_frame(&screen, view->rows, 0);
 	}
-	else if((*x) < gamma_width(g)) {
-		printf(MOVE_CURSOR_FORWARD);
-		(*x)++;
+	clear_below(&screen, view->rows);
+	uint32_t count = 0;
+	uint32_t *players = gamma_active_players(g, &count);
+	for(uint32_t i = 0; players != NULL && i < count; i++) {
+		char line[INFO_LIMIT];
+		int length = snprintf(line, INFO_LIMIT, "PLAYER %u OWNED_FIELDS %lu\n",
+		                      players[i], gamma_busy_fields(g, players[i]));
+		write_text(&screen, line, (size_t)length);
 	}
+	free(players);
+	flush_screen(&screen);
 }
 
-/** @brief Przesuwa kursor do tyłu (w lewo).
- * Przesuwa kursor do tyłu (w lewo), o ile nie jest już na krawędzi planszy.
- * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
- * @param[in,out] x 	- wskaźnik na wartość współrzędnej poziomej w terminalu,
- * @param[out] y		- wskaźnik na aktualną wartość współrzędnej pionowej
- * 						położenia kursora w terminalu.
+/** @brief Przesuwa współrzędną, nie wychodząc poza planszę.
+ * @param[in] coordinate 	- współrzędna,
+ * @param[in] delta 		- przesunięcie,
+ * @param[in] size 			- rozmiar planszy wzdłuż osi.
+ * @return Przesunięta współrzędna, obcięta do przedziału [0, size - 1].
  */
-void move_cursor_back(gamma_t *g, uint32_t *x, const uint32_t *y) {
-	uint32_t players = gamma_players(g);
-	uint32_t num_of_digits = number_of_digits(players);
-	if(players > 9 && (*x)/(num_of_digits + 1) + 1  > 1) {
-		delete_highlight(g, *x, *y);
-		
-		printf(MOVE_CURSOR_MANY_CELLS_BACK(num_of_digits + 1));
-		(*x) -= num_of_digits + 1;
+uint32_t shift_coordinate(uint32_t coordinate, int64_t delta, uint32_t size) {
+	int64_t shifted = (int64_t)coordinate + delta;
+	if(shifted < 0) {
+		return 0;
 	}
-	else if((*x) > 1) {
-		printf(MOVE_CURSOR_BACK);
-		--(*x);
+	if(shifted >= (int64_t)size) {
+		return size - 1;
 	}
+	return (uint32_t)shifted;
 }
 
-/** @brief Liczy wartość współrzędnej x na planszy.
- * Funkcja przekształca wartość współrzędnej x z układu terminala na wartość
- * tej współrzędnej w układzie odniesienia planszy. Wzór na x bierze się stąd,
- * że dla >9 graczy na planszy, początek n-tego numeru gracza w linijce
- * znajduje się na pozycji (n - 1) * (num_of_digits + 1) + 1.
- * @param g 				- wskaźnik na strukturę przechowującą stan gry,
- * @param x 				- współrzędna pozioma położenia kursora w terminalu,
- * @return Wartość współrzędnej x w układzie odniesienia planszy.
+/** @brief Przesuwa kursor.
+ * Przesuwa kursor o zadaną liczbę pól, zatrzymując go na krawędzi planszy.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] view 	- wskaźnik na opis widocznego fragmentu planszy,
+ * @param[in] dx 		- przesunięcie w poziomie,
+ * @param[in] dy 		- przesunięcie w pionie (w górę planszy).
  */
-uint32_t count_real_x(gamma_t *g, uint32_t x) {
-	uint32_t players = gamma_players(g);
-	uint32_t num_of_digits = number_of_digits(players);
-	if(players > 9) {
-		x = x/(num_of_digits + 1) + 1;
-	}
-	return x - 1;
+void move_cursor(gamma_t *g, view_t *view, int64_t dx, int64_t dy) {
+	view->cursor_x = shift_coordinate(view->cursor_x, dx, gamma_width(g));
+	view->cursor_y = shift_coordinate(view->cursor_y, dy, gamma_height(g));
 }
 
 /** @brief Czyta dane wejściowe z terminala i umożliwia wykonanie ruchu.
  * Pozwala na wykonanie jednego ruchu (@ref gamma_move lub @ref gamma_golden_move),
  * przez jednego gracza.
- * Czyta w sposób ciągły, za pomocą funkcji @ref getch, wartości klawiszy
- * wciskanych przez użytkownika w czasie gry. Wywołuje odpowiednie funkcje,
- * przesuwające kursor lub wykonujące ruchu na planszy.
- * Zmienne real_x i real_y, deklarowane w funkcji, zapisują położenie kursora
- * na planszy (według układu odniesienia planszy, a nie terminala) i to one są
- * przekazywane do funkcji silnika, w celu wykonia ruchu na dane pole.
+ * Czyta w sposób ciągły, za pomocą funkcji @ref next_key, zdarzenia
+ * z klawiatury. Wywołuje odpowiednie funkcje, przesuwające kursor lub
+ * wykonujące ruchu na planszy. Po każdym zdarzeniu wyświetlana jest nowa
+ * klatka, więc okno przesuwa się razem z kursorem. Powtórzenia strzałki
+ * czekające w buforze są przetwarzane razem, z jedną klatką.
  * @param[in,out] g 		- wskaźnik na strukturę przechowującą stan gry,
  * @param[in] player 		- numer gracza, który ma wykonać ruch,
- * @param[in,out] x 		- współrzędna pozioma położenia kursora w terminalu,
- * @param[in,out] y 		- współrzędna pionowa położenia kursora w terminalu,
+ * @param[in] free_fields	- liczba wolnych pól, które może zająć dany gracz,
+ * @param[in,out] view 		- wskaźnik na opis widocznego fragmentu planszy,
  * @param[in,out] end 		- zmienna zapisująca informację o konieczności
  * 							zakończenia gry, w tej funkcji może przyjąć wartość
- * 							@p true, gdy gracz wciśnie Ctrl + D.
+ * 							@p true, gdy gracz wciśnie Ctrl + D lub wejście
+ * 							się skończy.
  */
-void read_player_input(gamma_t *g, uint32_t player, uint32_t *x, uint32_t *y,
-																	bool *end) {
-	uint32_t real_x, real_y;
+void read_player_input(gamma_t *g, uint32_t player, uint64_t free_fields,
+                       view_t *view, bool *end) {
 	bool move_made = false;
-	char first, second, third;
+	keypress_t key;
 	
-	first = second = '\0';
 	while(!move_made) {
-		if(gamma_players(g) > 9) {
-			add_highlight(g, *x, *y);
-		}
-		real_x = count_real_x(g, *x);
-		real_y = gamma_height(g) - (*y);
-		third = getch();
-		if(third == EOT) {
+		show_frame(g, view, player, free_fields);
+		uint32_t x = view->cursor_x, y = view->cursor_y;
+		if(!next_key(&keyboard, &key)
+		   || (key.type == KEY_CHARACTER && key.character == EOT)) {
 			(*end) = true;
 			move_made = true;
 		}
-		else if(third == ' ') {
-			move_made = gamma_move(g, player, real_x, real_y);
+		else if(key.type == KEY_UP) {
+			move_cursor(g, view, 0, key.repeat);
 		}
-		else if(third == 'g' || third == 'G') {
-			move_made = gamma_golden_move(g, player, real_x, real_y);
+		else if(key.type == KEY_DOWN) {
+			move_cursor(g, view, 0, -(int64_t)key.repeat);
 		}
-		else if(first == '\x1b' && second == '[' && third == 'A') {
-			move_cursor_up(g, x, y);
+		else if(key.type == KEY_RIGHT) {
+			move_cursor(g, view, key.repeat, 0);
 		}
-		else if(first == '\x1b' && second == '[' && third == 'B') {
-			move_cursor_down(g, x, y);
+		else if(key.type == KEY_LEFT) {
+			move_cursor(g, view, -(int64_t)key.repeat, 0);
 		}
-		else if(first == '\x1b' && second == '[' && third == 'C') {
-			move_cursor_forward(g, x, y);
+		else if(key.character == ' ') {
+			move_made = gamma_move(g, player, x, y);
+			if(move_made) {
+				record_move(g, 'm', player, x, y);
+				publish_move('m', player, x, y);
+				flush_spectator_stream();
+			}
 		}
-		else if(first == '\x1b' && second == '[' && third == 'D') {
-			move_cursor_back(g, x, y);
+		else if(key.character == 'g' || key.character == 'G') {
+			move_made = gamma_golden_move(g, player, x, y);
+			if(move_made) {
+				record_move(g, 'g', player, x, y);
+				publish_move('g', player, x, y);
+				flush_spectator_stream();
+			}
 		}
-		else if(third == 'c' || third == 'C') {
+		else if(key.character == 'c' || key.character == 'C') {
 			move_made = true;
 		}
-		first = second;
-		second = third;
 	}
 }
 
 /** @brief Symuluje jedną turę rozgrywki.
  * Funkcja przeprowadza jedną turę rozgrywki tzn. zarządza wykonaniem ruchu przez
- * wszyskich kolejnych graczy. Każdorazowo sprawdza czy dany gracz może wykonać
- * ruch. Jeśli tak, funkcja rozpoczyna czytanie wciskanych klawiszy,
- * w przeciwnym wypadku sprawdzany jest następny gracz. Funkcja kończy działanie,
- * gdy został wciśnięty klawisz kończący rozgrywkę lub gdy żaden z graczy nie może
- * już wykonać ruchu.
+ * wszyskich kolejnych graczy, którzy mogą wykonać ruch. Kolejnego takiego
+ * gracza wyznacza @ref gamma_next_player_with_move, bez sprawdzania
+ * pozostałych graczy. Funkcja kończy działanie, gdy został wciśnięty klawisz
+ * kończący rozgrywkę, gdy wszyscy gracze wykonali ruch lub gdy żaden z graczy
+ * nie może już wykonać ruchu.
  * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
  * @param[in,out] end 	- zmienna zapisująca informację czy należy zakończyć grę,
- * @param[in,out] x 	- wskaźnik na wartość współrzędnej poziomej w terminalu.
- * @param[in,out] y 	- wskaźnik na wartość współrzędnej pionowej w terminalu.
+ * @param[in,out] view 	- wskaźnik na opis widocznego fragmentu planszy.
  */
-void simulate_turn(gamma_t *g, bool *end, uint32_t *x, uint32_t *y) {
-	uint32_t player = 1,
-	num_of_players = gamma_players(g),
-	players_without_move = 0;
-	uint64_t free_fields;
-	bool golden_possible;
-	while(player <= num_of_players && !(*end)) {
-		free_fields = golden_possible = 0;
-		while(free_fields == 0 && !golden_possible && player <= num_of_players) {
-			free_fields = gamma_free_fields(g, player);
-			golden_possible = gamma_golden_possible(g, player);
-			if(free_fields == 0 && !golden_possible) {
-				players_without_move++;
-				player++;
-			}
-		}
-		if(player <= num_of_players) {
-			show_board(g);
-			show_player_info(g, player, free_fields, *y);
-			read_player_input(g, player, x, y, end);
-			player++;
-		}
-		else if(players_without_move == num_of_players) {
-			(*end) = true;
-		}
+void simulate_turn(gamma_t *g, bool *end, view_t *view) {
+	uint32_t player = gamma_next_player_with_move(g, 0);
+	if(player == 0) {
+		(*end) = true;
+	}
+	while(player != 0 && !(*end)) {
+		read_player_input(g, player, gamma_free_fields(g, player), view, end);
+		uint32_t next_player = gamma_next_player_with_move(g, player);
+		player = (next_player > player ? next_player : 0);
 	}
 }
 
-/** @brief Sprawdza wielkość terminala i zapisuje wymiary na zmienne.
- * @param[out] terminal_width 	- zmienna, na którą zapisujemy szerokość terminala,
- * @param[out] terminal_height 	- zmienna, na którą zapisujemy wysokość terminala.
- */
-void get_window_size(uint32_t *terminal_width, uint32_t *terminal_height) {
-	struct winsize winsize;
-	ioctl(STDOUT_FILENO, TIOCGWINSZ, &winsize);
-	
-	*terminal_width = winsize.ws_col;
-	*terminal_height = winsize.ws_row;
+int interactive_mode(gamma_t *g, input_t *input) {
+	init_keyboard(&keyboard, input);
+	bool end = false;
+	view_t view;
+	init_view(g, &view);
+	init_screen(&screen, STDOUT_FILENO);
+	enable_raw_mode(STDIN_FILENO);
+	while(!end) {
+		simulate_turn(g, &end, &view);
+	}
+	print_summary(g, &view);
+	restore_terminal();
+	delete_screen(&screen);
+	return 0;
 }
 
-/** @brief Sprawdza czy plansza nie jest zbyt duża.
- * Sprawdza czy plansza nie przekracza wymiarów terminala pomniejszonych o
- * zapasowe 5 komórek.
- * @param[in] g 	- wskaźnik na strukturę przechowującą stan gry,
- * @return Wartość @p true, jeśli wymiary planszy przekraczają rozmiar okna
- * terminala pomniejszony o 5 komórek zapasu. Wartość @p false, w przeciwnym
- * wypadku, gdy żądane wymiary planszy mieszczą się w limicie.
- */
-bool board_to_large(gamma_t *g) {
-	const int margin = 5; //zostawiamy zawsze 5 pól zapasu na brzegach terminalu
-	uint64_t board_width;
-	uint32_t board_height = gamma_height(g),
-	players = gamma_players(g),
-	num_of_digits = number_of_digits(players),
-	terminal_width, terminal_height;
-	get_window_size(&terminal_width, &terminal_height);
-	if(num_of_digits > 1) {
-		board_width = (uint64_t)gamma_width(g) * ((uint64_t)num_of_digits + 1);
+void show_spectator_frame(gamma_t *g, uint32_t x, uint32_t y, uint32_t player,
+                          uint64_t moves) {
+	if(!spectating) {
+		init_view(g, &spectator_view);
+		init_screen(&screen, STDOUT_FILENO);
+		spectating = true;
 	}
-	else {
-		board_width = (uint64_t)gamma_width(g);
-	}
-	if((uint64_t)board_width + margin > terminal_width
-	|| (uint64_t)board_height + margin > terminal_height) {
-		printf(MOVE_CURSOR_TO_TOP_LEFT CLEAR_DISPLAY);
-		printf("Cannot create the game. Chosen board is too large for "
-		 "terminal window.\n");
-		printf("Please, choose smaller one, change font size or/and resize"
-		 " terminal window.\n" "Ending program.\n");
-		return true;
+	spectator_view.cursor_x = x;
+	spectator_view.cursor_y = y;
+	if(!prepare_frame(g, &spectator_view)) {
+		return;
 	}
-	return false;
+	show_board(g, &spectator_view);
+	char info[INFO_LIMIT];
+	int length = snprintf(info, INFO_LIMIT, "MOVE %lu PLAYER %u", moves, player);
+	put_text(&screen, spectator_view.rows, 0, info, (size_t)length, false);
+	present_frame(&screen, spectator_view.bottom + spectator_view.rows - 1 - y,
+	              (x - spectator_view.left) * spectator_view.cell_width);
 }
 
-int interactive_mode(gamma_t *g) {
-	if(board_to_large(g)) {
-		return 1;
+void close_spectator_view(gamma_t *g) {
+	if(!spectating) {
+		init_view(g, &spectator_view);
+		init_screen(&screen, STDOUT_FILENO);
 	}
-	
-	bool end = false;
-	printf(MOVE_CURSOR_TO_TOP_LEFT);
-	uint32_t x = 1, y = 1; //współrzędne kursora w terminalu, nie na planszy!!!
-	while(!end) {
-		simulate_turn(g, &end, &x, &y);
-	}
-	show_board(g);
-	print_summary(g, y);
-	return 0;
+	print_summary(g, &spectator_view);
+	delete_screen(&screen);
+	spectating = false;
 }
@@ -8,16 +8,38 @@
 #define INTERACTIVE_MODE_H
 
 #include "gamma.h"
+#include "input.h"
 
 /** @brief Obsługuje interactive mode (tryb interaktywny).
  * Główna funkcja zarządzająca działaniem w trybie interaktywnym. Wywołuje w
  * pętli funkcję przeprowadzającą jedną turę gry. Na koniec działania wypisuje
- * podsumowanie gry i zwalnia pamięć alokowaną na @ref gamma_t.
- * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry.
+ * podsumowanie gry. Plansza większa od terminala jest wyświetlana we
+ * fragmentach: widoczne okno przesuwa się, gdy kursor zbliża się do jego
+ * krawędzi.
+ * @param[in,out] g 	- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] input - wskaźnik na strukturę buforowanego wejścia, z którego
+ * 						czytane są wciskane klawisze.
  * @return Wartość 0, jeśli rozgrywka w trybie interaktywnym zakończyła się w
- * sposób prawidłowy lub 1, gdy nie utworzono rozgrywki ze względu na zbyt dużą
- * plansze.
+ * sposób prawidłowy.
  */
-int interactive_mode(gamma_t *g);
+int interactive_mode(gamma_t *g, input_t *input);
+
+/** @brief Wyświetla klatkę trybu obserwatora.
+ * Przy pierwszym wywołaniu przygotowuje ekran. Widoczne okno podąża za
+ * ostatnio zmienionym polem, a pod planszą jest wypisywany numer ruchu.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x 		- współrzędna pozioma ostatnio zmienionego pola,
+ * @param[in] y 		- współrzędna pionowa ostatnio zmienionego pola,
+ * @param[in] player 	- numer gracza, który je zajął lub 0,
+ * @param[in] moves 	- liczba dotychczasowych ruchów.
+ */
+void show_spectator_frame(gamma_t *g, uint32_t x, uint32_t y, uint32_t player,
+                          uint64_t moves);
+
+/** @brief Kończy wyświetlanie w trybie obserwatora.
+ * Wyświetla ostatnią klatkę i podsumowanie gry dla wszystkich graczy.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry.
+ */
+void close_spectator_view(gamma_t *g);
 
 #endif /* INTERACTIVE_MODE_H */
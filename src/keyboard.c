@@ -0,0 +1,219 @@
+/** @file
+ * Implementacja klasy czytającej klawisze wciskane w terminalu.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< udostępnia funkcję sigaction
+
+#include <signal.h>
+#include <termios.h>
+#include <unistd.h>
+#include "keyboard.h"
+
+
+#define ESC '\x1b' ///< znak rozpoczynający sekwencję sterującą
+
+#define HANDLED_SIGNALS 4 ///< liczba sygnałów, po których przywracamy terminal
+
+
+static const int handled_signals[HANDLED_SIGNALS] = {SIGINT, SIGTERM, SIGHUP,
+                                                     SIGQUIT}; /**< sygnały,
+ * po których przywracamy ustawienia terminala */
+
+static struct sigaction original_actions[HANDLED_SIGNALS]; /**< obsługa
+ * sygnałów sprzed przełączenia terminala w tryb surowy */
+
+static struct termios original_settings; ///< ustawienia terminala do przywrócenia
+
+static volatile sig_atomic_t terminal_fd = -1; /**< deskryptor terminala
+ * w trybie surowym lub -1 */
+
+
+static void handle_signal(int signal_number);
+
+static bool arrow_key(unsigned char final, keypress_t *key);
+
+static bool decode_byte(keyboard_t *keyboard, char byte, keypress_t *key);
+
+static bool decode_key(keyboard_t *keyboard, keypress_t *key, bool wait);
+
+
+/** @brief Przywraca terminal i kończy program domyślną obsługą sygnału.
+ * Używa tylko funkcji, które można bezpiecznie wywołać w obsłudze sygnału.
+ * @param[in] signal_number 	- numer otrzymanego sygnału.
+ */
+void handle_signal(int signal_number) {
+	if(terminal_fd >= 0) {
+		tcsetattr(terminal_fd, TCSANOW, &original_settings);
+		terminal_fd = -1;
+	}
+	signal(signal_number, SIG_DFL);
+	raise(signal_number);
+}
+
+/** @brief Rozpoznaje strzałkę po ostatnim znaku sekwencji sterującej.
+ * @param[in] final 	- ostatni znak sekwencji,
+ * @param[out] key 		- wskaźnik, pod który zostaje zapisane zdarzenie.
+ * @return Wartość @p true, jeśli sekwencja oznacza strzałkę lub @p false
+ * w przeciwnym wypadku.
+ */
+bool arrow_key(unsigned char final, keypress_t *key) {
+	if(final == 'A') {
+		key->type = KEY_UP;
+	}
+	else if(final == 'B') {
+		key->type = KEY_DOWN;
+	}
+	else if(final == 'C') {
+		key->type = KEY_RIGHT;
+	}
+	else if(final == 'D') {
+		key->type = KEY_LEFT;
+	}
+	else {
+		return false;
+	}
+	key->character = (char)final;
+	key->repeat = 1;
+	return true;
+}
+
+/** @brief Przetwarza jeden bajt wejścia.
+ * Sekwencja CSI składa się z bajtów parametrów i bajtów pośrednich (od 0x20
+ * do 0x3F) zakończonych bajtem końcowym (od 0x40 do 0x7E), a sekwencja SS3
+ * z jednego bajtu. Bajt, który nie może należeć do przetwarzanej sekwencji,
+ * przerywa ją i jest przetwarzany jak poza sekwencją. Znak ESC, po którym nie
+ * następuje sekwencja, jest pomijany.
+ * @param[in,out] keyboard 	- wskaźnik na strukturę klawiatury,
+ * @param[in] byte 			- przetwarzany bajt,
+ * @param[out] key 			- wskaźnik, pod który zostaje zapisane zdarzenie.
+ * @return Wartość @p true, jeśli bajt zakończył zdarzenie lub @p false
+ * w przeciwnym wypadku.
+ */
+bool decode_byte(keyboard_t *keyboard, char byte, keypress_t *key) {
+	unsigned char c = (unsigned char)byte;
+	switch(keyboard->state) {
+		case DECODER_ESCAPE:
+			if(c == '[') {
+				keyboard->state = DECODER_CSI;
+				return false;
+			}
+			if(c == 'O') {
+				keyboard->state = DECODER_SS3;
+				return false;
+			}
+			break;
+		case DECODER_CSI:
+			if(c >= 0x20 && c <= 0x3F) {
+				return false;
+			}
+			if(c >= 0x40 && c <= 0x7E) {
+				keyboard->state = DECODER_GROUND;
+				return arrow_key(c, key);
+			}
+			break;
+		case DECODER_SS3:
+			if(c >= 0x20 && c <= 0x7E) {
+				keyboard->state = DECODER_GROUND;
+				return arrow_key(c, key);
+			}
+			break;
+		default:
+			break;
+	}
+	if(byte == ESC) {
+		keyboard->state = DECODER_ESCAPE;
+		return false;
+	}
+	keyboard->state = DECODER_GROUND;
+	key->type = KEY_CHARACTER;
+	key->character = byte;
+	key->repeat = 1;
+	return true;
+}
+
+/** @brief Odczytuje jedno zdarzenie, bez łączenia powtórzeń.
+ * @param[in,out] keyboard 	- wskaźnik na strukturę klawiatury,
+ * @param[out] key 			- wskaźnik, pod który zostaje zapisane zdarzenie,
+ * @param[in] wait 			- informacja czy czekać na dane, gdy bufor się
+ * 							skończy.
+ * @return Wartość @p true, jeśli odczytano zdarzenie lub @p false, jeśli
+ * dane się skończyły.
+ */
+bool decode_key(keyboard_t *keyboard, keypress_t *key, bool wait) {
+	while(true) {
+		if(keyboard->length == 0
+		   && (!wait || !next_records(keyboard->input, 1, &keyboard->data,
+		                              &keyboard->length))) {
+			return false;
+		}
+		keyboard->length--;
+		if(decode_byte(keyboard, *keyboard->data++, key)) {
+			return true;
+		}
+	}
+}
+
+
+void init_keyboard(keyboard_t *keyboard, input_t *input) {
+	keyboard->input = input;
+	keyboard->data = NULL;
+	keyboard->length = 0;
+	keyboard->state = DECODER_GROUND;
+	keyboard->has_pending = false;
+}
+
+bool next_key(keyboard_t *keyboard, keypress_t *key) {
+	if(keyboard->has_pending) {
+		*key = keyboard->pending;
+		keyboard->has_pending = false;
+	}
+	else if(!decode_key(keyboard, key, true)) {
+		return false;
+	}
+	if(key->type != KEY_CHARACTER) {
+		keypress_t next;
+		while(decode_key(keyboard, &next, false)) {
+			if(next.type != key->type) {
+				keyboard->pending = next;
+				keyboard->has_pending = true;
+				break;
+			}
+			if(key->repeat < UINT32_MAX) {
+				key->repeat++;
+			}
+		}
+	}
+	return true;
+}
+
+void enable_raw_mode(int fd) {
+	if(terminal_fd >= 0 || tcgetattr(fd, &original_settings) != 0) {
+		return;
+	}
+	struct termios raw = original_settings;
+	raw.c_lflag &= ~(tcflag_t)(ICANON | ECHO);
+	raw.c_cc[VMIN] = 1;
+	raw.c_cc[VTIME] = 0;
+	struct sigaction action;
+	action.sa_handler = handle_signal;
+	action.sa_flags = 0;
+	sigemptyset(&action.sa_mask);
+	terminal_fd = fd;
+	for(int i = 0; i < HANDLED_SIGNALS; i++) {
+		sigaction(handled_signals[i], &action, &original_actions[i]);
+	}
+	tcsetattr(fd, TCSANOW, &raw);
+}
+
+void restore_terminal(void) {
+	if(terminal_fd < 0) {
+		return;
+	}
+	tcsetattr(terminal_fd, TCSANOW, &original_settings);
+	terminal_fd = -1;
+	for(int i = 0; i < HANDLED_SIGNALS; i++) {
+		sigaction(handled_signals[i], &original_actions[i], NULL);
+	}
+}
@@ -0,0 +1,100 @@
+/** @file
+ * Interfejs klasy czytającej klawisze wciskane w terminalu.
+ * Terminal jest przełączany w tryb surowy (bez buforowania linijek i bez echa)
+ * jeden raz, na czas całej rozgrywki, i przywracany przy jej końcu lub po
+ * otrzymaniu sygnału kończącego program. Dane są czytane dużymi blokami, a
+ * sekwencje sterujące CSI (ESC [) i SS3 (ESC O) są rozpoznawane przez
+ * automat skończony, więc sekwencja może być podzielona pomiędzy kolejne
+ * bloki. Powtórzenia tej samej strzałki, które czekają już w buforze (np. gdy
+ * klawisz jest przytrzymany), są łączone w jedno zdarzenie.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef KEYBOARD_H
+#define KEYBOARD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "input.h"
+
+
+/**
+ * Rodzaje zdarzeń z klawiatury.
+ */
+typedef enum key_type {
+	KEY_CHARACTER, 	///< zwykły znak
+	KEY_UP, 		///< strzałka w górę
+	KEY_DOWN, 		///< strzałka w dół
+	KEY_RIGHT, 		///< strzałka w prawo
+	KEY_LEFT 		///< strzałka w lewo
+} key_type_t;
+
+/**
+ * Stany automatu rozpoznającego sekwencje sterujące.
+ */
+typedef enum decoder_state {
+	DECODER_GROUND, ///< poza sekwencją sterującą
+	DECODER_ESCAPE, ///< po znaku ESC
+	DECODER_CSI, 	///< wewnątrz sekwencji ESC [
+	DECODER_SS3 	///< po znakach ESC O
+} decoder_state_t;
+
+/**
+ * Zdarzenie z klawiatury.
+ */
+typedef struct keypress {
+	key_type_t type; 	///< rodzaj zdarzenia
+	char character; 	///< znak, jeśli zdarzenie jest zwykłym znakiem
+	uint32_t repeat; 	///< liczba połączonych powtórzeń klawisza, dodatnia
+} keypress_t;
+
+/**
+ * Stan klawiatury.
+ */
+typedef struct keyboard {
+	input_t *input; 		///< buforowane wejście, z którego czytamy
+	const char *data; 		///< nieprzetworzone dane z bufora wejścia
+	size_t length; 			///< liczba nieprzetworzonych bajtów
+	decoder_state_t state; 	///< stan automatu
+	keypress_t pending; 	/**< zdarzenie odczytane przy łączeniu powtórzeń,
+ * 							które należy zwrócić jako następne */
+	bool has_pending; 		///< informacja czy jest zdarzenie @p pending
+} keyboard_t;
+
+
+/** @brief Inicjalizuje klawiaturę.
+ * @param[out] keyboard - wskaźnik na inicjalizowaną strukturę,
+ * @param[in] input 	- wskaźnik na buforowane wejście, z którego czytamy.
+ * Część danych mogła zostać wczytana do jego bufora razem z pierwszym
+ * poleceniem.
+ */
+void init_keyboard(keyboard_t *keyboard, input_t *input);
+
+/** @brief Podaje kolejne zdarzenie z klawiatury.
+ * Czeka na dane, jeśli w buforze nie ma całego zdarzenia. Nierozpoznane
+ * sekwencje sterujące są pomijane.
+ * @param[in,out] keyboard 	- wskaźnik na strukturę klawiatury,
+ * @param[out] key 			- wskaźnik, pod który zostaje zapisane zdarzenie.
+ * @return Wartość @p true, jeśli przeczytano zdarzenie lub @p false, jeśli na
+ * wejściu nie ma już danych.
+ */
+bool next_key(keyboard_t *keyboard, keypress_t *key);
+
+/** @brief Przełącza terminal w tryb surowy.
+ * Zapamiętuje ustawienia terminala, wyłącza buforowanie linijek i echo oraz
+ * instaluje obsługę sygnałów SIGINT, SIGTERM, SIGHUP i SIGQUIT, która
+ * przywraca ustawienia przed zakończeniem programu. Nie robi nic, jeśli
+ * deskryptor nie jest terminalem.
+ * @param[in] fd 	- deskryptor terminala.
+ */
+void enable_raw_mode(int fd);
+
+/** @brief Przywraca ustawienia terminala.
+ * Przywraca ustawienia zapamiętane przez @ref enable_raw_mode i domyślną
+ * obsługę sygnałów. Nie robi nic, jeśli terminal nie jest w trybie surowym.
+ */
+void restore_terminal(void);
+
+#endif /* KEYBOARD_H */
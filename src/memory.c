@@ -0,0 +1,308 @@
+/** @file
+ * Implementacja klasy liczącej pamięć używaną przez grę.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "memory.h"
+
+
+#define ARENA_ALIGNMENT _Alignof(max_align_t) ///< wyrównanie bloków odcinanych z areny
+
+
+static void raise_peak(_Atomic uint64_t *peak, uint64_t value);
+
+static size_t align_size(size_t size);
+
+static bool uses_malloc(memory_t *memory, gamma_memory_category_t category);
+
+static void* allocate_in_arena(memory_t *memory, size_t size);
+
+static void* resize_in_arena(memory_t *memory, void *pointer, size_t old_size,
+                             size_t new_size);
+
+static void release_in_arena(memory_t *memory, void *pointer, size_t size);
+
+
+/** @brief Podnosi największą zanotowaną wartość.
+ * @param[in,out] peak 	- wskaźnik na największą wartość,
+ * @param[in] value 	- nowa wartość.
+ */
+void raise_peak(_Atomic uint64_t *peak, uint64_t value) {
+	uint64_t old = atomic_load_explicit(peak, memory_order_relaxed);
+	while(old < value
+	      && !atomic_compare_exchange_weak_explicit(peak, &old, value,
+	                                                memory_order_relaxed,
+	                                                memory_order_relaxed)) {
+	}
+}
+
+
+/** @brief Zaokrągla rozmiar bloku w górę do wielokrotności
+ * @ref ARENA_ALIGNMENT.
+ * @param[in] size 	- rozmiar bloku, nie większy niż rozmiar areny.
+ * @return Zaokrąglony rozmiar.
+ */
+size_t align_size(size_t size) {
+	return (size + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+}
+
+/** @brief Sprawdza czy pamięć danego rodzaju pochodzi z funkcji malloc.
+ * @param[in] memory 	- wskaźnik na liczniki lub NULL,
+ * @param[in] category 	- rodzaj pamięci.
+ * @return Wartość @p true, jeśli pamięć pochodzi z funkcji malloc lub
+ * @p false, jeśli z areny lub alokatora gry.
+ */
+bool uses_malloc(memory_t *memory, gamma_memory_category_t category) {
+	return memory == NULL || category == GAMMA_MEMORY_OUTPUT
+	       || (memory->arena == NULL && memory->allocator.allocate == NULL);
+}
+
+/** @brief Odcina blok z wierzchołka areny.
+ * @param[in,out] memory 	- wskaźnik na liczniki gry używającej areny,
+ * @param[in] size 			- rozmiar bloku.
+ * @return Wskaźnik na blok lub NULL, jeśli arena jest pełna.
+ */
+void* allocate_in_arena(memory_t *memory, size_t size) {
+	if(size > memory->arena_size) {
+		return NULL;
+	}
+	size_t aligned = align_size(size);
+	size_t top = atomic_load_explicit(&memory->arena_top, memory_order_relaxed);
+	do {
+		if(aligned > memory->arena_size - top) {
+			return NULL;
+		}
+	} while(!atomic_compare_exchange_weak_explicit(&memory->arena_top, &top,
+	                                               top + aligned,
+	                                               memory_order_acq_rel,
+	                                               memory_order_relaxed));
+	return memory->arena + top;
+}
+
+/** @brief Zmienia rozmiar bloku areny.
+ * Blok leżący na wierzchołku areny zmienia rozmiar w miejscu, a inny blok
+ * jest przenoszony na wierzchołek, chyba że się zmniejsza.
+ * @param[in,out] memory 	- wskaźnik na liczniki gry używającej areny,
+ * @param[in] pointer 		- wskaźnik na blok areny,
+ * @param[in] old_size 		- dotychczasowy rozmiar bloku,
+ * @param[in] new_size 		- nowy rozmiar bloku.
+ * @return Wskaźnik na blok o nowym rozmiarze lub NULL, jeśli arena jest
+ * pełna.
+ */
+void* resize_in_arena(memory_t *memory, void *pointer, size_t old_size,
+                      size_t new_size) {
+	size_t start = (size_t)((char *)pointer - memory->arena);
+	size_t end = start + align_size(old_size);
+	if(new_size <= memory->arena_size - start
+	   && atomic_compare_exchange_strong_explicit(&memory->arena_top, &end,
+	                                              start + align_size(new_size),
+	                                              memory_order_acq_rel,
+	                                              memory_order_relaxed)) {
+		return pointer;
+	}
+	if(new_size <= old_size) {
+		return pointer;
+	}
+	void *resized = allocate_in_arena(memory, new_size);
+	if(resized != NULL) {
+		memcpy(resized, pointer, old_size);
+		release_in_arena(memory, pointer, old_size);
+	}
+	return resized;
+}
+
+/** @brief Zwalnia blok areny.
+ * Pamięć wraca do areny tylko wtedy, gdy blok leży na jej wierzchołku.
+ * Pozostałe bloki są zwalniane razem z areną.
+ * @param[in,out] memory 	- wskaźnik na liczniki gry używającej areny,
+ * @param[in] pointer 		- wskaźnik na blok areny,
+ * @param[in] size 			- rozmiar bloku.
+ */
+void release_in_arena(memory_t *memory, void *pointer, size_t size) {
+	size_t start = (size_t)((char *)pointer - memory->arena);
+	size_t end = start + align_size(size);
+	atomic_compare_exchange_strong_explicit(&memory->arena_top, &end, start,
+	                                        memory_order_acq_rel,
+	                                        memory_order_relaxed);
+}
+
+
+memory_t* new_memory(const gamma_options_t *options) {
+	gamma_allocator_t allocator = {NULL, NULL, NULL, NULL};
+	if(options->allocator != NULL) {
+		allocator = *options->allocator;
+		if(allocator.allocate == NULL || allocator.resize == NULL
+		   || allocator.release == NULL) {
+			return NULL;
+		}
+	}
+	size_t size = sizeof(memory_t);
+	if(options->arena_size != 0) {
+		if(options->arena_size < align_size(sizeof(memory_t))) {
+			return NULL;
+		}
+		size = options->arena_size;
+	}
+	memory_t *memory = allocator.allocate == NULL
+	                   ? malloc(size) : allocator.allocate(allocator.context, size);
+	if(memory == NULL) {
+		return NULL;
+	}
+
+	for(int i = 0; i < GAMMA_MEMORY_CATEGORIES; i++) {
+		atomic_init(&memory->current[i], 0);
+		atomic_init(&memory->peak[i], 0);
+	}
+	atomic_init(&memory->total, 0);
+	atomic_init(&memory->peak_total, 0);
+	memory->budget = options->memory_budget;
+	memory->allocator = allocator;
+	memory->arena = (options->arena_size != 0 ? (char *)memory : NULL);
+	memory->arena_size = options->arena_size;
+	atomic_init(&memory->arena_top, (options->arena_size != 0
+	                                 ? align_size(sizeof(memory_t)) : 0));
+	if(!charge_memory(memory, GAMMA_MEMORY_GAME, sizeof(memory_t))) {
+		delete_memory(memory);
+		return NULL;
+	}
+	return memory;
+}
+
+void delete_memory(memory_t *memory) {
+	if(memory != NULL) {
+		gamma_allocator_t allocator = memory->allocator;
+		size_t size = (memory->arena != NULL ? memory->arena_size
+		                                     : sizeof(memory_t));
+		if(allocator.release == NULL) {
+			free(memory);
+		}
+		else {
+			allocator.release(allocator.context, memory, size);
+		}
+	}
+}
+
+bool memory_in_arena(memory_t *memory) {
+	return memory != NULL && memory->arena != NULL;
+}
+
+bool charge_memory(memory_t *memory, gamma_memory_category_t category,
+                   size_t size) {
+	if(memory == NULL) {
+		return true;
+	}
+	uint64_t total = atomic_fetch_add_explicit(&memory->total, size,
+	                                           memory_order_relaxed) + size;
+	if(memory->budget != 0 && (total > memory->budget || total < size)) {
+		atomic_fetch_sub_explicit(&memory->total, size, memory_order_relaxed);
+		return false;
+	}
+	raise_peak(&memory->peak_total, total);
+	raise_peak(&memory->peak[category],
+	           atomic_fetch_add_explicit(&memory->current[category], size,
+	                                     memory_order_relaxed) + size);
+	return true;
+}
+
+void discharge_memory(memory_t *memory, gamma_memory_category_t category,
+                      size_t size) {
+	if(memory != NULL) {
+		atomic_fetch_sub_explicit(&memory->current[category], size,
+		                          memory_order_relaxed);
+		atomic_fetch_sub_explicit(&memory->total, size, memory_order_relaxed);
+	}
+}
+
+bool memory_fits(memory_t *memory, size_t size) {
+	if(memory == NULL || memory->budget == 0) {
+		return true;
+	}
+	uint64_t total = atomic_load_explicit(&memory->total, memory_order_relaxed);
+	return total <= memory->budget && size <= memory->budget - total;
+}
+
+void* allocate_memory(memory_t *memory, gamma_memory_category_t category,
+                      size_t size, bool zeroed) {
+	if(!charge_memory(memory, category, size)) {
+		return NULL;
+	}
+	void *pointer;
+	if(uses_malloc(memory, category)) {
+		pointer = zeroed ? calloc(size, 1) : malloc(size);
+	}
+	else {
+		pointer = (memory->arena != NULL
+		           ? allocate_in_arena(memory, size)
+		           : memory->allocator.allocate(memory->allocator.context, size));
+		if(pointer != NULL && zeroed) {
+			memset(pointer, 0, size);
+		}
+	}
+	if(pointer == NULL) {
+		discharge_memory(memory, category, size);
+	}
+	return pointer;
+}
+
+void* resize_memory(memory_t *memory, gamma_memory_category_t category,
+                    void *pointer, size_t old_size, size_t new_size) {
+	if(new_size > old_size
+	   && !charge_memory(memory, category, new_size - old_size)) {
+		return NULL;
+	}
+	void *resized;
+	if(uses_malloc(memory, category)) {
+		resized = realloc(pointer, new_size);
+	}
+	else if(pointer == NULL) {
+		resized = (memory->arena != NULL
+		           ? allocate_in_arena(memory, new_size)
+		           : memory->allocator.allocate(memory->allocator.context,
+		                                        new_size));
+	}
+	else {
+		resized = (memory->arena != NULL
+		           ? resize_in_arena(memory, pointer, old_size, new_size)
+		           : memory->allocator.resize(memory->allocator.context,
+		                                      pointer, old_size, new_size));
+	}
+	if(resized == NULL && new_size > old_size) {
+		discharge_memory(memory, category, new_size - old_size);
+	}
+	else if(resized != NULL && new_size < old_size) {
+		discharge_memory(memory, category, old_size - new_size);
+	}
+	return resized;
+}
+
+void release_memory(memory_t *memory, gamma_memory_category_t category,
+                    void *pointer, size_t size) {
+	if(pointer != NULL) {
+		if(uses_malloc(memory, category)) {
+			free(pointer);
+		}
+		else if(memory->arena != NULL) {
+			release_in_arena(memory, pointer, size);
+		}
+		else {
+			memory->allocator.release(memory->allocator.context, pointer, size);
+		}
+		discharge_memory(memory, category, size);
+	}
+}
+
+void read_memory(memory_t *memory, gamma_memory_t *usage) {
+	for(int i = 0; i < GAMMA_MEMORY_CATEGORIES; i++) {
+		usage->current[i] = atomic_load_explicit(&memory->current[i],
+		                                         memory_order_relaxed);
+		usage->peak[i] = atomic_load_explicit(&memory->peak[i],
+		                                      memory_order_relaxed);
+	}
+	usage->total = atomic_load_explicit(&memory->total, memory_order_relaxed);
+	usage->peak_total = atomic_load_explicit(&memory->peak_total,
+	                                         memory_order_relaxed);
+	usage->budget = memory->budget;
+}
@@ -0,0 +1,143 @@
+/** @file
+ * Interfejs klasy liczącej pamięć używaną przez grę.
+ * Każda alokacja silnika gry przechodzi przez funkcje tej klasy, które
+ * doliczają jej rozmiar do zużycia odpowiedniego rodzaju pamięci
+ * (@ref gamma_memory_category_t) i odmawiają alokacji przekraczającej limit.
+ * Liczniki są atomowe, bo funkcje czytające stan gry alokują pamięć także
+ * wtedy, gdy wiele wątków korzysta z gry jednocześnie.
+ * Pamięć pochodzi z funkcji malloc, z alokatora podanego przy tworzeniu gry
+ * (@ref gamma_allocator_t) albo z areny, czyli jednego bloku, z którego
+ * kolejne alokacje są odcinane przez przesunięcie wierzchołka. Bufory
+ * przekazywane poza grę (@ref GAMMA_MEMORY_OUTPUT) zawsze pochodzą z funkcji
+ * malloc, bo wywołujący zwalnia je funkcją free.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "gamma.h"
+
+
+/**
+ * Liczniki i źródło pamięci jednej gry.
+ */
+typedef struct memory {
+	_Atomic uint64_t current[GAMMA_MEMORY_CATEGORIES]; ///< bieżące zużycie każdego rodzaju
+	_Atomic uint64_t peak[GAMMA_MEMORY_CATEGORIES]; ///< największe zużycie każdego rodzaju
+	_Atomic uint64_t total; 	///< bieżące zużycie łącznie
+	_Atomic uint64_t peak_total; ///< największe zużycie łącznie
+	uint64_t budget; 			///< limit łącznego zużycia lub 0, jeśli go nie ma
+	gamma_allocator_t allocator; /**< alokator gry, z wyzerowanymi funkcjami,
+ * 								jeśli gra używa funkcji malloc */
+	char *arena; 				/**< pierwszy bajt areny lub NULL, jeśli gra
+ * 								nie używa areny */
+	size_t arena_size; 			///< liczba bajtów areny
+	_Atomic size_t arena_top; 	///< liczba zajętych bajtów na początku areny
+} memory_t;
+
+
+/** @brief Tworzy liczniki i źródło pamięci gry.
+ * Jeśli podano rozmiar areny, liczniki są umieszczane na jej początku,
+ * a arena jest alokowana alokatorem gry lub funkcją malloc.
+ * @param[in] options 	- wskaźnik na parametry gry.
+ * @return Wskaźnik na liczniki lub NULL, jeśli zabrakło pamięci, na przykład
+ * dlatego, że arena jest za mała na liczniki.
+ */
+memory_t* new_memory(const gamma_options_t *options);
+
+/** @brief Usuwa liczniki i źródło pamięci gry.
+ * Zwalnia arenę razem z całą zaalokowaną z niej pamięcią.
+ * @param[in,out] memory 	- wskaźnik na liczniki lub NULL.
+ */
+void delete_memory(memory_t *memory);
+
+/** @brief Sprawdza czy pamięć gry pochodzi z areny.
+ * Wtedy przy usuwaniu gry nie trzeba zwalniać jej struktur pojedynczo.
+ * @param[in] memory 	- wskaźnik na liczniki lub NULL.
+ * @return Wartość @p true, jeśli gra używa areny lub @p false w przeciwnym
+ * wypadku.
+ */
+bool memory_in_arena(memory_t *memory);
+
+/** @brief Dolicza pamięć do zużycia, jeśli mieści się w limicie.
+ * Nie alokuje pamięci. Używana bezpośrednio dla buforów, które zostaną
+ * przekazane poza grę i zwolnione funkcją free.
+ * @param[in,out] memory 	- wskaźnik na liczniki lub NULL,
+ * @param[in] category 		- rodzaj pamięci,
+ * @param[in] size 			- liczba bajtów.
+ * @return Wartość @p true, jeśli pamięć mieści się w limicie lub @p false
+ * w przeciwnym wypadku.
+ */
+bool charge_memory(memory_t *memory, gamma_memory_category_t category,
+                   size_t size);
+
+/** @brief Odlicza pamięć od zużycia.
+ * @param[in,out] memory 	- wskaźnik na liczniki lub NULL,
+ * @param[in] category 		- rodzaj pamięci,
+ * @param[in] size 			- liczba bajtów, wcześniej doliczona przez
+ * 							@ref charge_memory.
+ */
+void discharge_memory(memory_t *memory, gamma_memory_category_t category,
+                      size_t size);
+
+/** @brief Sprawdza czy pamięć zmieści się w limicie.
+ * Wynik jest tylko wskazówką, bo w międzyczasie inny wątek może zająć
+ * pamięć.
+ * @param[in] memory 	- wskaźnik na liczniki lub NULL,
+ * @param[in] size 		- liczba bajtów.
+ * @return Wartość @p true, jeśli pamięć mieści się w limicie lub @p false
+ * w przeciwnym wypadku.
+ */
+bool memory_fits(memory_t *memory, size_t size);
+
+/** @brief Alokuje pamięć i dolicza ją do zużycia.
+ * @param[in,out] memory 	- wskaźnik na liczniki lub NULL, jeśli pamięć nie
+ * 							jest liczona,
+ * @param[in] category 		- rodzaj pamięci,
+ * @param[in] size 			- liczba bajtów,
+ * @param[in] zeroed 		- informacja czy wyzerować pamięć.
+ * @return Wskaźnik na zaalokowaną pamięć lub NULL, jeśli jej zabrakło lub
+ * przekroczyłaby limit.
+ */
+void* allocate_memory(memory_t *memory, gamma_memory_category_t category,
+                      size_t size, bool zeroed);
+
+/** @brief Zmienia rozmiar zaalokowanej pamięci.
+ * @param[in,out] memory 	- wskaźnik na liczniki lub NULL, jeśli pamięć nie
+ * 							jest liczona,
+ * @param[in] category 		- rodzaj pamięci,
+ * @param[in] pointer 		- wskaźnik na pamięć z @ref allocate_memory lub
+ * 							NULL,
+ * @param[in] old_size 		- dotychczasowy rozmiar pamięci,
+ * @param[in] new_size 		- nowy rozmiar pamięci.
+ * @return Wskaźnik na pamięć o nowym rozmiarze lub NULL, jeśli jej zabrakło
+ * lub przekroczyłaby limit. Wtedy dotychczasowa pamięć pozostaje bez zmian.
+ */
+void* resize_memory(memory_t *memory, gamma_memory_category_t category,
+                    void *pointer, size_t old_size, size_t new_size);
+
+/** @brief Zwalnia pamięć i odlicza ją od zużycia.
+ * @param[in,out] memory 	- wskaźnik na liczniki lub NULL, jeśli pamięć nie
+ * 							jest liczona,
+ * @param[in] category 		- rodzaj pamięci,
+ * @param[in] pointer 		- wskaźnik na pamięć z @ref allocate_memory lub
+ * 							NULL,
+ * @param[in] size 			- rozmiar pamięci.
+ */
+void release_memory(memory_t *memory, gamma_memory_category_t category,
+                    void *pointer, size_t size);
+
+/** @brief Odczytuje zużycie pamięci.
+ * @param[in] memory 	- wskaźnik na liczniki,
+ * @param[out] usage 	- wskaźnik na strukturę, do której zostaje zapisane
+ * 						zużycie.
+ */
+void read_memory(memory_t *memory, gamma_memory_t *usage);
+
+#endif /* MEMORY_H */
@@ -0,0 +1,248 @@
+/** @file
+ * Implementacja klasy zapisującej i odtwarzającej dziennik ruchów.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "move_log.h"
+#include "input.h"
+#include "output.h"
+
+
+#define LOG_BUFFER_SIZE (1 << 16) ///< rozmiar bufora zapisywanego dziennika
+
+#define LOG_MAGIC "GAMMALOG" ///< napis rozpoczynający dziennik
+
+#define LOG_MAGIC_LENGTH 8 ///< długość napisu rozpoczynającego dziennik
+
+#define CHECKSUM_INTERVAL 1024 ///< liczba ruchów pomiędzy sumami kontrolnymi
+
+#define FNV_OFFSET 0xCBF29CE484222325ULL ///< początkowa wartość skrótu FNV-1a
+
+#define FNV_PRIME 0x100000001B3ULL ///< mnożnik skrótu FNV-1a
+
+
+/**
+ * Stan zapisywanego dziennika.
+ */
+typedef struct move_log {
+	int fd; 				///< deskryptor pliku dziennika lub -1
+	uint32_t last_x; 		///< współrzędna x poprzedniego ruchu
+	uint32_t last_y; 		///< współrzędna y poprzedniego ruchu
+	uint64_t moves; 		///< liczba ruchów od ostatniej sumy kontrolnej
+	size_t length; 			///< liczba zajętych bajtów bufora
+	char data[LOG_BUFFER_SIZE]; ///< bufor z danymi do zapisania
+} move_log_t;
+
+
+static move_log_t recording = {-1, 0, 0, 0, 0, {0}}; ///< zapisywany dziennik
+
+
+static void write_log(void);
+
+static void append_varint(uint64_t value);
+
+static void append_checksum(gamma_t *g);
+
+static bool busy_fields_checksum(gamma_t *g, uint64_t *checksum);
+
+static uint64_t zigzag(uint32_t current, uint32_t previous);
+
+
+/** @brief Zapisuje zawartość bufora do pliku dziennika.
+ * Jeśli zapis się nie powiedzie, dziennik przestaje być zapisywany.
+ */
+void write_log(void) {
+	if(recording.fd >= 0
+	   && !write_all(recording.fd, recording.data, recording.length)) {
+		close(recording.fd);
+		recording.fd = -1;
+	}
+	recording.length = 0;
+}
+
+/** @brief Dopisuje liczbę do bufora w kodowaniu varint.
+ * @param[in] value 	- zapisywana liczba.
+ */
+void append_varint(uint64_t value) {
+	if(recording.length + VARINT_LIMIT > LOG_BUFFER_SIZE) {
+		write_log();
+	}
+	recording.length += format_varint(recording.data + recording.length, value);
+}
+
+/** @brief Dopisuje do bufora rekord z sumą kontrolną.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry.
+ */
+void append_checksum(gamma_t *g) {
+	uint64_t checksum;
+	recording.moves = 0;
+	if(!busy_fields_checksum(g, &checksum)) {
+		return;
+	}
+	if(recording.length + 1 > LOG_BUFFER_SIZE) {
+		write_log();
+	}
+	recording.data[recording.length++] = 'c';
+	append_varint(checksum);
+}
+
+/** @brief Liczy sumę kontrolną liczb pól zajętych przez graczy.
+ * Uwzględnia tylko graczy, którzy wykonali ruch, więc czas nie zależy od
+ * liczby graczy podanej przy tworzeniu gry.
+ * @param[in] g 			- wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] checksum 	- wskaźnik, pod który zostaje zapisany skrót FNV-1a
+ * 							par (numer gracza, liczba jego pól) dla kolejnych
+ * 							graczy, którzy wykonali ruch.
+ * @return Wartość @p true, jeśli udało się policzyć sumę lub @p false, jeśli
+ * zabrakło pamięci.
+ */
+bool busy_fields_checksum(gamma_t *g, uint64_t *checksum) {
+	uint32_t count;
+	uint32_t *players = gamma_active_players(g, &count);
+	if(players == NULL) {
+		return false;
+	}
+	uint64_t hash = FNV_OFFSET;
+	for(uint32_t i = 0; i < count; i++) {
+		hash = (hash ^ players[i]) * FNV_PRIME;
+		hash = (hash ^ gamma_busy_fields(g, players[i])) * FNV_PRIME;
+	}
+	free(players);
+	*checksum = hash;
+	return true;
+}
+
+/** @brief Koduje różnicę współrzędnych w kodowaniu zigzag.
+ * Małe co do wartości bezwzględnej różnice, także ujemne, dają małe liczby.
+ * @param[in] current 	- bieżąca współrzędna,
+ * @param[in] previous 	- poprzednia współrzędna.
+ * @return Zakodowana różnica.
+ */
+uint64_t zigzag(uint32_t current, uint32_t previous) {
+	int64_t delta = (int64_t)current - (int64_t)previous;
+	return ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+}
+
+
+bool open_move_log(const char *path, uint32_t width, uint32_t height,
+                   uint32_t players, uint32_t areas) {
+	recording.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(recording.fd < 0) {
+		return false;
+	}
+	recording.last_x = recording.last_y = 0;
+	recording.moves = 0;
+	memcpy(recording.data, LOG_MAGIC, LOG_MAGIC_LENGTH);
+	recording.length = LOG_MAGIC_LENGTH;
+	append_varint(width);
+	append_varint(height);
+	append_varint(players);
+	append_varint(areas);
+	return true;
+}
+
+void record_move(gamma_t *g, char opcode, uint32_t player, uint32_t x,
+                 uint32_t y) {
+	if(recording.fd < 0 || (opcode != 'm' && opcode != 'g')) {
+		return;
+	}
+	if(recording.length + 1 > LOG_BUFFER_SIZE) {
+		write_log();
+	}
+	recording.data[recording.length++] = opcode;
+	append_varint(player);
+	append_varint(zigzag(x, recording.last_x));
+	append_varint(zigzag(y, recording.last_y));
+	recording.last_x = x;
+	recording.last_y = y;
+	if(++recording.moves == CHECKSUM_INTERVAL) {
+		append_checksum(g);
+	}
+}
+
+size_t moves_before_checksum(void) {
+	if(recording.fd < 0) {
+		return SIZE_MAX;
+	}
+	return (size_t)(CHECKSUM_INTERVAL - recording.moves);
+}
+
+void close_move_log(gamma_t *g) {
+	if(recording.fd < 0) {
+		return;
+	}
+	if(g != NULL) {
+		append_checksum(g);
+	}
+	write_log();
+	if(recording.fd >= 0) {
+		close(recording.fd);
+		recording.fd = -1;
+	}
+}
+
+int replay_mode(const char *path) {
+	int fd = open(path, O_RDONLY);
+	input_t input;
+	if(fd < 0) {
+		print_error(0);
+		flush_output();
+		return 1;
+	}
+	if(!init_input(&input, fd)) {
+		close(fd);
+		return 1;
+	}
+	bool correct = true;
+	for(int i = 0; i < LOG_MAGIC_LENGTH && correct; i++) {
+		correct = (next_char(&input) == LOG_MAGIC[i]);
+	}
+	uint32_t width = 0, height = 0, players = 0, areas = 0;
+	correct = correct && next_uint32(&input, &width)
+	          && next_uint32(&input, &height) && next_uint32(&input, &players)
+	          && next_uint32(&input, &areas);
+	gamma_t *g = correct ? gamma_new(width, height, players, areas) : NULL;
+	uint64_t records = 0, moves = 0;
+	uint32_t x = 0, y = 0;
+	int opcode;
+	correct = (g != NULL);
+	while(correct && (opcode = next_char(&input)) != EOF) {
+		records++;
+		uint64_t value, checksum, delta_x, delta_y;
+		uint32_t player;
+		if(opcode == 'c') {
+			correct = next_varint(&input, &value)
+			          && busy_fields_checksum(g, &checksum) && value == checksum;
+		}
+		else if(opcode == 'm' || opcode == 'g') {
+			correct = next_uint32(&input, &player)
+			          && next_varint(&input, &delta_x)
+			          && next_varint(&input, &delta_y);
+			x += (uint32_t)((delta_x >> 1) ^ (~(delta_x & 1) + 1));
+			y += (uint32_t)((delta_y >> 1) ^ (~(delta_y & 1) + 1));
+			correct = correct && (opcode == 'm' ? gamma_move(g, player, x, y)
+			                                    : gamma_golden_move(g, player, x, y));
+			moves++;
+		}
+		else {
+			correct = false;
+		}
+	}
+	if(correct) {
+		print_number(moves);
+	}
+	else {
+		print_error(records > INT32_MAX ? INT32_MAX : (int)records);
+	}
+	flush_output();
+	gamma_delete(g);
+	close_input(&input);
+	close(fd);
+	return !correct;
+}
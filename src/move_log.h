@@ -0,0 +1,81 @@
+/** @file
+ * Interfejs klasy zapisującej i odtwarzającej dziennik ruchów.
+ * Dziennik jest plikiem binarnym, do którego trafiają wszystkie ruchy
+ * przyjęte przez silnik gry. Zaczyna się nagłówkiem:
+ * 8 bajtów "GAMMALOG", a po nich liczby width, height, players, areas.
+ * Dalej następują rekordy, każdy zaczyna się jednobajtowym kodem:
+ * m lub g  – ruch (@ref gamma_move lub @ref gamma_golden_move), po kodzie
+ *            numer gracza oraz różnice współrzędnych x i y względem
+ *            poprzedniego ruchu (na początku względem pola (0, 0)),
+ * c        – suma kontrolna numerów i liczby pól zajętych przez graczy,
+ *            którzy wykonali ruch (@ref gamma_active_players,
+ *            @ref gamma_busy_fields), zapisywana co pewną liczbę ruchów
+ *            i na końcu dziennika.
+ * Liczby są zapisywane w kodowaniu varint (po 7 bitów na bajt, od najmniej
+ * znaczących), a różnice współrzędnych dodatkowo w kodowaniu zigzag.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef MOVE_LOG_H
+#define MOVE_LOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma.h"
+
+
+/** @brief Rozpoczyna zapisywanie dziennika ruchów.
+ * Tworzy plik dziennika (lub nadpisuje istniejący) i zapisuje nagłówek.
+ * @param[in] path 		- ścieżka pliku dziennika,
+ * @param[in] width 	- szerokość planszy,
+ * @param[in] height 	- wysokość planszy,
+ * @param[in] players 	- liczba graczy,
+ * @param[in] areas 	- maksymalna liczba obszarów jednego gracza.
+ * @return Wartość @p true, jeśli udało się utworzyć plik lub @p false
+ * w przeciwnym wypadku.
+ */
+bool open_move_log(const char *path, uint32_t width, uint32_t height,
+                   uint32_t players, uint32_t areas);
+
+/** @brief Zapisuje przyjęty ruch w dzienniku.
+ * Nie robi nic, jeśli dziennik nie jest zapisywany lub kod polecenia nie
+ * oznacza ruchu.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry po ruchu,
+ * @param[in] opcode 	- kod polecenia, m lub g,
+ * @param[in] player 	- numer gracza,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola.
+ */
+void record_move(gamma_t *g, char opcode, uint32_t player, uint32_t x,
+                 uint32_t y);
+
+/** @brief Podaje, ile ruchów można zapisać przed kolejną sumą kontrolną.
+ * Suma kontrolna opisuje stan gry tuż po ostatnim ruchu przed nią, więc
+ * seria ruchów wykonywana naraz (@ref gamma_move_batch) nie może być od
+ * niej dłuższa.
+ * @return Liczba ruchów, po której zapisaniu zostanie zapisana suma
+ * kontrolna, lub SIZE_MAX, jeśli dziennik nie jest zapisywany.
+ */
+size_t moves_before_checksum(void);
+
+/** @brief Kończy zapisywanie dziennika ruchów.
+ * Zapisuje końcową sumę kontrolną i zamyka plik. Nie robi nic, jeśli dziennik
+ * nie jest zapisywany.
+ * @param[in] g 		- wskaźnik na strukturę przechowującą stan gry.
+ */
+void close_move_log(gamma_t *g);
+
+/** @brief Odtwarza dziennik ruchów.
+ * Tworzy grę o parametrach z nagłówka i wykonuje zapisane ruchy, sprawdzając
+ * sumy kontrolne. Na koniec wypisuje liczbę wykonanych ruchów. Jeśli dziennik
+ * jest uszkodzony, ruch zostanie odrzucony lub suma kontrolna się nie zgadza,
+ * wypisuje komunikat "ERROR n", gdzie n to numer rekordu (nagłówek ma
+ * numer 0).
+ * @param[in] path 		- ścieżka pliku dziennika.
+ * @return Wartość 0, jeśli odtworzono cały dziennik lub 1 w przeciwnym
+ * wypadku.
+ */
+int replay_mode(const char *path);
+
+#endif /* MOVE_LOG_H */
@@ -0,0 +1,423 @@
+/** @file
+ * Implementacja trybu wielu gier (multi-game mode).
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< udostępnia funkcję sysconf
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "multi_game.h"
+#include "gamma.h"
+#include "batch_mode.h"
+#include "ring_buffer.h"
+#include "output.h"
+#include "image.h"
+
+
+#define MAX_WORKERS 256 ///< maksymalna liczba wątków roboczych
+
+#define WORKER_QUEUE_CAPACITY 4096 ///< pojemność bufora poleceń jednego wątku
+
+#define ANSWERS_BUFFER_SIZE (1 << 16) ///< rozmiar bufora odpowiedzi jednego wątku
+
+#define BASIC_TABLE_CAPACITY 16 ///< bazowa pojemność tablicy gier, potęga dwójki
+
+
+/**
+ * Polecenie przekazywane z wątku czytającego do wątku roboczego.
+ */
+typedef struct job {
+	command_t command; 	///< polecenie do wykonania
+	bool last; 			///< informacja czy to znacznik końca wejścia
+} job_t;
+
+/**
+ * Element tablicy gier.
+ */
+typedef struct game_entry {
+	uint32_t id; 		///< numer gry
+	gamma_t *g; 		///< wskaźnik na grę lub NULL, jeśli element jest pusty
+} game_entry_t;
+
+/**
+ * Tablica haszująca gier obsługiwanych przez jeden wątek, z adresowaniem
+ * otwartym i liniowym szukaniem wolnego miejsca.
+ */
+typedef struct game_table {
+	game_entry_t *entries; 	///< tablica elementów
+	size_t capacity; 		///< pojemność tablicy, potęga dwójki
+	size_t size; 			///< liczba gier w tablicy
+} game_table_t;
+
+/**
+ * Stan jednego wątku roboczego.
+ */
+typedef struct worker {
+	pthread_t thread; 		///< wątek roboczy
+	ring_buffer_t jobs; 	///< bufor poleceń dla tego wątku
+	game_table_t games; 	///< gry obsługiwane przez ten wątek
+	char answers[ANSWERS_BUFFER_SIZE]; ///< odpowiedzi czekające na wypisanie
+	size_t answers_length; 	///< liczba zajętych bajtów bufora odpowiedzi
+} worker_t;
+
+/**
+ * Linijka z numerem gry poprzedzająca eksportowany obraz. Jest wypisywana
+ * razem z pierwszym fragmentem obrazu, więc nie pojawia się, jeśli eksport
+ * się nie powiedzie.
+ */
+typedef struct image_header {
+	char id[UINT64_LIMIT + 1]; 	///< numer gry zakończony znakiem nowej linii
+	size_t length; 				///< długość linijki lub 0, jeśli już wypisana
+} image_header_t;
+
+
+static pthread_mutex_t output_lock = PTHREAD_MUTEX_INITIALIZER; /**< Blokada
+ * chroniąca bufory wyjścia, do których piszą wszystkie wątki.
+ */
+
+
+static size_t slot_of(const game_table_t *table, uint32_t id);
+
+static gamma_t* find_game(const game_table_t *table, uint32_t id);
+
+static bool insert_game(game_table_t *table, uint32_t id, gamma_t *g);
+
+static bool remove_game(game_table_t *table, uint32_t id);
+
+static void clear_games(game_table_t *table);
+
+static void publish_answers(worker_t *worker, bool flush);
+
+static void add_answer(worker_t *worker, uint32_t id, uint64_t value);
+
+static void print_image_part(void *context, const char *data, size_t length);
+
+static void execute_job(worker_t *worker, command_t command);
+
+static void* worker_thread(void *arg);
+
+static void flush_shared_output(void);
+
+
+/** @brief Wyznacza pierwsze miejsce w tablicy, w którym może być gra.
+ * @param[in] table 	- wskaźnik na tablicę gier,
+ * @param[in] id 		- numer gry.
+ * @return Indeks elementu tablicy.
+ */
+size_t slot_of(const game_table_t *table, uint32_t id) {
+	return ((uint64_t)id * 0x9E3779B97F4A7C15ULL >> 32) & (table->capacity - 1);
+}
+
+/** @brief Szuka gry w tablicy.
+ * @param[in] table 	- wskaźnik na tablicę gier,
+ * @param[in] id 		- numer szukanej gry.
+ * @return Wskaźnik na grę lub NULL, jeśli nie ma gry o takim numerze.
+ */
+gamma_t* find_game(const game_table_t *table, uint32_t id) {
+	if(table->capacity == 0) {
+		return NULL;
+	}
+	for(size_t i = slot_of(table, id); table->entries[i].g != NULL;
+	    i = (i + 1) & (table->capacity - 1)) {
+		if(table->entries[i].id == id) {
+			return table->entries[i].g;
+		}
+	}
+	return NULL;
+}
+
+/** @brief Dodaje grę do tablicy.
+ * Jeśli tablica jest zapełniona w połowie, dwukrotnie ją powiększa.
+ * @param[in,out] table - wskaźnik na tablicę gier,
+ * @param[in] id 		- numer gry, której nie ma jeszcze w tablicy,
+ * @param[in] g 		- wskaźnik na dodawaną grę.
+ * @return Wartość @p true, jeśli dodano grę lub @p false, jeśli zabrakło pamięci.
+ */
+bool insert_game(game_table_t *table, uint32_t id, gamma_t *g) {
+	if(2 * (table->size + 1) > table->capacity) {
+		game_table_t bigger;
+		bigger.capacity = table->capacity ? 2 * table->capacity
+		                                  : BASIC_TABLE_CAPACITY;
+		bigger.size = 0;
+		bigger.entries = calloc(bigger.capacity, sizeof(game_entry_t));
+		if(!bigger.entries) {
+			errno = 0;
+			return false;
+		}
+		for(size_t i = 0; i < table->capacity; i++) {
+			if(table->entries[i].g != NULL) {
+				insert_game(&bigger, table->entries[i].id, table->entries[i].g);
+			}
+		}
+		free(table->entries);
+		*table = bigger;
+	}
+	size_t i = slot_of(table, id);
+	while(table->entries[i].g != NULL) {
+		i = (i + 1) & (table->capacity - 1);
+	}
+	table->entries[i].id = id;
+	table->entries[i].g = g;
+	table->size++;
+	return true;
+}
+
+/** @brief Usuwa grę z tablicy i zwalnia jej pamięć.
+ * Elementy występujące za usuniętym są przesuwane tak, aby ciągi elementów
+ * nie miały przerw.
+ * @param[in,out] table - wskaźnik na tablicę gier,
+ * @param[in] id 		- numer usuwanej gry.
+ * @return Wartość @p true, jeśli usunięto grę lub @p false, jeśli nie było
+ * gry o takim numerze.
+ */
+bool remove_game(game_table_t *table, uint32_t id) {
+	if(table->capacity == 0) {
+		return false;
+	}
+	size_t mask = table->capacity - 1;
+	size_t i = slot_of(table, id);
+	while(table->entries[i].g != NULL && table->entries[i].id != id) {
+		i = (i + 1) & mask;
+	}
+	if(table->entries[i].g == NULL) {
+		return false;
+	}
+	gamma_delete(table->entries[i].g);
+	table->entries[i].g = NULL;
+	table->size--;
+	for(size_t j = (i + 1) & mask; table->entries[j].g != NULL; j = (j + 1) & mask) {
+		size_t home = slot_of(table, table->entries[j].id);
+		if(((j - home) & mask) >= ((j - i) & mask)) {
+			table->entries[i] = table->entries[j];
+			table->entries[j].g = NULL;
+			i = j;
+		}
+	}
+	return true;
+}
+
+/** @brief Usuwa wszystkie gry z tablicy i zwalnia jej pamięć.
+ * @param[in,out] table - wskaźnik na tablicę gier.
+ */
+void clear_games(game_table_t *table) {
+	for(size_t i = 0; i < table->capacity; i++) {
+		gamma_delete(table->entries[i].g);
+	}
+	free(table->entries);
+	table->entries = NULL;
+	table->capacity = table->size = 0;
+}
+
+/** @brief Przekazuje zebrane odpowiedzi wątku do wspólnego wyjścia.
+ * Bufor wątku zawiera wyłącznie całe linijki, więc odpowiedzi różnych wątków
+ * nie mieszają się ze sobą.
+ * @param[in,out] worker 	- wskaźnik na stan wątku,
+ * @param[in] flush 		- informacja czy należy też opróżnić bufory wyjścia.
+ */
+void publish_answers(worker_t *worker, bool flush) {
+	if(worker->answers_length == 0 && !flush) {
+		return;
+	}
+	pthread_mutex_lock(&output_lock);
+	print_text(worker->answers, worker->answers_length);
+	if(flush) {
+		flush_output();
+	}
+	pthread_mutex_unlock(&output_lock);
+	worker->answers_length = 0;
+}
+
+/** @brief Wypisuje fragment obrazu, poprzedzając pierwszy z nich numerem gry.
+ * Wywoływana z zamkniętym zamkiem output_lock.
+ * @param[in,out] context 	- wskaźnik na linijkę z numerem gry
+ * 							(@ref image_header_t),
+ * @param[in] data 			- wskaźnik na fragment obrazu,
+ * @param[in] length 		- długość fragmentu.
+ */
+void print_image_part(void *context, const char *data, size_t length) {
+	image_header_t *header = context;
+	if(header->length > 0) {
+		print_text(header->id, header->length);
+		header->length = 0;
+	}
+	print_text(data, length);
+}
+
+/** @brief Dopisuje odpowiedź do bufora wątku.
+ * Odpowiedź ma postać "id value".
+ * @param[in,out] worker 	- wskaźnik na stan wątku,
+ * @param[in] id 			- numer gry,
+ * @param[in] value 		- odpowiedź.
+ */
+void add_answer(worker_t *worker, uint32_t id, uint64_t value) {
+	if(worker->answers_length + 2 * UINT64_LIMIT + 2 > ANSWERS_BUFFER_SIZE) {
+		publish_answers(worker, false);
+	}
+	char *position = worker->answers + worker->answers_length;
+	position += format_number(position, id);
+	*(position++) = ' ';
+	position += format_number(position, value);
+	*(position++) = '\n';
+	worker->answers_length = (size_t)(position - worker->answers);
+}
+
+/** @brief Wykonuje jedno polecenie trybu wielu gier.
+ * @param[in,out] worker 	- wskaźnik na stan wątku,
+ * @param[in] command 		- polecenie, pierwszym argumentem jest numer gry.
+ */
+void execute_job(worker_t *worker, command_t command) {
+	uint32_t id = command.args[0];
+	uint32_t *args = &command.args[1];
+	gamma_t *g = find_game(&worker->games, id);
+	uint64_t value = 0;
+	if(command.name == 'n') {
+		if(g == NULL) {
+			g = gamma_new(args[0], args[1], args[2], args[3]);
+			if(g != NULL && !insert_game(&worker->games, id, g)) {
+				gamma_delete(g);
+				g = NULL;
+			}
+			value = (g != NULL);
+		}
+	}
+	else if(command.name == 'd') {
+		value = remove_game(&worker->games, id);
+	}
+	else if(command.name == 'e') {
+		if(g != NULL) {
+			image_header_t header;
+			header.length = format_number(header.id, id);
+			header.id[header.length++] = '\n';
+			pthread_mutex_lock(&output_lock);
+			print_text(worker->answers, worker->answers_length);
+			worker->answers_length = 0;
+			bool exported = export_image(g, args[0], args[1], print_image_part,
+			                             &header);
+			pthread_mutex_unlock(&output_lock);
+			if(exported) {
+				return;
+			}
+		}
+	}
+	else if(command.name == 'p' || command.name == 'r') {
+		size_t board_length;
+		char *board = call_board_function(command.name, g, &board_length);
+		if(board != NULL) {
+			char header[UINT64_LIMIT + 1];
+			size_t length = format_number(header, id);
+			header[length++] = '\n';
+			pthread_mutex_lock(&output_lock);
+			print_text(worker->answers, worker->answers_length);
+			print_text(header, length);
+			print_text(board, board_length);
+			pthread_mutex_unlock(&output_lock);
+			worker->answers_length = 0;
+			free(board);
+			return;
+		}
+	}
+	else {
+		memmove(command.args, args, (MAX_COMMAND_ARGS - 1) * sizeof(uint32_t));
+		command.args_length--;
+		value = call_function(command, g);
+	}
+	add_answer(worker, id, value);
+}
+
+/** @brief Wykonuje polecenia przekazane do wątku.
+ * Zanim wątek zacznie czekać na kolejne polecenia, przekazuje zebrane
+ * odpowiedzi na wyjście.
+ * @param[in,out] arg 	- wskaźnik na stan wątku (@ref worker_t).
+ * @return Wartość NULL.
+ */
+void* worker_thread(void *arg) {
+	worker_t *worker = arg;
+	job_t job;
+	for(;;) {
+		if(!ring_buffer_try_pop(&worker->jobs, &job)) {
+			publish_answers(worker, true);
+			ring_buffer_pop(&worker->jobs, &job);
+		}
+		if(job.last) {
+			break;
+		}
+		execute_job(worker, job.command);
+	}
+	publish_answers(worker, true);
+	clear_games(&worker->games);
+	return NULL;
+}
+
+/** @brief Opróżnia bufory wyjścia, do których piszą też wątki robocze.
+ * Wywoływana przed czytaniem z wejścia, które może się zablokować.
+ */
+void flush_shared_output(void) {
+	pthread_mutex_lock(&output_lock);
+	flush_output();
+	pthread_mutex_unlock(&output_lock);
+}
+
+
+int multi_game_mode(input_t *input, int counter, uint32_t workers) {
+	if(workers == 0) {
+		long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		workers = processors > 0 ? (uint32_t)processors : 1;
+	}
+	if(workers > MAX_WORKERS) {
+		workers = MAX_WORKERS;
+	}
+	worker_t *pool = aligned_alloc(_Alignof(worker_t), workers * sizeof(worker_t));
+	if(!pool) {
+		return 1;
+	}
+	memset(pool, 0, workers * sizeof(worker_t));
+	uint32_t started = 0;
+	while(started < workers) {
+		worker_t *worker = &pool[started];
+		if(!init_ring_buffer(&worker->jobs, WORKER_QUEUE_CAPACITY, sizeof(job_t))) {
+			break;
+		}
+		if(pthread_create(&worker->thread, NULL, worker_thread, worker) != 0) {
+			delete_ring_buffer(&worker->jobs);
+			break;
+		}
+		started++;
+	}
+
+	reading_mode = MULTI_GAME_READING;
+	input->before_read = flush_shared_output;
+	bool eof = (started == 0);
+	job_t job;
+	memset(&job, 0, sizeof(job));
+	while(!eof && errno != ENOMEM) {
+		line_type_t type = read_command(input, &job.command, &eof);
+		counter++;
+		if(type == INVALID_LINE) {
+			pthread_mutex_lock(&output_lock);
+			print_error(counter);
+			pthread_mutex_unlock(&output_lock);
+		}
+		else if(type == COMMAND_LINE) {
+			ring_buffer_push(&pool[job.command.args[0] % started].jobs, &job);
+		}
+	}
+	bool memory_error = (started == 0 || errno == ENOMEM);
+
+	job.last = true;
+	for(uint32_t i = 0; i < started; i++) {
+		ring_buffer_push(&pool[i].jobs, &job);
+	}
+	for(uint32_t i = 0; i < started; i++) {
+		pthread_join(pool[i].thread, NULL);
+		delete_ring_buffer(&pool[i].jobs);
+	}
+	input->before_read = flush_output;
+	flush_output();
+	free(pool);
+	return memory_error;
+}
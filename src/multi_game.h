@@ -0,0 +1,37 @@
+/** @file
+ * Interfejs trybu wielu gier (multi-game mode).
+ * W tym trybie jeden proces obsługuje wiele gier naraz. Pierwszym argumentem
+ * każdego polecenia jest numer gry, a dodatkowe polecenia pozwalają tworzyć
+ * i usuwać gry:
+ * n id width height players areas – tworzy grę o numerze id,
+ * d id                            – usuwa grę o numerze id,
+ * m id player x y, g id player x y, b id player, f id player, q id player,
+ * p id                            – jak w trybie wsadowym.
+ * Gry są rozdzielane pomiędzy wątki robocze według numeru gry, więc polecenia
+ * dotyczące jednej gry są wykonywane w kolejności, w jakiej pojawiły się na
+ * wejściu. Każda odpowiedź jest poprzedzona numerem gry.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef MULTI_GAME_H
+#define MULTI_GAME_H
+
+#include <stdint.h>
+#include "input.h"
+
+
+/** @brief Obsługuje tryb wielu gier.
+ * Uruchamia wątki robocze, a sam czyta polecenia i przekazuje je do wątku
+ * obsługującego daną grę. Kończy działanie po przeczytaniu całego wejścia,
+ * wykonaniu wszystkich poleceń i usunięciu wszystkich gier.
+ * @param[in,out] input 	- wskaźnik na strukturę buforowanego wejścia,
+ * @param[in] counter 		- liczba przeczytanych dotąd linijek z wejścia,
+ * @param[in] workers 		- liczba wątków roboczych, wartość 0 oznacza
+ * 							liczbę dostępnych procesorów.
+ * @return Wartość 0, jeśli tryb zakończył się prawidłowo lub 1, jeśli wystąpiły
+ * błędy np. brak pamięci.
+ */
+int multi_game_mode(input_t *input, int counter, uint32_t workers);
+
+#endif /* MULTI_GAME_H */
@@ -0,0 +1,181 @@
+/** @file
+ * Implementacja klasy buforującej dane wyjściowe trybu wsadowego.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< udostępnia typ ssize_t
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "output.h"
+
+
+#define OUTPUT_BUFFER_SIZE (1 << 16) ///< rozmiar bufora jednego strumienia
+
+
+/**
+ * Bufor jednego strumienia wyjściowego.
+ */
+typedef struct output_buffer {
+	int fd; 						///< deskryptor, na który wypisujemy bufor
+	size_t length; 					///< liczba zajętych bajtów bufora
+	char data[OUTPUT_BUFFER_SIZE]; 	///< zawartość bufora
+} output_buffer_t;
+
+
+static output_buffer_t standard_output = {STDOUT_FILENO, 0, {0}}; ///< bufor stdout
+
+static output_buffer_t error_output = {STDERR_FILENO, 0, {0}}; ///< bufor stderr
+
+static output_buffer_t *error_target = &error_output; /**< Bufor, do którego
+ * trafiają komunikaty o błędach. Wskazuje na bufor standardowego wyjścia, gdy
+ * oba strumienie prowadzą do tego samego pliku.
+ */
+
+static bool flush_mode = false; ///< czy opróżniamy bufory po każdym poleceniu
+
+
+static void flush_buffer(output_buffer_t *buffer);
+
+static void append(output_buffer_t *buffer, const char *data, size_t length);
+
+static void append_line_with_number(output_buffer_t *buffer, const char *prefix,
+                                    size_t prefix_length, uint64_t number);
+
+
+/** @brief Opróżnia jeden bufor.
+ * @param[in,out] buffer 	- wskaźnik na opróżniany bufor.
+ */
+void flush_buffer(output_buffer_t *buffer) {
+	write_all(buffer->fd, buffer->data, buffer->length);
+	buffer->length = 0;
+}
+
+/** @brief Dopisuje dane na koniec bufora.
+ * Jeśli dane nie mieszczą się w buforze, bufor jest najpierw opróżniany,
+ * a dane większe od całego bufora są wypisywane bezpośrednio.
+ * @param[in,out] buffer 	- wskaźnik na bufor,
+ * @param[in] data 			- wskaźnik na dopisywane dane,
+ * @param[in] length 		- liczba bajtów do dopisania.
+ */
+void append(output_buffer_t *buffer, const char *data, size_t length) {
+	if(buffer->length + length > OUTPUT_BUFFER_SIZE) {
+		flush_buffer(buffer);
+		if(length > OUTPUT_BUFFER_SIZE) {
+			write_all(buffer->fd, data, length);
+			return;
+		}
+	}
+	memcpy(buffer->data + buffer->length, data, length);
+	buffer->length += length;
+}
+
+/** @brief Dopisuje do bufora linijkę z przedrostkiem i liczbą.
+ * @param[in,out] buffer 	- wskaźnik na bufor,
+ * @param[in] prefix 		- napis poprzedzający liczbę,
+ * @param[in] prefix_length - długość napisu poprzedzającego liczbę,
+ * @param[in] number 		- wypisywana liczba.
+ */
+void append_line_with_number(output_buffer_t *buffer, const char *prefix,
+                             size_t prefix_length, uint64_t number) {
+	if(buffer->length + prefix_length + UINT64_LIMIT + 1 > OUTPUT_BUFFER_SIZE) {
+		flush_buffer(buffer);
+	}
+	char *position = buffer->data + buffer->length;
+	memcpy(position, prefix, prefix_length);
+	position += prefix_length;
+	position += format_number(position, number);
+	*(position++) = '\n';
+	buffer->length = (size_t)(position - buffer->data);
+}
+
+
+size_t format_number(char *destination, uint64_t number) {
+	char digits[UINT64_LIMIT];
+	size_t num_of_digits = 0;
+	do {
+		digits[num_of_digits++] = (char)('0' + number % 10);
+		number /= 10;
+	} while(number != 0);
+	for(size_t i = 0; i < num_of_digits; i++) {
+		destination[i] = digits[num_of_digits - 1 - i];
+	}
+	return num_of_digits;
+}
+
+size_t format_varint(char *destination, uint64_t number) {
+	size_t length = 0;
+	while(number >= 0x80) {
+		destination[length++] = (char)(number | 0x80);
+		number >>= 7;
+	}
+	destination[length++] = (char)number;
+	return length;
+}
+
+bool write_all(int fd, const char *data, size_t length) {
+	while(length > 0) {
+		ssize_t written = write(fd, data, length);
+		if(written < 0) {
+			if(errno == EINTR) {
+				continue;
+			}
+			errno = 0;
+			return false;
+		}
+		data += written;
+		length -= (size_t)written;
+	}
+	return true;
+}
+
+void init_output(bool flush_every_command) {
+	struct stat out, err;
+	flush_mode = flush_every_command;
+	if(fstat(STDOUT_FILENO, &out) == 0 && fstat(STDERR_FILENO, &err) == 0
+	   && out.st_dev == err.st_dev && out.st_ino == err.st_ino) {
+		error_target = &standard_output;
+	}
+	else {
+		error_target = &error_output;
+	}
+}
+
+void print_number(uint64_t number) {
+	append_line_with_number(&standard_output, "", 0, number);
+}
+
+void print_error(int line) {
+	append_line_with_number(error_target, "ERROR ", 6, (uint64_t)line);
+}
+
+void print_rejected(int line) {
+	append_line_with_number(&standard_output, "REJECTED ", 9, (uint64_t)line);
+}
+
+void print_ok(int line) {
+	append_line_with_number(&standard_output, "OK ", 3, (uint64_t)line);
+}
+
+void print_text(const char *text, size_t length) {
+	append(&standard_output, text, length);
+}
+
+void print_data(void *context, const char *data, size_t length) {
+	(void)context;
+	append(&standard_output, data, length);
+}
+
+void end_of_command(void) {
+	if(flush_mode) {
+		flush_output();
+	}
+}
+
+void flush_output(void) {
+	flush_buffer(&error_output);
+	flush_buffer(&standard_output);
+}
@@ -0,0 +1,114 @@
+/** @file
+ * Interfejs klasy buforującej dane wyjściowe trybu wsadowego.
+ * Odpowiedzi i komunikaty o błędach są formatowane ręcznie do dużego bufora
+ * i wypisywane możliwie małą liczbą wywołań funkcji write. Jeśli standardowe
+ * wyjście i standardowe wyjście błędów wskazują na ten sam plik, oba
+ * strumienie trafiają do wspólnego bufora, dzięki czemu zachowana zostaje
+ * kolejność linijek.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+#define UINT64_LIMIT 20 ///< Limit długości uint64_t to 20 cyfr
+
+#define VARINT_LIMIT 10 ///< maksymalna długość liczby 64-bitowej w kodowaniu varint
+
+
+/** @brief Inicjalizuje buforowane wyjście.
+ * Sprawdza czy standardowe wyjście i standardowe wyjście błędów wskazują na
+ * ten sam plik.
+ * @param[in] flush_every_command - jeśli ma wartość @p true, bufory są
+ * 								opróżniane po każdym poleceniu (tryb dla
+ * 								programów komunikujących się przez potoki).
+ */
+void init_output(bool flush_every_command);
+
+/** @brief Wypisuje całe dane na deskryptor.
+ * Ponawia wywołanie funkcji write aż do wypisania wszystkich danych lub
+ * wystąpienia błędu.
+ * @param[in] fd 		- deskryptor, na który wypisujemy,
+ * @param[in] data 		- wskaźnik na wypisywane dane,
+ * @param[in] length 	- liczba bajtów do wypisania.
+ * @return Wartość @p true, jeśli wypisano wszystkie dane lub @p false, jeśli
+ * wystąpił błąd.
+ */
+bool write_all(int fd, const char *data, size_t length);
+
+/** @brief Zapisuje liczbę w postaci dziesiętnej.
+ * Liczba jest formatowana ręcznie, bez użycia funkcji z rodziny printf.
+ * Napis nie jest kończony znakiem '\0'.
+ * @param[out] destination 	- wskaźnik na pamięć o rozmiarze co najmniej
+ * 							@ref UINT64_LIMIT bajtów,
+ * @param[in] number 		- zapisywana liczba.
+ * @return Liczba zapisanych cyfr.
+ */
+size_t format_number(char *destination, uint64_t number);
+
+/** @brief Zapisuje liczbę w kodowaniu varint.
+ * Liczba jest zapisywana po 7 bitów na bajt, od najmniej znaczących, a
+ * najstarszy bit bajtu oznacza, że liczba ma kolejne bajty.
+ * @param[out] destination 	- wskaźnik na pamięć o rozmiarze co najmniej
+ * 							@ref VARINT_LIMIT bajtów,
+ * @param[in] number 		- zapisywana liczba.
+ * @return Liczba zapisanych bajtów.
+ */
+size_t format_varint(char *destination, uint64_t number);
+
+/** @brief Dopisuje do bufora liczbę zakończoną znakiem nowej linii.
+ * @param[in] number 	- wypisywana liczba.
+ */
+void print_number(uint64_t number);
+
+/** @brief Dopisuje do bufora komunikat o błędzie.
+ * Komunikat ma postać "ERROR n" i trafia na standardowe wyjście błędów.
+ * @param[in] line 		- numer linijki, w której wystąpił błąd.
+ */
+void print_error(int line);
+
+/** @brief Dopisuje do bufora informację o odrzuconym ruchu.
+ * Komunikat ma postać "REJECTED n" i jest odpowiedzią na ruch odrzucony
+ * w bloku cichym trybu wsadowego.
+ * @param[in] line 		- numer linijki z odrzuconym ruchem.
+ */
+void print_rejected(int line);
+
+/** @brief Dopisuje do bufora potwierdzenie utworzenia gry.
+ * Komunikat ma postać "OK n".
+ * @param[in] line 		- numer linijki z poleceniem tworzącym grę.
+ */
+void print_ok(int line);
+
+/** @brief Dopisuje do bufora napis.
+ * @param[in] text 		- wskaźnik na wypisywany napis,
+ * @param[in] length 	- długość napisu.
+ */
+void print_text(const char *text, size_t length);
+
+/** @brief Dopisuje do bufora fragment danych binarnych.
+ * Działa jak @ref print_text, ale ma postać funkcji zapisującej
+ * (@ref image_writer_t), więc może przyjmować eksportowane obrazy.
+ * @param[in] context 	- nieużywany,
+ * @param[in] data 		- wskaźnik na wypisywane dane,
+ * @param[in] length 	- liczba bajtów.
+ */
+void print_data(void *context, const char *data, size_t length);
+
+/** @brief Kończy obsługę jednego polecenia.
+ * Opróżnia bufory, jeśli wybrano tryb opróżniania po każdym poleceniu.
+ */
+void end_of_command(void);
+
+/** @brief Opróżnia bufory.
+ * Wypisuje całą zawartość buforów na odpowiednie deskryptory.
+ */
+void flush_output(void);
+
+#endif /* OUTPUT_H */
@@ -0,0 +1,167 @@
+/** @file
+ * Implementacja klasy mierzącej wydajność konwersji poleceń trybu wsadowego.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#define _POSIX_C_SOURCE 200809L ///< udostępnia funkcję clock_gettime
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "parsing_benchmark.h"
+#include "batch_mode.h"
+#include "output.h"
+
+
+#define BENCHMARK_PASSES 5 ///< liczba przebiegów konwersji
+
+#define MAX_LINE_LENGTH 64 ///< maksymalna długość tworzonej linijki
+
+#define BOARD_SIZE 10000 ///< zakres współrzędnych w tworzonych poleceniach
+
+#define LINE_LENGTH 160 ///< maksymalna długość wypisywanej linijki
+
+
+static uint64_t next_random(uint64_t *seed);
+
+static int write_line(char *line, uint64_t *seed);
+
+static char* generate_lines(uint32_t lines, size_t *length);
+
+static void parse_all(const char *data, size_t length, uint64_t *commands,
+                      uint64_t *errors);
+
+
+/** @brief Losuje kolejną liczbę generatorem xorshift.
+ * @param[in,out] seed 	- niezerowy stan generatora.
+ * @return Wylosowana liczba.
+ */
+uint64_t next_random(uint64_t *seed) {
+	*seed ^= *seed << 13;
+	*seed ^= *seed >> 7;
+	*seed ^= *seed << 17;
+	return *seed;
+}
+
+/** @brief Tworzy jedną losową linijkę.
+ * Większość linijek to poprawne ruchy, serie ruchów i zapytania, a część to
+ * komentarze, puste linijki, linijki z liczbą przekraczającą zakres lub
+ * z błędnym znakiem.
+ * @param[out] line 	- bufor o rozmiarze co najmniej @ref MAX_LINE_LENGTH,
+ * @param[in,out] seed 	- stan generatora liczb losowych.
+ * @return Długość linijki razem ze znakiem nowej linii.
+ */
+int write_line(char *line, uint64_t *seed) {
+	uint64_t random = next_random(seed);
+	uint32_t player = (uint32_t)(random % 8) + 1;
+	uint32_t x = (uint32_t)(random >> 16) % BOARD_SIZE;
+	uint32_t y = (uint32_t)(random >> 32) % BOARD_SIZE;
+	switch((random >> 56) % 16) {
+		case 0:
+			return snprintf(line, MAX_LINE_LENGTH, "g %u %u %u\n", player, x, y);
+		case 1:
+			return snprintf(line, MAX_LINE_LENGTH, "b %u\n", player);
+		case 2:
+			return snprintf(line, MAX_LINE_LENGTH, "f\t%u \n", player);
+		case 3:
+			return snprintf(line, MAX_LINE_LENGTH, "q %u\n", player);
+		case 4:
+			return snprintf(line, MAX_LINE_LENGTH, "# komentarz %u\n", x);
+		case 5:
+			return snprintf(line, MAX_LINE_LENGTH, "\n");
+		case 6:
+			return snprintf(line, MAX_LINE_LENGTH, "m %u %u 4294967296%u\n",
+			                player, x, y);
+		case 7:
+			return snprintf(line, MAX_LINE_LENGTH, "m %u %ux %u\n", player, x, y);
+		case 8:
+			return snprintf(line, MAX_LINE_LENGTH, "l %u %u %u %u %u %u %u\n",
+			                player, x, y, y, x, x + 1, y);
+		default:
+			return snprintf(line, MAX_LINE_LENGTH, "m %u  %u %u\n", player, x, y);
+	}
+}
+
+/** @brief Tworzy bufor z losowymi linijkami.
+ * @param[in] lines 	- liczba linijek,
+ * @param[out] length 	- wskaźnik, pod który zostaje zapisana długość bufora.
+ * @return Wskaźnik na zaalokowany bufor lub NULL, jeśli zabrakło pamięci.
+ */
+char* generate_lines(uint32_t lines, size_t *length) {
+	char *data = malloc((size_t)lines * MAX_LINE_LENGTH + 1);
+	if(data == NULL) {
+		return NULL;
+	}
+	uint64_t seed = 1;
+	size_t position = 0;
+	for(uint32_t i = 0; i < lines; i++) {
+		position += (size_t)write_line(data + position, &seed);
+	}
+	*length = position;
+	return data;
+}
+
+/** @brief Dzieli bufor na linijki i konwertuje je w trybie wsadowym.
+ * @param[in] data 		- wskaźnik na bufor z linijkami,
+ * @param[in] length 	- długość bufora,
+ * @param[out] commands - liczba prawidłowych poleceń,
+ * @param[out] errors 	- liczba linijek nieprawidłowych.
+ */
+void parse_all(const char *data, size_t length, uint64_t *commands,
+               uint64_t *errors) {
+	const char *position = data, *end = data + length;
+	*commands = *errors = 0;
+	while(position != end) {
+		const char *newline = memchr(position, '\n', (size_t)(end - position));
+		command_t command;
+		line_type_t type = parse_line(position, (size_t)(newline - position),
+		                              BATCH_READING, &command);
+		if(type == COMMAND_LINE) {
+			(*commands)++;
+			free(command.list);
+		}
+		else if(type == INVALID_LINE) {
+			(*errors)++;
+		}
+		position = newline + 1;
+	}
+}
+
+
+int parsing_benchmark(uint32_t lines) {
+	size_t length;
+	char *data = generate_lines(lines, &length);
+	if(data == NULL) {
+		return 1;
+	}
+	double best = 0;
+	uint64_t commands = 0, errors = 0;
+	for(int i = 0; i < BENCHMARK_PASSES; i++) {
+		struct timespec start, stop;
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		parse_all(data, length, &commands, &errors);
+		clock_gettime(CLOCK_MONOTONIC, &stop);
+		double time = (double)(stop.tv_sec - start.tv_sec)
+		              + (double)(stop.tv_nsec - start.tv_nsec) / 1e9;
+		if(i == 0 || time < best) {
+			best = time;
+		}
+	}
+	free(data);
+
+	char line[LINE_LENGTH];
+	int printed = snprintf(line, sizeof(line),
+	                       "%u lines: %.0f lines/s, %.1f MB/s, %llu commands, "
+	                       "%llu errors\n", lines, lines / best,
+	                       (double)length / best / 1e6,
+	                       (unsigned long long)commands,
+	                       (unsigned long long)errors);
+	if(printed > 0) {
+		print_text(line, (size_t)printed < sizeof(line) ? (size_t)printed
+		                                                : sizeof(line) - 1);
+	}
+	flush_output();
+	return 0;
+}
@@ -0,0 +1,26 @@
+/** @file
+ * Interfejs klasy mierzącej wydajność konwersji poleceń trybu wsadowego.
+ * Mierzony jest wyłącznie podział wejścia na linijki i ich konwersja
+ * (@ref parse_line), bez czytania wejścia i wykonywania poleceń.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef PARSING_BENCHMARK_H
+#define PARSING_BENCHMARK_H
+
+#include <stdint.h>
+
+
+/** @brief Obsługuje tryb pomiaru konwersji poleceń.
+ * Tworzy w pamięci @p lines losowych linijek trybu wsadowego, w tym
+ * komentarze i linijki nieprawidłowe, a następnie kilka razy konwertuje je
+ * wszystkie. Wypisuje na standardowe wyjście linijkę z liczbą linijek
+ * i megabajtów na sekundę w najszybszym przebiegu oraz liczbami poleceń
+ * i błędów.
+ * @param[in] lines 	- liczba linijek.
+ * @return Wartość 0, jeśli pomiar się udał lub 1, jeśli zabrakło pamięci.
+ */
+int parsing_benchmark(uint32_t lines);
+
+#endif /* PARSING_BENCHMARK_H */
@@ -0,0 +1,293 @@
+/** @file
+ * Implementacja potokowego trybu wsadowego.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include "pipeline.h"
+#include "batch_mode.h"
+#include "ring_buffer.h"
+#include "output.h"
+#include "move_log.h"
+#include "spectator.h"
+#include "image.h"
+
+
+#define PIPELINE_CAPACITY 4096 ///< pojemność buforów łączących wątki
+
+
+/**
+ * Polecenie przekazywane z wątku czytającego do wątku silnika gry.
+ */
+typedef struct job {
+	command_t command; 	///< polecenie do wykonania
+	int line; 			///< numer linijki z poleceniem
+	line_type_t type; 	///< rodzaj linijki, tylko COMMAND_LINE lub INVALID_LINE
+	bool last; 			///< informacja czy to znacznik końca wejścia
+	bool memory_error; 	///< informacja czy wejście skończyło się brakiem pamięci
+} job_t;
+
+/**
+ * Rodzaje odpowiedzi przekazywanych do wątku wypisującego.
+ */
+typedef enum answer_type {
+	NUMBER_ANSWER, 	///< liczba zwrócona przez funkcję silnika gry
+	BOARD_ANSWER, 	/**< opis planszy lub odpowiedź na polecenie zbiorcze,
+ * 					który należy zwolnić po wypisaniu, jego długość jest
+ * 					w polu value */
+	IMAGE_ANSWER, 	/**< obraz planszy, eksportowany przez wątek wypisujący,
+ * 					podczas gdy wątek silnika gry czeka */
+	QUERY_ANSWER, 	/**< odpowiedź na polecenie B, F lub Q, wypisywana przez
+ * 					wątek wypisujący, podczas gdy wątek silnika gry czeka */
+	ERROR_ANSWER, 	///< komunikat o błędzie w linijce
+	REJECTED_ANSWER, ///< komunikat o ruchu odrzuconym w bloku cichym
+	LAST_ANSWER 	///< znacznik końca odpowiedzi
+} answer_type_t;
+
+/**
+ * Odpowiedź przekazywana z wątku silnika gry do wątku wypisującego.
+ */
+typedef struct answer {
+	answer_type_t type; ///< rodzaj odpowiedzi
+	uint64_t value; 	/**< liczba do wypisania, numer błędnej linijki lub
+ * 						linijki z odrzuconym ruchem albo informacja o braku
+ * 						pamięci w znaczniku końca */
+	char *board; 		///< opis planszy dla odpowiedzi BOARD_ANSWER
+	uint32_t scale; 	///< pomniejszenie obrazu dla odpowiedzi IMAGE_ANSWER
+	uint32_t channels; 	///< liczba kanałów obrazu dla odpowiedzi IMAGE_ANSWER
+	command_t query; 	///< polecenie dla odpowiedzi QUERY_ANSWER
+} answer_t;
+
+/**
+ * Stan współdzielony przez wątki potoku.
+ */
+typedef struct pipeline {
+	gamma_t *g; 			///< wskaźnik na strukturę przechowującą stan gry
+	input_t *input; 		///< wskaźnik na strukturę buforowanego wejścia
+	int counter; 			///< licznik linijek, używany tylko przez wątek czytający
+	ring_buffer_t jobs; 	///< bufor poleceń
+	ring_buffer_t answers; 	///< bufor odpowiedzi
+	ring_buffer_t resume; 	/**< bufor, przez który wątek wypisujący pozwala
+ * 							wątkowi silnika gry kontynuować po eksporcie obrazu */
+} pipeline_t;
+
+
+static void* reader_thread(void *arg);
+
+static void* engine_thread(void *arg);
+
+static void print_answer(pipeline_t *pipeline, answer_t answer);
+
+
+/** @brief Czyta i konwertuje polecenia z wejścia.
+ * Puste linijki i komentarze są jedynie liczone, pozostałe linijki trafiają
+ * do bufora poleceń. Na koniec do bufora trafia znacznik końca wejścia.
+ * @param[in,out] arg 	- wskaźnik na strukturę @ref pipeline_t.
+ * @return Wartość NULL.
+ */
+void* reader_thread(void *arg) {
+	pipeline_t *pipeline = arg;
+	bool eof = false;
+	job_t job;
+	memset(&job, 0, sizeof(job));
+	while(!eof && errno != ENOMEM) {
+		job.type = read_command(pipeline->input, &job.command, &eof);
+		pipeline->counter++;
+		if(job.type != EMPTY_LINE) {
+			job.line = pipeline->counter;
+			ring_buffer_push(&pipeline->jobs, &job);
+		}
+	}
+	job.last = true;
+	job.memory_error = (errno == ENOMEM);
+	ring_buffer_push(&pipeline->jobs, &job);
+	return NULL;
+}
+
+/** @brief Wykonuje polecenia i przekazuje odpowiedzi.
+ * Jako jedyny wątek modyfikuje stan gry i publikuje zmiany planszy
+ * (@ref spectator.h). Zanim zacznie czekać na kolejne polecenia, zapisuje
+ * opublikowane zmiany, żeby obserwator widział je na bieżąco. Śledzi też
+ * blok cichy (@ref quiet_line), bo tylko on zna wyniki ruchów.
+ * @param[in,out] arg 	- wskaźnik na strukturę @ref pipeline_t.
+ * @return Wartość NULL.
+ */
+void* engine_thread(void *arg) {
+	pipeline_t *pipeline = arg;
+	job_t job;
+	answer_t answer;
+	answer.board = NULL;
+	uint32_t quiet_lines = 0;
+	do {
+		if(!ring_buffer_try_pop(&pipeline->jobs, &job)) {
+			flush_spectator_stream();
+			ring_buffer_pop(&pipeline->jobs, &job);
+		}
+		bool quiet = !job.last && quiet_line(&quiet_lines);
+		if(job.last) {
+			answer.type = LAST_ANSWER;
+			answer.value = job.memory_error;
+		}
+		else if(job.type == INVALID_LINE) {
+			answer.type = ERROR_ANSWER;
+			answer.value = (uint64_t)job.line;
+		}
+		else if(job.command.name == 's') {
+			quiet_lines = job.command.args[0];
+			continue;
+		}
+		else if(player_query(job.command.name)) {
+			bool resumed;
+			answer.type = QUERY_ANSWER;
+			answer.query = job.command;
+			ring_buffer_push(&pipeline->answers, &answer);
+			ring_buffer_pop(&pipeline->resume, &resumed);
+			continue;
+		}
+		else if(bulk_command(job.command.name)) {
+			size_t length = 0;
+			answer.board = call_bulk_function(job.command, pipeline->g, &length);
+			answer.type = answer.board ? BOARD_ANSWER : NUMBER_ANSWER;
+			answer.value = answer.board ? length : 0;
+			free(job.command.list);
+		}
+		else if(job.command.name == 'p' || job.command.name == 'r') {
+			size_t length = 0;
+			answer.board = call_board_function(job.command.name, pipeline->g,
+			                                   &length);
+			answer.type = answer.board ? BOARD_ANSWER : NUMBER_ANSWER;
+			answer.value = answer.board ? length : 0;
+		}
+		else if(job.command.name == 'e') {
+			bool resumed;
+			answer.type = IMAGE_ANSWER;
+			answer.scale = job.command.args[0];
+			answer.channels = job.command.args[1];
+			ring_buffer_push(&pipeline->answers, &answer);
+			ring_buffer_pop(&pipeline->resume, &resumed);
+			continue;
+		}
+		else {
+			answer.type = NUMBER_ANSWER;
+			answer.value = call_function(job.command, pipeline->g);
+			if(answer.value) {
+				uint32_t *args = job.command.args;
+				record_move(pipeline->g, job.command.name, args[0], args[1], args[2]);
+				publish_move(job.command.name, args[0], args[1], args[2]);
+			}
+			if(quiet && (job.command.name == 'm' || job.command.name == 'g')) {
+				if(answer.value) {
+					continue;
+				}
+				answer.type = REJECTED_ANSWER;
+				answer.value = (uint64_t)job.line;
+			}
+		}
+		ring_buffer_push(&pipeline->answers, &answer);
+	} while(!job.last);
+	return NULL;
+}
+
+/** @brief Wypisuje jedną odpowiedź do bufora wyjścia.
+ * Obraz planszy i odpowiedź na polecenie B, F lub Q są wypisywane
+ * bezpośrednio z aktualnego stanu gry, po czym wątek silnika gry może
+ * kontynuować.
+ * @param[in,out] pipeline 	- wskaźnik na stan potoku,
+ * @param[in] answer 		- wypisywana odpowiedź.
+ */
+void print_answer(pipeline_t *pipeline, answer_t answer) {
+	switch(answer.type) {
+		case NUMBER_ANSWER:
+			print_number(answer.value);
+			break;
+		case BOARD_ANSWER:
+			print_text(answer.board, (size_t)answer.value);
+			free(answer.board);
+			break;
+		case IMAGE_ANSWER: {
+			bool resumed = true;
+			if(!export_image(pipeline->g, answer.scale, answer.channels,
+			                 print_data, NULL)) {
+				print_number(0);
+			}
+			ring_buffer_push(&pipeline->resume, &resumed);
+			break;
+		}
+		case QUERY_ANSWER: {
+			bool resumed = true;
+			write_player_query(answer.query, pipeline->g, print_data, NULL);
+			ring_buffer_push(&pipeline->resume, &resumed);
+			break;
+		}
+		case ERROR_ANSWER:
+			print_error((int)answer.value);
+			break;
+		case REJECTED_ANSWER:
+			print_rejected((int)answer.value);
+			break;
+		case LAST_ANSWER:
+			break;
+	}
+}
+
+
+int pipelined_batch_mode(gamma_t *g, input_t *input, int counter) {
+	pipeline_t pipeline;
+	pipeline.g = g;
+	pipeline.input = input;
+	pipeline.counter = counter;
+	if(!init_ring_buffer(&pipeline.jobs, PIPELINE_CAPACITY, sizeof(job_t))) {
+		return 1;
+	}
+	if(!init_ring_buffer(&pipeline.answers, PIPELINE_CAPACITY, sizeof(answer_t))) {
+		delete_ring_buffer(&pipeline.jobs);
+		return 1;
+	}
+	if(!init_ring_buffer(&pipeline.resume, 1, sizeof(bool))) {
+		delete_ring_buffer(&pipeline.jobs);
+		delete_ring_buffer(&pipeline.answers);
+		return 1;
+	}
+
+	pthread_t reader, engine;
+	if(pthread_create(&engine, NULL, engine_thread, &pipeline) != 0) {
+		delete_ring_buffer(&pipeline.jobs);
+		delete_ring_buffer(&pipeline.answers);
+		delete_ring_buffer(&pipeline.resume);
+		return 1;
+	}
+	input->before_read = NULL;
+	bool reader_started = (pthread_create(&reader, NULL, reader_thread,
+	                                      &pipeline) == 0);
+	if(!reader_started) {
+		job_t last;
+		memset(&last, 0, sizeof(last));
+		last.last = last.memory_error = true;
+		ring_buffer_push(&pipeline.jobs, &last);
+	}
+
+	answer_t answer;
+	do {
+		if(!ring_buffer_try_pop(&pipeline.answers, &answer)) {
+			flush_output();
+			ring_buffer_pop(&pipeline.answers, &answer);
+		}
+		print_answer(&pipeline, answer);
+		end_of_command();
+	} while(answer.type != LAST_ANSWER);
+	flush_output();
+
+	if(reader_started) {
+		pthread_join(reader, NULL);
+	}
+	pthread_join(engine, NULL);
+	input->before_read = flush_output;
+	delete_ring_buffer(&pipeline.jobs);
+	delete_ring_buffer(&pipeline.answers);
+	delete_ring_buffer(&pipeline.resume);
+	return (int)answer.value;
+}
@@ -0,0 +1,30 @@
+/** @file
+ * Interfejs potokowego trybu wsadowego.
+ * Czytanie i konwersja poleceń, wykonywanie ich przez silnik gry oraz
+ * wypisywanie odpowiedzi odbywają się w trzech osobnych wątkach połączonych
+ * buforami cyklicznymi (@ref ring_buffer_t). Stan gry modyfikuje tylko
+ * jeden wątek, a odpowiedzi są wypisywane w kolejności poleceń.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "gamma.h"
+#include "input.h"
+
+
+/** @brief Obsługuje tryb wsadowy w sposób potokowy.
+ * Uruchamia wątek czytający polecenia i wątek silnika gry, a sam wypisuje
+ * odpowiedzi. Kończy działanie po przeczytaniu całego wejścia i wypisaniu
+ * wszystkich odpowiedzi.
+ * @param[in,out] g 		- wskaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] input 	- wskaźnik na strukturę buforowanego wejścia,
+ * @param[in] counter 		- liczba przeczytanych dotąd linijek z wejścia.
+ * @return Wartość 0, jeśli gra przebiegła prawidłowo lub 1, jeśli wystąpiły
+ * błędy np. brak pamięci.
+ */
+int pipelined_batch_mode(gamma_t *g, input_t *input, int counter);
+
+#endif /* PIPELINE_H */
@@ -4,58 +4,102 @@
  * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
  */
  
-#include <stdlib.h>
-#include <stdint.h>
+#include <string.h>
 #include "queue.h"
 
-bool empty_queue(queue_t queue) {
-	return (queue.start == NULL);
+
+#define BASIC_QUEUE_CAPACITY 64 ///< bazowa pojemność kolejki, potęga dwójki
+
+
+static bool grow_queue(queue_t *queue, size_t capacity);
+
+
+/** @brief Powiększa tablicę kolejki.
+ * Elementy są przepisywane na początek nowej tablicy, w kolejności.
+ * @param[in,out] queue - wskaźnik na kolejkę,
+ * @param[in] capacity 	- nowy rozmiar tablicy, potęga dwójki większa od
+ * 						obecnego.
+ * @return Wartość @p true, jeśli powiększono tablicę lub @p false, jeśli
+ * zabrakło pamięci.
+ */
+bool grow_queue(queue_t *queue, size_t capacity) {
+	if(capacity > SIZE_MAX / sizeof(field_t)) {
+		return false;
+	}
+	field_t *fields = allocate_memory(queue->memory, GAMMA_MEMORY_SEARCH,
+	                                  capacity * sizeof(field_t), false);
+	if(!fields) {
+		return false;
+	}
+	size_t first_part = queue->capacity - queue->start;
+	if(first_part > queue->length) {
+		first_part = queue->length;
+	}
+	if(queue->length > 0) {
+		memcpy(fields, queue->fields + queue->start, first_part * sizeof(field_t));
+		memcpy(fields + first_part, queue->fields,
+		       (queue->length - first_part) * sizeof(field_t));
+	}
+	release_memory(queue->memory, GAMMA_MEMORY_SEARCH, queue->fields,
+	               queue->capacity * sizeof(field_t));
+	queue->fields = fields;
+	queue->capacity = capacity;
+	queue->start = 0;
+	return true;
 }
 
-queue_t init_queue() {
+
+bool empty_queue(const queue_t *queue) {
+	return (queue->length == 0);
+}
+
+queue_t init_queue(memory_t *memory) {
 	queue_t queue;
-	queue.start = NULL;
+	queue.fields = NULL;
+	queue.capacity = queue.start = queue.length = 0;
+	queue.memory = memory;
 	return queue;
 }
 
-field_t front_of_queue(queue_t queue) {
-	return queue.start->field;
+field_t front_of_queue(const queue_t *queue) {
+	return queue->fields[queue->start];
 }
 
-bool enqueue(queue_t *queue, field_t field) {
-	if(queue->start == NULL) {
-		queue->start = (list_t *)malloc(sizeof(list_t));
-		queue->start->field = field;
-		queue->end = queue->start;
+bool reserve_queue(queue_t *queue, size_t length) {
+	size_t capacity = queue->capacity ? queue->capacity : BASIC_QUEUE_CAPACITY;
+	while(capacity < length) {
+		if(capacity > SIZE_MAX / 2) {
+			return false;
+		}
+		capacity *= 2;
 	}
-	else {
-		list_t *temp;
-		temp = (list_t *)malloc(sizeof(list_t));
-		temp->next = NULL;
-		temp->field = field;
-		queue->end->next = temp;
-		queue->end = queue->end->next;
+	return capacity == queue->capacity || grow_queue(queue, capacity);
+}
+
+bool enqueue(queue_t *queue, field_t field) {
+	if(queue->length == queue->capacity
+	   && !grow_queue(queue, queue->capacity ? 2 * queue->capacity
+	                                         : BASIC_QUEUE_CAPACITY)) {
+		return false;
 	}
+	queue->fields[(queue->start + queue->length) & (queue->capacity - 1)] = field;
+	queue->length++;
 	return true;
 }
 
 field_t dequeue(queue_t *queue) {
-	list_t *temp;
-	field_t field;
-	temp = queue->start;
-	field = queue->start->field;
-	if(queue->start == queue->end) {
-		queue->start = NULL;
-	}
-	else {
-		queue->start = queue->start->next;
-	}
-	free(temp);
+	field_t field = queue->fields[queue->start];
+	queue->start = (queue->start + 1) & (queue->capacity - 1);
+	queue->length--;
 	return field;
 }
 
 void clear_queue(queue_t *queue) {
-	while(!empty_queue(*queue)) {
-		dequeue(queue);
-	}
+	queue->start = queue->length = 0;
+}
+
+void delete_queue(queue_t *queue) {
+	release_memory(queue->memory, GAMMA_MEMORY_SEARCH, queue->fields,
+	               queue->capacity * sizeof(field_t));
+	*queue = init_queue(queue->memory);
 }
@@ -1,5 +1,8 @@
 /** @file
  * Interfejs klasy kolejki do przeszukiwania planszy metodą BFS.
+ * Kolejka jest tablicą cykliczną, która rośnie w miarę potrzeby i zachowuje
+ * zaalokowaną pamięć po opróżnieniu, dzięki czemu jedna kolejka może być
+ * używana w kolejnych przeszukiwaniach bez ponownego alokowania pamięci.
  *
  * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
  */
@@ -8,6 +11,9 @@
 #define QUEUE_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "memory.h"
 
 /**
  * Pole z planszy.
@@ -18,57 +24,79 @@ typedef struct field {
 } field_t;
 
 /**
- * Typowa lista na wskaźnkach.
- */
-typedef struct list {
-	field_t field; 	///< pole z planszy, zawartość każdego elementu listy
-	struct list *next; 	///< wskaźnik na następny element listy
-} list_t;
-
-/**
- * Implementacja listowa kolejki.
+ * Implementacja tablicowa kolejki.
  */
 typedef struct queue {
-	list_t *start; 	///< początek kolejki
-	list_t *end; 	///< koniec kolejki
+	field_t *fields; 	///< tablica cykliczna z elementami kolejki
+	size_t capacity; 	///< rozmiar tablicy, zero lub potęga dwójki
+	size_t start; 		///< indeks pierwszego elementu kolejki
+	size_t length; 		///< liczba elementów w kolejce
+	memory_t *memory; 	///< liczniki pamięci, do których liczy się tablica, lub NULL
 } queue_t;
 
 /** @brief Sprawdza czy kolejka jest pusta.
- * @param[in] queue 	- kolejka, która ma zostać sprawdzona.
+ * @param[in] queue 	- wskaźnik na kolejkę, która ma zostać sprawdzona.
  * @return Wartość @p true jeśli kolejka jest pusta, wartość @p false w przeciwnym
  * w przeciwnym wypadku.
  */
-bool empty_queue(queue_t queue);
+bool empty_queue(const queue_t *queue);
 
 /** @brief Inicjalizuje kolejkę.
+ * Pusta kolejka nie zajmuje pamięci, tablica jest alokowana dopiero przy
+ * pierwszym wstawieniu elementu.
+ * @param[in] memory 	- wskaźnik na liczniki pamięci gry, do których liczy
+ * 						się tablica kolejki (@ref GAMMA_MEMORY_SEARCH), lub
+ * 						NULL.
  * @return Zainicjalizowana kolejka.
  */
-queue_t init_queue();
+queue_t init_queue(memory_t *memory);
 
 /** @brief Podaje pierwszy element kolejki.
- * @param[in] queue 	- kolejka, której front chcemy otrzymać.
+ * @param[in] queue 	- wskaźnik na niepustą kolejkę, której front chcemy
+ * 						otrzymać.
  * @return Pierwszy element kolejki.
  */
-field_t front_of_queue(queue_t queue);
+field_t front_of_queue(const queue_t *queue);
+
+/** @brief Zapewnia miejsce na elementy kolejki.
+ * Powiększa tablicę tak, aby kolejka mogła pomieścić @p length elementów bez
+ * alokowania pamięci.
+ * @param[in,out] queue - wskaźnik na kolejkę,
+ * @param[in] length 	- liczba elementów, które ma pomieścić kolejka.
+ * @return Wartość @p true, jeśli kolejka może pomieścić tyle elementów lub
+ * @p false, jeśli zabrakło pamięci. W tym drugim przypadku kolejka pozostaje
+ * niezmieniona.
+ */
+bool reserve_queue(queue_t *queue, size_t length);
 
 /** @brief Wkłada element na koniec kolejki.
+ * Jeśli tablica jest pełna, dwukrotnie ją powiększa.
  * @param[in] queue 	- wskaźnik na kolejkę, do której chcemy dodać element,
  * @param[in] field 	- pole na planszy, ktore chcemy włożyć na koniec kolejki.
  * @return Wartość @p true, jeśli dodano element do kolejki lub @p false, jeśli
- * tak się nie stało z powodu braku pamięci.
+ * tak się nie stało z powodu braku pamięci. W tym drugim przypadku kolejka
+ * pozostaje niezmieniona.
  */
 bool enqueue(queue_t *queue, field_t field);
 
 /** @brief Wyjmuje pierwszy element w kolejce.
- * @param[in] queue 	- wskaźnik na kolejkę, z której chcemy otrzymać
- * 						pierwszy element.
+ * @param[in] queue 	- wskaźnik na niepustą kolejkę, z której chcemy
+ * 						otrzymać pierwszy element.
  * @return Pierwszy element w kolejce.
  */
 field_t dequeue(queue_t *queue);
 
 /** @brief Czyści całą kolejkę.
- * @param[in] queue 	- kolejka, która ma zostać wyczyszczona.
+ * Zaalokowana pamięć zostaje zachowana do ponownego użycia.
+ * @param[in] queue 	- wskaźnik na kolejkę, która ma zostać wyczyszczona.
  */
 void clear_queue(queue_t *queue);
 
+/** @brief Usuwa kolejkę.
+ * Zwalnia pamięć zajmowaną przez kolejkę, która od tej pory jest pusta
+ * i nadal może być używana.
+ * @param[in] queue 	- wskaźnik na kolejkę, która ma zostać usunięta.
+ */
+void delete_queue(queue_t *queue);
+
 #endif /* QUEUE_H */
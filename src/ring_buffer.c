@@ -0,0 +1,118 @@
+/** @file
+ * Implementacja klasy bufora cyklicznego łączącego dwa wątki.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include "ring_buffer.h"
+
+
+#define SPIN_LIMIT 256 /**< liczba prób sprawdzenia stanu bufora, po której
+ * wątek zasypia na zmiennej warunkowej */
+
+
+static void wait_for_other_side(ring_buffer_t *ring, bool producer);
+
+static void wake_other_side(ring_buffer_t *ring, bool producer);
+
+
+/** @brief Czeka aż drugi wątek zmieni stan bufora.
+ * Najpierw kilka razy oddaje procesor, a następnie zasypia na zmiennej
+ * warunkowej. Przed zaśnięciem ustawia własną flagę oczekiwania i ponownie
+ * sprawdza warunek, dzięki czemu sygnał od drugiego wątku nie może zostać
+ * zgubiony. Każdy wątek zeruje tylko własną flagę.
+ * @param[in,out] ring 		- wskaźnik na bufor,
+ * @param[in] producer 		- informacja czy czeka producent (na wolne miejsce),
+ * 							czy konsument (na dane).
+ */
+void wait_for_other_side(ring_buffer_t *ring, bool producer) {
+	for(int i = 0; i < SPIN_LIMIT; i++) {
+		size_t used = atomic_load(&ring->tail) - atomic_load(&ring->head);
+		if(producer ? used < ring->capacity : used > 0) {
+			return;
+		}
+		sched_yield();
+	}
+	atomic_bool *waiting = producer ? &ring->producer_waiting
+	                                : &ring->consumer_waiting;
+	pthread_mutex_lock(&ring->lock);
+	atomic_store(waiting, true);
+	size_t used = atomic_load(&ring->tail) - atomic_load(&ring->head);
+	if(producer ? used == ring->capacity : used == 0) {
+		pthread_cond_wait(&ring->wakeup, &ring->lock);
+	}
+	atomic_store(waiting, false);
+	pthread_mutex_unlock(&ring->lock);
+}
+
+/** @brief Budzi drugi wątek, jeśli zasnął.
+ * @param[in,out] ring 		- wskaźnik na bufor,
+ * @param[in] producer 		- informacja czy budzi producent (konsumenta),
+ * 							czy konsument (producenta).
+ */
+void wake_other_side(ring_buffer_t *ring, bool producer) {
+	if(atomic_load(producer ? &ring->consumer_waiting
+	                        : &ring->producer_waiting)) {
+		pthread_mutex_lock(&ring->lock);
+		pthread_cond_signal(&ring->wakeup);
+		pthread_mutex_unlock(&ring->lock);
+	}
+}
+
+
+bool init_ring_buffer(ring_buffer_t *ring, size_t capacity, size_t element_size) {
+	ring->elements = malloc(capacity * element_size);
+	if(!ring->elements) {
+		return false;
+	}
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	atomic_init(&ring->producer_waiting, false);
+	atomic_init(&ring->consumer_waiting, false);
+	pthread_mutex_init(&ring->lock, NULL);
+	pthread_cond_init(&ring->wakeup, NULL);
+	ring->capacity = capacity;
+	ring->element_size = element_size;
+	return true;
+}
+
+void ring_buffer_push(ring_buffer_t *ring, const void *element) {
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	while(tail - atomic_load_explicit(&ring->head, memory_order_acquire)
+	      == ring->capacity) {
+		wait_for_other_side(ring, true);
+	}
+	memcpy(ring->elements + (tail & (ring->capacity - 1)) * ring->element_size,
+	       element, ring->element_size);
+	atomic_store(&ring->tail, tail + 1);
+	wake_other_side(ring, true);
+}
+
+bool ring_buffer_try_pop(ring_buffer_t *ring, void *element) {
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	if(head == atomic_load_explicit(&ring->tail, memory_order_acquire)) {
+		return false;
+	}
+	memcpy(element,
+	       ring->elements + (head & (ring->capacity - 1)) * ring->element_size,
+	       ring->element_size);
+	atomic_store(&ring->head, head + 1);
+	wake_other_side(ring, false);
+	return true;
+}
+
+void ring_buffer_pop(ring_buffer_t *ring, void *element) {
+	while(!ring_buffer_try_pop(ring, element)) {
+		wait_for_other_side(ring, false);
+	}
+}
+
+void delete_ring_buffer(ring_buffer_t *ring) {
+	pthread_mutex_destroy(&ring->lock);
+	pthread_cond_destroy(&ring->wakeup);
+	free(ring->elements);
+	ring->elements = NULL;
+}
@@ -0,0 +1,82 @@
+/** @file
+ * Interfejs klasy bufora cyklicznego łączącego dwa wątki.
+ * Bufor obsługuje dokładnie jednego producenta i jednego konsumenta
+ * (single producer, single consumer). Wstawianie i wyjmowanie elementów nie
+ * wymaga blokad, dopiero wątek, który długo czeka na miejsce lub na dane,
+ * zasypia na zmiennej warunkowej.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+
+#define CACHE_LINE_SIZE 64 ///< rozmiar linii pamięci podręcznej procesora
+
+
+/**
+ * Bufor cykliczny o pojemności będącej potęgą dwójki.
+ */
+typedef struct ring_buffer {
+	_Alignas(CACHE_LINE_SIZE) atomic_size_t head; 	/**< liczba elementów
+ * 							wyjętych z bufora, zapisywana przez konsumenta */
+	_Alignas(CACHE_LINE_SIZE) atomic_size_t tail; 	/**< liczba elementów
+ * 							włożonych do bufora, zapisywana przez producenta */
+	_Alignas(CACHE_LINE_SIZE) atomic_bool producer_waiting; /**< informacja
+ * 							czy producent zasnął w oczekiwaniu na miejsce */
+	atomic_bool consumer_waiting; /**< informacja czy konsument zasnął
+ * 							w oczekiwaniu na dane */
+	pthread_mutex_t lock; 	///< blokada chroniąca zasypianie i budzenie wątków
+	pthread_cond_t wakeup; 	///< zmienna warunkowa, na której czekają wątki
+	size_t capacity; 		///< pojemność bufora, potęga dwójki
+	size_t element_size; 	///< rozmiar jednego elementu w bajtach
+	char *elements; 		///< tablica elementów
+} ring_buffer_t;
+
+
+/** @brief Inicjalizuje bufor cykliczny.
+ * @param[out] ring 		- wskaźnik na inicjalizowany bufor,
+ * @param[in] capacity 		- pojemność bufora, potęga dwójki,
+ * @param[in] element_size 	- rozmiar jednego elementu w bajtach.
+ * @return Wartość @p true, jeśli udało się zainicjalizować bufor lub
+ * @p false, jeśli zabrakło pamięci.
+ */
+bool init_ring_buffer(ring_buffer_t *ring, size_t capacity, size_t element_size);
+
+/** @brief Wkłada element na koniec bufora.
+ * Jeśli bufor jest pełny, czeka aż konsument zwolni miejsce.
+ * Może być wywoływana tylko przez wątek producenta.
+ * @param[in,out] ring 		- wskaźnik na bufor,
+ * @param[in] element 		- wskaźnik na wkładany element.
+ */
+void ring_buffer_push(ring_buffer_t *ring, const void *element);
+
+/** @brief Próbuje wyjąć pierwszy element z bufora.
+ * Może być wywoływana tylko przez wątek konsumenta.
+ * @param[in,out] ring 		- wskaźnik na bufor,
+ * @param[out] element 		- wskaźnik, pod który zostaje skopiowany element.
+ * @return Wartość @p true, jeśli wyjęto element lub @p false, jeśli bufor
+ * był pusty.
+ */
+bool ring_buffer_try_pop(ring_buffer_t *ring, void *element);
+
+/** @brief Wyjmuje pierwszy element z bufora.
+ * Jeśli bufor jest pusty, czeka aż producent włoży element.
+ * Może być wywoływana tylko przez wątek konsumenta.
+ * @param[in,out] ring 		- wskaźnik na bufor,
+ * @param[out] element 		- wskaźnik, pod który zostaje skopiowany element.
+ */
+void ring_buffer_pop(ring_buffer_t *ring, void *element);
+
+/** @brief Usuwa bufor cykliczny.
+ * @param[in,out] ring 		- wskaźnik na usuwany bufor.
+ */
+void delete_ring_buffer(ring_buffer_t *ring);
+
+#endif /* RING_BUFFER_H */
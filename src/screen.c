@@ -0,0 +1,278 @@
+/** @file
+ * Implementacja klasy wyświetlającej klatki w terminalu.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "screen.h"
+#include "output.h"
+
+
+/** @name Makra zastępujące kody ANSI
+ */
+///@{
+#define CLEAR_SCREEN "\x1b[0m\x1b[H\x1b[2J" /**< Wyłączenie atrybutów, przesunięcie
+ * kursora w lewy, górny róg i usunięcie całej zawartości terminala */
+
+#define CLEAR_DISPLAY "\x1b[0J"			/**< Usunięcie zawartości okna terminala
+ * 										 	 od kursora do końca */
+
+#define ACTIVATE_REVERSE_FG_BG "\x1b[7m" /**< Kod ANSI aktywujący zamianę koloru
+ * tła z kolorem tekstu.
+ */
+
+#define RESET "\x1b[0m" /**< Resetuje poprzednio aktywowane kody ANSI modyfikujące
+ * tekst.
+ */
+///@}
+
+#define ESCAPE_LIMIT (2 * UINT64_LIMIT + 4) ///< maksymalna długość kodu przesuwającego kursor
+
+#define MAX_GAP 4 /**< najdłuższy ciąg niezmienionych znaków, który jest
+ * wypisywany ponownie zamiast przesuwać kursor */
+
+#define UNKNOWN_ROW UINT32_MAX ///< wartość oznaczająca nieznane położenie kursora
+
+
+static void append(screen_t *screen, const char *data, size_t length);
+
+static void move_to(screen_t *screen, uint32_t row, uint32_t column);
+
+static void emit_cell(screen_t *screen, screen_cell_t cell);
+
+static bool same_cell(screen_cell_t first, screen_cell_t second);
+
+static void draw_row(screen_t *screen, uint32_t row);
+
+
+/** @brief Dopisuje dane do bufora terminala.
+ * Bufor ma rozmiar wystarczający na całą klatkę, więc jest wypisywany
+ * wcześniej tylko przy długim tekście dopisywanym przez @ref write_text.
+ * @param[in,out] screen 	- wskaźnik na ekran,
+ * @param[in] data 			- wskaźnik na dopisywane dane,
+ * @param[in] length 		- liczba dopisywanych bajtów.
+ */
+void append(screen_t *screen, const char *data, size_t length) {
+	if(length > screen->capacity - screen->length) {
+		flush_screen(screen);
+		if(length > screen->capacity) {
+			write_all(screen->fd, data, length);
+			return;
+		}
+	}
+	memcpy(screen->output + screen->length, data, length);
+	screen->length += length;
+}
+
+/** @brief Przesuwa kursor terminala na zadane miejsce.
+ * Wybiera najkrótszy kod: nic, powrót karetki, przesunięcie w prawo lub
+ * przesunięcie na pozycję bezwzględną.
+ * @param[in,out] screen 	- wskaźnik na ekran,
+ * @param[in] row 			- wiersz, liczony od 0,
+ * @param[in] column 		- kolumna, liczona od 0.
+ */
+void move_to(screen_t *screen, uint32_t row, uint32_t column) {
+	if(screen->cursor_row == row && screen->cursor_column == column) {
+		return;
+	}
+	char escape[ESCAPE_LIMIT];
+	size_t length = 0;
+	if(screen->cursor_row == row && column == 0) {
+		escape[length++] = '\r';
+	}
+	else if(screen->cursor_row == row && column > screen->cursor_column) {
+		escape[length++] = '\x1b';
+		escape[length++] = '[';
+		if(column - screen->cursor_column > 1) {
+			length += format_number(escape + length, column - screen->cursor_column);
+		}
+		escape[length++] = 'C';
+	}
+	else {
+		escape[length++] = '\x1b';
+		escape[length++] = '[';
+		length += format_number(escape + length, (uint64_t)row + 1);
+		if(column > 0) {
+			escape[length++] = ';';
+			length += format_number(escape + length, (uint64_t)column + 1);
+		}
+		escape[length++] = 'H';
+	}
+	append(screen, escape, length);
+	screen->cursor_row = row;
+	screen->cursor_column = column;
+}
+
+/** @brief Wypisuje jeden znak w miejscu kursora terminala.
+ * @param[in,out] screen 	- wskaźnik na ekran,
+ * @param[in] cell 			- wypisywany znak z atrybutem.
+ */
+void emit_cell(screen_t *screen, screen_cell_t cell) {
+	if(cell.reverse != screen->reverse) {
+		if(cell.reverse) {
+			append(screen, ACTIVATE_REVERSE_FG_BG, sizeof(ACTIVATE_REVERSE_FG_BG) - 1);
+		}
+		else {
+			append(screen, RESET, sizeof(RESET) - 1);
+		}
+		screen->reverse = cell.reverse;
+	}
+	append(screen, &cell.character, 1);
+	if(++screen->cursor_column == screen->columns) {
+		screen->cursor_row = UNKNOWN_ROW;
+	}
+}
+
+/** @brief Porównuje dwa znaki siatki.
+ * @param[in] first 	- pierwszy znak,
+ * @param[in] second 	- drugi znak.
+ * @return Wartość @p true, jeśli znaki i atrybuty są równe lub @p false
+ * w przeciwnym wypadku.
+ */
+bool same_cell(screen_cell_t first, screen_cell_t second) {
+	return first.character == second.character && first.reverse == second.reverse;
+}
+
+/** @brief Wypisuje zmienione fragmenty jednego wiersza.
+ * Fragmenty oddzielone mniej niż @ref MAX_GAP niezmienionymi znakami są
+ * łączone, bo ponowne wypisanie kilku znaków jest krótsze od kodu
+ * przesuwającego kursor.
+ * @param[in,out] screen 	- wskaźnik na ekran,
+ * @param[in] row 			- numer wiersza.
+ */
+void draw_row(screen_t *screen, uint32_t row) {
+	const screen_cell_t *front = screen->front + (size_t)row * screen->columns;
+	const screen_cell_t *back = screen->back + (size_t)row * screen->columns;
+	uint32_t column = 0;
+	while(column < screen->columns) {
+		if(same_cell(front[column], back[column])) {
+			column++;
+			continue;
+		}
+		uint32_t end = column + 1, last_changed = column;
+		while(end < screen->columns && end - last_changed <= MAX_GAP) {
+			if(!same_cell(front[end], back[end])) {
+				last_changed = end;
+			}
+			end++;
+		}
+		move_to(screen, row, column);
+		for(uint32_t i = column; i <= last_changed; i++) {
+			emit_cell(screen, back[i]);
+		}
+		column = last_changed + 1;
+	}
+}
+
+
+void init_screen(screen_t *screen, int fd) {
+	memset(screen, 0, sizeof(screen_t));
+	screen->fd = fd;
+	screen->redraw = true;
+	screen->cursor_row = UNKNOWN_ROW;
+}
+
+bool resize_screen(screen_t *screen, uint32_t rows, uint32_t columns) {
+	if(rows != screen->rows || columns != screen->columns) {
+		size_t cells = (size_t)rows * columns;
+		screen_cell_t *front = malloc(cells * sizeof(screen_cell_t));
+		screen_cell_t *back = malloc(cells * sizeof(screen_cell_t));
+		size_t capacity = cells * (sizeof(ACTIVATE_REVERSE_FG_BG) + 1)
+		                  + (size_t)rows * ESCAPE_LIMIT + sizeof(CLEAR_SCREEN)
+		                  + ESCAPE_LIMIT;
+		char *output = malloc(capacity);
+		if(!front || !back || !output) {
+			free(front);
+			free(back);
+			free(output);
+			return false;
+		}
+		delete_screen(screen);
+		screen->front = front;
+		screen->back = back;
+		screen->output = output;
+		screen->capacity = capacity;
+		screen->rows = rows;
+		screen->columns = columns;
+		screen->redraw = true;
+	}
+	clear_frame(screen);
+	return true;
+}
+
+void clear_frame(screen_t *screen) {
+	size_t cells = (size_t)screen->rows * screen->columns;
+	for(size_t i = 0; i < cells; i++) {
+		screen->back[i].character = ' ';
+		screen->back[i].reverse = false;
+	}
+}
+
+void put_text(screen_t *screen, uint32_t row, uint32_t column, const char *text,
+              size_t length, bool reverse) {
+	if(row >= screen->rows || column >= screen->columns) {
+		return;
+	}
+	if(length > screen->columns - column) {
+		length = screen->columns - column;
+	}
+	screen_cell_t *cell = screen->back + (size_t)row * screen->columns + column;
+	for(size_t i = 0; i < length; i++) {
+		cell[i].character = text[i];
+		cell[i].reverse = reverse;
+	}
+}
+
+void present_frame(screen_t *screen, uint32_t row, uint32_t column) {
+	if(screen->redraw) {
+		append(screen, CLEAR_SCREEN, sizeof(CLEAR_SCREEN) - 1);
+		size_t cells = (size_t)screen->rows * screen->columns;
+		for(size_t i = 0; i < cells; i++) {
+			screen->front[i].character = ' ';
+			screen->front[i].reverse = false;
+		}
+		screen->reverse = false;
+		screen->cursor_row = screen->cursor_column = 0;
+		screen->redraw = false;
+	}
+	for(uint32_t i = 0; i < screen->rows; i++) {
+		draw_row(screen, i);
+	}
+	if(screen->reverse) {
+		append(screen, RESET, sizeof(RESET) - 1);
+		screen->reverse = false;
+	}
+	move_to(screen, row, column);
+	flush_screen(screen);
+	screen_cell_t *displayed = screen->back;
+	screen->back = screen->front;
+	screen->front = displayed;
+	clear_frame(screen);
+}
+
+void clear_below(screen_t *screen, uint32_t row) {
+	move_to(screen, row, 0);
+	append(screen, CLEAR_DISPLAY, sizeof(CLEAR_DISPLAY) - 1);
+	screen->cursor_row = UNKNOWN_ROW;
+	screen->redraw = true;
+}
+
+void write_text(screen_t *screen, const char *text, size_t length) {
+	append(screen, text, length);
+}
+
+void flush_screen(screen_t *screen) {
+	write_all(screen->fd, screen->output, screen->length);
+	screen->length = 0;
+}
+
+void delete_screen(screen_t *screen) {
+	free(screen->front);
+	free(screen->back);
+	free(screen->output);
+	screen->front = screen->back = NULL;
+	screen->output = NULL;
+	screen->capacity = screen->length = 0;
+}
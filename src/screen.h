@@ -0,0 +1,122 @@
+/** @file
+ * Interfejs klasy wyświetlającej klatki w terminalu.
+ * Klatka jest budowana w pamięci jako siatka znaków o wymiarach terminala.
+ * Przy wyświetlaniu jest porównywana z poprzednio wyświetloną klatką, a do
+ * terminala trafiają tylko zmienione fragmenty linijek, poprzedzone możliwie
+ * krótkimi kodami przesuwającymi kursor. Cała klatka jest wypisywana jednym
+ * wywołaniem funkcji write.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef SCREEN_H
+#define SCREEN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+
+/**
+ * Jeden znak siatki wraz z atrybutem.
+ */
+typedef struct screen_cell {
+	char character; 	///< wyświetlany znak
+	bool reverse; 		///< informacja czy kolory tła i tekstu są zamienione
+} screen_cell_t;
+
+/**
+ * Stan ekranu terminala.
+ */
+typedef struct screen {
+	int fd; 				///< deskryptor terminala
+	uint32_t rows; 			///< liczba wierszy terminala
+	uint32_t columns; 		///< liczba kolumn terminala
+	screen_cell_t *front; 	///< klatka wyświetlona w terminalu
+	screen_cell_t *back; 	///< budowana klatka
+	bool redraw; 			/**< informacja czy zawartość terminala jest
+ * 							nieznana i przed następną klatką trzeba go
+ * 							wyczyścić */
+	uint32_t cursor_row; 	/**< wiersz, w którym jest kursor terminala lub
+ * 							UINT32_MAX, jeśli położenie kursora jest nieznane */
+	uint32_t cursor_column; ///< kolumna, w której jest kursor terminala
+	bool reverse; 			///< informacja czy w terminalu włączono zamianę kolorów
+	char *output; 			///< bufor z danymi dla terminala
+	size_t length; 			///< liczba zajętych bajtów bufora
+	size_t capacity; 		///< rozmiar bufora
+} screen_t;
+
+
+/** @brief Inicjalizuje ekran.
+ * Ekran nie ma jeszcze wymiarów, trzeba je zadać funkcją @ref resize_screen.
+ * @param[out] screen 	- wskaźnik na inicjalizowany ekran,
+ * @param[in] fd 		- deskryptor terminala.
+ */
+void init_screen(screen_t *screen, int fd);
+
+/** @brief Zmienia wymiary ekranu.
+ * Jeśli wymiary się zmieniły, następna klatka zostanie wypisana w całości.
+ * Budowana klatka zostaje wyczyszczona.
+ * @param[in,out] screen 	- wskaźnik na ekran,
+ * @param[in] rows 			- liczba wierszy terminala, dodatnia,
+ * @param[in] columns 		- liczba kolumn terminala, dodatnia.
+ * @return Wartość @p true, jeśli się udało lub @p false, jeśli zabrakło
+ * pamięci.
+ */
+bool resize_screen(screen_t *screen, uint32_t rows, uint32_t columns);
+
+/** @brief Czyści budowaną klatkę.
+ * @param[in,out] screen 	- wskaźnik na ekran.
+ */
+void clear_frame(screen_t *screen);
+
+/** @brief Wpisuje napis do budowanej klatki.
+ * Znaki wychodzące poza ekran są pomijane.
+ * @param[in,out] screen 	- wskaźnik na ekran,
+ * @param[in] row 			- wiersz, liczony od 0,
+ * @param[in] column 		- kolumna pierwszego znaku, liczona od 0,
+ * @param[in] text 			- wskaźnik na napis,
+ * @param[in] length 		- długość napisu,
+ * @param[in] reverse 		- informacja czy zamienić kolory tła i tekstu.
+ */
+void put_text(screen_t *screen, uint32_t row, uint32_t column, const char *text,
+              size_t length, bool reverse);
+
+/** @brief Wyświetla budowaną klatkę.
+ * Wypisuje zmiany względem poprzedniej klatki i ustawia kursor terminala
+ * w zadanym miejscu. Po wyświetleniu budowana klatka jest wyczyszczona.
+ * @param[in,out] screen 	- wskaźnik na ekran,
+ * @param[in] row 			- wiersz, w którym ma się znaleźć kursor,
+ * @param[in] column 		- kolumna, w której ma się znaleźć kursor.
+ */
+void present_frame(screen_t *screen, uint32_t row, uint32_t column);
+
+/** @brief Czyści terminal pod wyświetloną klatką.
+ * Przesuwa kursor terminala na początek zadanego wiersza i czyści terminal od
+ * niego w dół. Dalszy tekst można dopisać funkcją @ref write_text. Po tej
+ * operacji zawartość terminala jest uznawana za nieznaną, więc następna
+ * klatka zostanie wypisana w całości.
+ * @param[in,out] screen 	- wskaźnik na ekran,
+ * @param[in] row 			- wiersz, od którego terminal jest czyszczony.
+ */
+void clear_below(screen_t *screen, uint32_t row);
+
+/** @brief Dopisuje tekst w miejscu kursora terminala.
+ * Tekst trafia do bufora i jest wypisywany przez @ref flush_screen.
+ * @param[in,out] screen 	- wskaźnik na ekran,
+ * @param[in] text 			- wskaźnik na tekst,
+ * @param[in] length 		- długość tekstu.
+ */
+void write_text(screen_t *screen, const char *text, size_t length);
+
+/** @brief Wypisuje zawartość bufora na terminal.
+ * @param[in,out] screen 	- wskaźnik na ekran.
+ */
+void flush_screen(screen_t *screen);
+
+/** @brief Zwalnia pamięć zajmowaną przez ekran.
+ * @param[in,out] screen 	- wskaźnik na ekran.
+ */
+void delete_screen(screen_t *screen);
+
+#endif /* SCREEN_H */
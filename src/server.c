@@ -0,0 +1,807 @@
+/** @file
+ * Implementacja trybu serwera gier.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#define _GNU_SOURCE ///< udostępnia funkcję accept4
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "server.h"
+#include "gamma.h"
+#include "batch_mode.h"
+#include "ring_buffer.h"
+#include "output.h"
+#include "image.h"
+
+
+#define MAX_WORKERS 256 ///< maksymalna liczba wątków roboczych
+
+#define WORKER_QUEUE_CAPACITY (1 << 14) ///< pojemność kolejki połączeń jednego wątku
+
+#define MAX_EVENTS 256 ///< maksymalna liczba zdarzeń odbieranych naraz
+
+#define READ_SIZE (1 << 16) ///< minimalne wolne miejsce przy czytaniu z gniazda
+
+#define INPUT_LIMIT (1 << 20) /**< liczba nieprzetworzonych bajtów, po której
+ * serwer przestaje czytać z połączenia */
+
+#define OUTPUT_LIMIT (1 << 20) /**< liczba niewysłanych bajtów, po której serwer
+ * przestaje czytać z połączenia */
+
+
+/**
+ * Rosnący bufor bajtów.
+ */
+typedef struct byte_buffer {
+	char *data; 		///< zawartość bufora
+	size_t length; 		///< liczba zajętych bajtów
+	size_t capacity; 	///< rozmiar zaalokowanej pamięci
+} byte_buffer_t;
+
+/**
+ * Stan jednego połączenia. Pola chronione blokadą są współdzielone przez pętlę
+ * zdarzeń i wątek roboczy, pozostałe należą wyłącznie do jednego z nich.
+ */
+typedef struct connection {
+	int fd; 					///< deskryptor gniazda połączenia
+	uint32_t worker; 			///< numer wątku roboczego obsługującego połączenie
+	pthread_mutex_t lock; 		///< blokada chroniąca pola współdzielone
+	byte_buffer_t incoming; 	///< przeczytane bajty (chronione blokadą)
+	byte_buffer_t outgoing; 	///< odpowiedzi do wysłania (chronione blokadą)
+	bool scheduled; 			/**< informacja czy połączenie czeka w kolejce
+ * 								wątku roboczego lub jest przez niego
+ * 								obsługiwane (chronione blokadą) */
+	bool input_closed; 			/**< informacja czy nie będzie już nowych
+ * 								danych (chronione blokadą) */
+	bool finished; 				/**< informacja czy wątek roboczy przetworzył
+ * 								wszystkie dane (chronione blokadą) */
+	bool announced; 			/**< informacja czy połączenie jest na liście
+ * 								gotowych (chronione blokadą) */
+	struct connection *next_ready; ///< następny element listy gotowych
+	byte_buffer_t sending; 		///< odpowiedzi wysyłane przez pętlę zdarzeń
+	size_t sent; 				///< liczba wysłanych bajtów z bufora sending
+	uint32_t events; 			/**< zdarzenia zarejestrowane w epoll, 0 jeśli
+ * 								gniazdo nie jest zarejestrowane */
+	bool dead; 					///< informacja czy wysyłanie się nie powiodło
+	bool removed; 				/**< informacja czy połączenie zostało zamknięte
+ * 								i czeka na zwolnienie pamięci */
+	struct connection *previous; ///< poprzedni element listy wszystkich połączeń
+	struct connection *next; 	///< następny element listy wszystkich połączeń
+	byte_buffer_t pending; 		///< nieprzetworzone bajty wątku roboczego
+	byte_buffer_t answers; 		///< odpowiedzi zebrane przez wątek roboczy
+	reading_mode_t mode; 		///< tryb, w którym czytane są linijki
+	gamma_t *g; 				///< gra lub NULL, jeśli jeszcze nie utworzona
+	int counter; 				///< liczba przeczytanych linijek
+	uint32_t quiet_lines; 		///< liczba linijek pozostałych w bloku cichym
+	bool broken; 				///< informacja czy zabrakło pamięci na odpowiedzi
+} connection_t;
+
+typedef struct server server_t;
+
+/**
+ * Stan jednego wątku roboczego.
+ */
+typedef struct worker {
+	pthread_t thread; 		///< wątek roboczy
+	ring_buffer_t jobs; 	///< kolejka połączeń z danymi do przetworzenia
+	server_t *server; 		///< serwer, do którego należy wątek
+} worker_t;
+
+/**
+ * Stan serwera.
+ */
+struct server {
+	int listener; 			///< deskryptor gniazda nasłuchującego
+	int wakeup; 			///< deskryptor eventfd budzący pętlę zdarzeń
+	int signals; 			///< deskryptor signalfd kończący pracę serwera
+	int epoll; 				///< deskryptor epoll
+	worker_t *pool; 		///< wątki robocze
+	uint32_t workers; 		///< liczba uruchomionych wątków roboczych
+	uint32_t next_worker; 	///< wątek, który dostanie kolejne połączenie
+	connection_t *connections; ///< lista wszystkich otwartych połączeń
+	connection_t *removed; 	/**< lista zamkniętych połączeń, których pamięć
+ * 							zostanie zwolniona po obsłużeniu bieżących
+ * 							zdarzeń */
+	pthread_mutex_t ready_lock; ///< blokada chroniąca listę gotowych połączeń
+	connection_t *ready; 	/**< lista połączeń, w których wątki robocze
+ * 							zmieniły stan */
+};
+
+
+static bool reserve(byte_buffer_t *buffer, size_t extra);
+
+static bool append_bytes(byte_buffer_t *buffer, const char *data, size_t length);
+
+static void swap_buffers(byte_buffer_t *first, byte_buffer_t *second);
+
+static void add_line(connection_t *c, const char *prefix, size_t prefix_length,
+                     uint64_t value);
+
+static void add_image_part(void *context, const char *data, size_t length);
+
+static void execute_line(connection_t *c, const char *line, size_t length);
+
+static void process_lines(connection_t *c, bool closed);
+
+static void serve_connection(server_t *server, connection_t *c);
+
+static void* worker_thread(void *arg);
+
+static void schedule(server_t *server, connection_t *c);
+
+static void receive(server_t *server, connection_t *c);
+
+static void transmit(connection_t *c);
+
+static void destroy_connection(connection_t *c);
+
+static void remove_connection(server_t *server, connection_t *c);
+
+static void update_connection(server_t *server, connection_t *c);
+
+static void accept_connections(server_t *server);
+
+static void handle_ready(server_t *server);
+
+static bool add_descriptor(int epoll, int fd, void *tag);
+
+static int open_listener(const char *path);
+
+static void event_loop(server_t *server);
+
+
+/** @brief Zapewnia miejsce w buforze.
+ * @param[in,out] buffer 	- wskaźnik na bufor,
+ * @param[in] extra 		- liczba bajtów, które mają zmieścić się za
+ * 							zajętą częścią bufora.
+ * @return Wartość @p true, jeśli w buforze jest miejsce lub @p false, jeśli
+ * zabrakło pamięci.
+ */
+bool reserve(byte_buffer_t *buffer, size_t extra) {
+	if(buffer->capacity - buffer->length >= extra) {
+		return true;
+	}
+	size_t capacity = buffer->capacity ? buffer->capacity : READ_SIZE;
+	while(capacity - buffer->length < extra) {
+		capacity *= 2;
+	}
+	char *data = realloc(buffer->data, capacity);
+	if(!data) {
+		return false;
+	}
+	buffer->data = data;
+	buffer->capacity = capacity;
+	return true;
+}
+
+/** @brief Dopisuje bajty na koniec bufora.
+ * @param[in,out] buffer 	- wskaźnik na bufor,
+ * @param[in] data 			- wskaźnik na dopisywane bajty,
+ * @param[in] length 		- liczba dopisywanych bajtów.
+ * @return Wartość @p true, jeśli dopisano bajty lub @p false, jeśli zabrakło
+ * pamięci.
+ */
+bool append_bytes(byte_buffer_t *buffer, const char *data, size_t length) {
+	if(length == 0) {
+		return true;
+	}
+	if(!reserve(buffer, length)) {
+		return false;
+	}
+	memcpy(buffer->data + buffer->length, data, length);
+	buffer->length += length;
+	return true;
+}
+
+/** @brief Zamienia zawartość dwóch buforów.
+ * @param[in,out] first 	- wskaźnik na pierwszy bufor,
+ * @param[in,out] second 	- wskaźnik na drugi bufor.
+ */
+void swap_buffers(byte_buffer_t *first, byte_buffer_t *second) {
+	byte_buffer_t temporary = *first;
+	*first = *second;
+	*second = temporary;
+}
+
+/** @brief Dopisuje linijkę z liczbą do odpowiedzi połączenia.
+ * @param[in,out] c 			- wskaźnik na połączenie,
+ * @param[in] prefix 			- tekst poprzedzający liczbę,
+ * @param[in] prefix_length 	- długość tekstu poprzedzającego liczbę,
+ * @param[in] value 			- liczba.
+ */
+void add_line(connection_t *c, const char *prefix, size_t prefix_length,
+              uint64_t value) {
+	char line[UINT64_LIMIT + 16];
+	memcpy(line, prefix, prefix_length);
+	size_t length = prefix_length + format_number(line + prefix_length, value);
+	line[length++] = '\n';
+	if(!append_bytes(&c->answers, line, length)) {
+		c->broken = true;
+	}
+}
+
+/** @brief Dopisuje fragment obrazu lub odpowiedzi na polecenie B, F albo Q
+ * do odpowiedzi połączenia.
+ * @param[in,out] context 	- wskaźnik na połączenie,
+ * @param[in] data 			- wskaźnik na fragment,
+ * @param[in] length 		- długość fragmentu.
+ */
+void add_image_part(void *context, const char *data, size_t length) {
+	connection_t *c = context;
+	if(!append_bytes(&c->answers, data, length)) {
+		c->broken = true;
+	}
+}
+
+/** @brief Wykonuje jedną linijkę przeczytaną z połączenia.
+ * @param[in,out] c 	- wskaźnik na połączenie,
+ * @param[in] line 		- wskaźnik na początek linijki (bez znaku nowej linii),
+ * @param[in] length 	- długość linijki.
+ */
+void execute_line(connection_t *c, const char *line, size_t length) {
+	command_t command;
+	line_type_t type = parse_line(line, length, c->mode, &command);
+	if(type == EMPTY_LINE) {
+		return;
+	}
+	bool quiet = quiet_line(&c->quiet_lines);
+	if(type == COMMAND_LINE && c->mode == FIRST_COMMAND_READING) {
+		uint32_t *args = command.args;
+		if(command.name == 'B') {
+			c->g = gamma_new(args[0], args[1], args[2], args[3]);
+		}
+		if(c->g != NULL) {
+			c->mode = BATCH_READING;
+			add_line(c, "OK ", 3, (uint64_t)c->counter);
+			return;
+		}
+		type = INVALID_LINE;
+	}
+	if(type == INVALID_LINE) {
+		add_line(c, "ERROR ", 6, (uint64_t)c->counter);
+	}
+	else if(command.name == 's') {
+		c->quiet_lines = command.args[0];
+	}
+	else if(player_query(command.name)) {
+		write_player_query(command, c->g, add_image_part, c);
+	}
+	else if(bulk_command(command.name)) {
+		size_t length;
+		char *answer = call_bulk_function(command, c->g, &length);
+		if(answer == NULL) {
+			add_line(c, "", 0, 0);
+		}
+		else {
+			if(!append_bytes(&c->answers, answer, length)) {
+				c->broken = true;
+			}
+			free(answer);
+		}
+		free(command.list);
+	}
+	else if(command.name == 'e') {
+		if(!export_image(c->g, command.args[0], command.args[1], add_image_part,
+		                 c)) {
+			add_line(c, "", 0, 0);
+		}
+	}
+	else if(command.name == 'p' || command.name == 'r') {
+		size_t length;
+		char *board = call_board_function(command.name, c->g, &length);
+		if(board == NULL) {
+			add_line(c, "", 0, 0);
+		}
+		else {
+			if(!append_bytes(&c->answers, board, length)) {
+				c->broken = true;
+			}
+			free(board);
+		}
+	}
+	else {
+		uint64_t answer = call_function(command, c->g);
+		if(!quiet || (command.name != 'm' && command.name != 'g')) {
+			add_line(c, "", 0, answer);
+		}
+		else if(!answer) {
+			add_line(c, "REJECTED ", 9, (uint64_t)c->counter);
+		}
+	}
+}
+
+/** @brief Wykonuje wszystkie pełne linijki przeczytane z połączenia.
+ * Niepełna linijka zostaje w buforze do czasu przeczytania jej końca.
+ * @param[in,out] c 	- wskaźnik na połączenie,
+ * @param[in] closed 	- informacja czy to już wszystkie dane; niepełna
+ * 						linijka na końcu danych, która nie jest pusta ani nie
+ * 						jest komentarzem, jest nieprawidłowa.
+ */
+void process_lines(connection_t *c, bool closed) {
+	const char *position = c->pending.data;
+	const char *end = position + c->pending.length;
+	while(position != end && !c->broken) {
+		const char *newline = memchr(position, '\n', (size_t)(end - position));
+		if(newline == NULL) {
+			break;
+		}
+		c->counter++;
+		execute_line(c, position, (size_t)(newline - position));
+		position = newline + 1;
+	}
+	if(closed && position != end && !c->broken) {
+		c->counter++;
+		if(position[0] != '#') {
+			add_line(c, "ERROR ", 6, (uint64_t)c->counter);
+		}
+		position = end;
+	}
+	c->pending.length = (size_t)(end - position);
+	if(c->pending.length > 0) {
+		memmove(c->pending.data, position, c->pending.length);
+	}
+}
+
+/** @brief Przetwarza dane połączenia przekazanego do wątku roboczego.
+ * Dopóki w połączeniu pojawiają się nowe dane, przenosi je do swojego bufora,
+ * wykonuje polecenia i przekazuje odpowiedzi pętli zdarzeń. Gdy wątek
+ * przetworzy wszystkie dane zamkniętego połączenia, usuwa grę i oznacza
+ * połączenie jako zakończone; od tej chwili nie korzysta już z połączenia.
+ * @param[in,out] server 	- wskaźnik na stan serwera,
+ * @param[in,out] c 		- wskaźnik na połączenie.
+ */
+void serve_connection(server_t *server, connection_t *c) {
+	bool done = false;
+	while(!done) {
+		pthread_mutex_lock(&c->lock);
+		if(!append_bytes(&c->pending, c->incoming.data, c->incoming.length)) {
+			c->broken = true;
+		}
+		c->incoming.length = 0;
+		bool closed = c->input_closed;
+		pthread_mutex_unlock(&c->lock);
+
+		process_lines(c, closed);
+		bool finished = closed || c->broken;
+		if(finished) {
+			gamma_delete(c->g);
+			c->g = NULL;
+		}
+
+		pthread_mutex_lock(&c->lock);
+		if(c->outgoing.length == 0) {
+			swap_buffers(&c->outgoing, &c->answers);
+		}
+		else if(!append_bytes(&c->outgoing, c->answers.data, c->answers.length)) {
+			c->broken = finished = true;
+		}
+		c->answers.length = 0;
+		done = finished || (c->incoming.length == 0 && !c->input_closed);
+		if(done) {
+			c->scheduled = false;
+			c->finished = finished;
+		}
+		bool announce = !c->announced;
+		c->announced = true;
+		pthread_mutex_unlock(&c->lock);
+
+		if(announce) {
+			pthread_mutex_lock(&server->ready_lock);
+			c->next_ready = server->ready;
+			server->ready = c;
+			pthread_mutex_unlock(&server->ready_lock);
+			uint64_t one = 1;
+			while(write(server->wakeup, &one, sizeof(one)) < 0 && errno == EINTR);
+		}
+	}
+}
+
+/** @brief Obsługuje połączenia przekazane do wątku.
+ * Wątek kończy pracę po otrzymaniu wskaźnika NULL.
+ * @param[in,out] arg 	- wskaźnik na stan wątku (@ref worker_t).
+ * @return Wartość NULL.
+ */
+void* worker_thread(void *arg) {
+	worker_t *worker = arg;
+	connection_t *c;
+	for(;;) {
+		ring_buffer_pop(&worker->jobs, &c);
+		if(c == NULL) {
+			break;
+		}
+		serve_connection(worker->server, c);
+	}
+	return NULL;
+}
+
+/** @brief Przekazuje połączenie do wątku roboczego, o ile to potrzebne.
+ * Połączenie jest przekazywane, jeśli ma nowe dane lub zostało zamknięte,
+ * a nie jest już obsługiwane przez wątek roboczy. Wywoływana z założoną
+ * blokadą połączenia.
+ * @param[in,out] server 	- wskaźnik na stan serwera,
+ * @param[in,out] c 		- wskaźnik na połączenie.
+ */
+void schedule(server_t *server, connection_t *c) {
+	if(!c->scheduled && !c->finished
+	   && (c->incoming.length > 0 || c->input_closed)) {
+		c->scheduled = true;
+		ring_buffer_push(&server->pool[c->worker].jobs, &c);
+	}
+}
+
+/** @brief Czyta dostępne dane z połączenia.
+ * Czyta, dopóki gniazdo ma dane, ale nie więcej niż @ref INPUT_LIMIT
+ * nieprzetworzonych bajtów. Koniec danych, błąd gniazda i brak pamięci
+ * zamykają wejście połączenia.
+ * @param[in,out] server 	- wskaźnik na stan serwera,
+ * @param[in,out] c 		- wskaźnik na połączenie.
+ */
+void receive(server_t *server, connection_t *c) {
+	pthread_mutex_lock(&c->lock);
+	while(!c->input_closed && c->incoming.length < INPUT_LIMIT) {
+		if(!reserve(&c->incoming, READ_SIZE)) {
+			c->input_closed = true;
+			break;
+		}
+		ssize_t result = read(c->fd, c->incoming.data + c->incoming.length,
+		                      c->incoming.capacity - c->incoming.length);
+		if(result > 0) {
+			c->incoming.length += (size_t)result;
+		}
+		else if(result < 0 && errno == EINTR) {
+			continue;
+		}
+		else {
+			if(result == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+				c->input_closed = true;
+			}
+			break;
+		}
+	}
+	schedule(server, c);
+	pthread_mutex_unlock(&c->lock);
+}
+
+/** @brief Wysyła odpowiedzi czekające w połączeniu.
+ * Wysyła, dopóki gniazdo przyjmuje dane. Jeśli wysyłanie się nie powiedzie,
+ * odpowiedzi są od tej pory odrzucane.
+ * @param[in,out] c 	- wskaźnik na połączenie.
+ */
+void transmit(connection_t *c) {
+	for(;;) {
+		if(c->sent == c->sending.length) {
+			c->sending.length = c->sent = 0;
+			pthread_mutex_lock(&c->lock);
+			swap_buffers(&c->sending, &c->outgoing);
+			if(c->dead) {
+				c->sending.length = 0;
+			}
+			pthread_mutex_unlock(&c->lock);
+			if(c->sending.length == 0) {
+				return;
+			}
+		}
+		ssize_t result = send(c->fd, c->sending.data + c->sent,
+		                      c->sending.length - c->sent, MSG_NOSIGNAL);
+		if(result >= 0) {
+			c->sent += (size_t)result;
+		}
+		else if(errno != EINTR) {
+			if(errno != EAGAIN && errno != EWOULDBLOCK) {
+				c->dead = true;
+				c->sent = c->sending.length;
+				continue;
+			}
+			return;
+		}
+	}
+}
+
+/** @brief Zwalnia pamięć połączenia.
+ * @param[in,out] c 		- wskaźnik na połączenie, które nie jest obsługiwane
+ * 							przez żaden wątek roboczy.
+ */
+void destroy_connection(connection_t *c) {
+	gamma_delete(c->g);
+	free(c->incoming.data);
+	free(c->outgoing.data);
+	free(c->sending.data);
+	free(c->pending.data);
+	free(c->answers.data);
+	pthread_mutex_destroy(&c->lock);
+	free(c);
+}
+
+/** @brief Zamyka połączenie.
+ * Pamięć połączenia jest zwalniana dopiero po obsłużeniu wszystkich zdarzeń
+ * pobranych razem ze zdarzeniem, które je zamknęło, bo mogą one dotyczyć
+ * tego samego połączenia.
+ * @param[in,out] server 	- wskaźnik na stan serwera,
+ * @param[in,out] c 		- wskaźnik na połączenie, które nie jest obsługiwane
+ * 							przez żaden wątek roboczy.
+ */
+void remove_connection(server_t *server, connection_t *c) {
+	close(c->fd);
+	if(c->previous) {
+		c->previous->next = c->next;
+	}
+	else {
+		server->connections = c->next;
+	}
+	if(c->next) {
+		c->next->previous = c->previous;
+	}
+	c->removed = true;
+	c->next = server->removed;
+	server->removed = c;
+}
+
+/** @brief Wysyła odpowiedzi i uaktualnia zdarzenia obserwowane dla połączenia.
+ * Zamyka połączenie, jeśli wątek roboczy je zakończył, a wszystkie odpowiedzi
+ * zostały wysłane. Czytanie jest wstrzymywane, gdy połączenie ma zbyt wiele
+ * nieprzetworzonych danych lub niewysłanych odpowiedzi.
+ * @param[in,out] server 	- wskaźnik na stan serwera,
+ * @param[in,out] c 		- wskaźnik na połączenie.
+ */
+void update_connection(server_t *server, connection_t *c) {
+	if(c->removed) {
+		return;
+	}
+	transmit(c);
+	pthread_mutex_lock(&c->lock);
+	if(c->dead && !c->input_closed) {
+		c->input_closed = true;
+		schedule(server, c);
+	}
+	bool removable = c->finished && !c->announced && c->outgoing.length == 0;
+	bool readable = !c->input_closed && c->incoming.length < INPUT_LIMIT
+	                && c->outgoing.length < OUTPUT_LIMIT;
+	pthread_mutex_unlock(&c->lock);
+	bool writable = (c->sent < c->sending.length);
+	if(removable && !writable) {
+		remove_connection(server, c);
+		return;
+	}
+	uint32_t events = (readable ? EPOLLIN : 0) | (writable ? EPOLLOUT : 0);
+	if(events == c->events) {
+		return;
+	}
+	struct epoll_event event;
+	event.events = events;
+	event.data.ptr = c;
+	if(events == 0) {
+		epoll_ctl(server->epoll, EPOLL_CTL_DEL, c->fd, NULL);
+	}
+	else {
+		epoll_ctl(server->epoll, c->events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+		          c->fd, &event);
+	}
+	c->events = events;
+}
+
+/** @brief Przyjmuje oczekujące połączenia.
+ * Połączenia są przydzielane wątkom roboczym po kolei.
+ * @param[in,out] server 	- wskaźnik na stan serwera.
+ */
+void accept_connections(server_t *server) {
+	for(;;) {
+		int fd = accept4(server->listener, NULL, NULL,
+		                 SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if(fd < 0) {
+			if(errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			return;
+		}
+		connection_t *c = calloc(1, sizeof(connection_t));
+		if(!c) {
+			close(fd);
+			continue;
+		}
+		c->fd = fd;
+		c->mode = FIRST_COMMAND_READING;
+		c->worker = server->next_worker;
+		server->next_worker = (server->next_worker + 1) % server->workers;
+		pthread_mutex_init(&c->lock, NULL);
+		c->next = server->connections;
+		if(c->next) {
+			c->next->previous = c;
+		}
+		server->connections = c;
+		update_connection(server, c);
+	}
+}
+
+/** @brief Obsługuje połączenia, w których wątki robocze zmieniły stan.
+ * @param[in,out] server 	- wskaźnik na stan serwera.
+ */
+void handle_ready(server_t *server) {
+	uint64_t count;
+	while(read(server->wakeup, &count, sizeof(count)) < 0 && errno == EINTR);
+	pthread_mutex_lock(&server->ready_lock);
+	connection_t *c = server->ready;
+	server->ready = NULL;
+	pthread_mutex_unlock(&server->ready_lock);
+	while(c != NULL) {
+		connection_t *next = c->next_ready;
+		pthread_mutex_lock(&c->lock);
+		c->announced = false;
+		pthread_mutex_unlock(&c->lock);
+		update_connection(server, c);
+		c = next;
+	}
+}
+
+/** @brief Rejestruje w epoll deskryptor obserwowany przez cały czas pracy.
+ * @param[in] epoll 	- deskryptor epoll,
+ * @param[in] fd 		- rejestrowany deskryptor,
+ * @param[in] tag 		- wskaźnik identyfikujący zdarzenia deskryptora.
+ * @return Wartość @p true, jeśli się udało lub @p false w przeciwnym wypadku.
+ */
+bool add_descriptor(int epoll, int fd, void *tag) {
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = tag;
+	return epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+/** @brief Tworzy nieblokujące gniazdo nasłuchujące.
+ * Gniazdo pozostawione pod tą samą ścieżką przez poprzedni serwer jest
+ * usuwane, inne pliki nie są nadpisywane.
+ * @param[in] path 		- ścieżka gniazda.
+ * @return Deskryptor gniazda lub -1, jeśli nie udało się go utworzyć.
+ */
+int open_listener(const char *path) {
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(strlen(path) >= sizeof(address.sun_path)) {
+		return -1;
+	}
+	strcpy(address.sun_path, path);
+	struct stat status;
+	if(lstat(path, &status) == 0 && S_ISSOCK(status.st_mode)) {
+		unlink(path);
+	}
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(fd < 0) {
+		return -1;
+	}
+	if(bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0
+	   || listen(fd, SOMAXCONN) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/** @brief Główna pętla zdarzeń serwera.
+ * Działa do momentu otrzymania sygnału kończącego pracę.
+ * @param[in,out] server 	- wskaźnik na stan serwera.
+ */
+void event_loop(server_t *server) {
+	struct epoll_event events[MAX_EVENTS];
+	bool running = true;
+	while(running) {
+		int count = epoll_wait(server->epoll, events, MAX_EVENTS, -1);
+		if(count < 0 && errno != EINTR) {
+			break;
+		}
+		for(int i = 0; i < count; i++) {
+			void *tag = events[i].data.ptr;
+			if(tag == &server->listener) {
+				accept_connections(server);
+			}
+			else if(tag == &server->wakeup) {
+				handle_ready(server);
+			}
+			else if(tag == &server->signals) {
+				struct signalfd_siginfo information;
+				while(read(server->signals, &information, sizeof(information)) < 0
+				      && errno == EINTR);
+				running = false;
+			}
+			else {
+				connection_t *c = tag;
+				if(!c->removed
+				   && (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) {
+					receive(server, c);
+				}
+				update_connection(server, c);
+			}
+		}
+		while(server->removed != NULL) {
+			connection_t *c = server->removed;
+			server->removed = c->next;
+			destroy_connection(c);
+		}
+	}
+}
+
+
+int server_mode(const char *path, uint32_t workers) {
+	if(workers == 0) {
+		long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		workers = processors > 0 ? (uint32_t)processors : 1;
+	}
+	if(workers > MAX_WORKERS) {
+		workers = MAX_WORKERS;
+	}
+	server_t server;
+	memset(&server, 0, sizeof(server));
+	pthread_mutex_init(&server.ready_lock, NULL);
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+	server.listener = open_listener(path);
+	server.wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	server.signals = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+	server.epoll = epoll_create1(EPOLL_CLOEXEC);
+	server.pool = calloc(workers, sizeof(worker_t));
+	bool correct = server.listener >= 0 && server.wakeup >= 0
+	               && server.signals >= 0 && server.epoll >= 0 && server.pool
+	               && add_descriptor(server.epoll, server.listener, &server.listener)
+	               && add_descriptor(server.epoll, server.wakeup, &server.wakeup)
+	               && add_descriptor(server.epoll, server.signals, &server.signals);
+	while(correct && server.workers < workers) {
+		worker_t *worker = &server.pool[server.workers];
+		worker->server = &server;
+		if(!init_ring_buffer(&worker->jobs, WORKER_QUEUE_CAPACITY,
+		                     sizeof(connection_t *))) {
+			break;
+		}
+		if(pthread_create(&worker->thread, NULL, worker_thread, worker) != 0) {
+			delete_ring_buffer(&worker->jobs);
+			break;
+		}
+		server.workers++;
+	}
+	correct = correct && server.workers > 0;
+
+	if(correct) {
+		event_loop(&server);
+	}
+	connection_t *last = NULL;
+	for(uint32_t i = 0; i < server.workers; i++) {
+		ring_buffer_push(&server.pool[i].jobs, &last);
+	}
+	for(uint32_t i = 0; i < server.workers; i++) {
+		pthread_join(server.pool[i].thread, NULL);
+		delete_ring_buffer(&server.pool[i].jobs);
+	}
+	while(server.connections != NULL) {
+		connection_t *c = server.connections;
+		server.connections = c->next;
+		close(c->fd);
+		destroy_connection(c);
+	}
+	int descriptors[] = {server.listener, server.wakeup, server.signals,
+	                     server.epoll};
+	for(size_t i = 0; i < sizeof(descriptors) / sizeof(int); i++) {
+		if(descriptors[i] >= 0) {
+			close(descriptors[i]);
+		}
+	}
+	if(server.listener >= 0) {
+		unlink(path);
+	}
+	free(server.pool);
+	pthread_mutex_destroy(&server.ready_lock);
+	pthread_sigmask(SIG_UNBLOCK, &signals, NULL);
+	return !correct;
+}
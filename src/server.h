@@ -0,0 +1,34 @@
+/** @file
+ * Interfejs trybu serwera gier.
+ * Serwer nasłuchuje na gnieździe domeny UNIX i obsługuje dowolną liczbę
+ * połączeń naraz. Każde połączenie to osobna gra: klient wysyła polecenie
+ * B width height players areas, a po odpowiedzi "OK n" kolejne polecenia
+ * trybu wsadowego. Odpowiedzi i komunikaty "ERROR n" trafiają do tego samego
+ * połączenia, w kolejności poleceń. Linijki są numerowane osobno dla każdego
+ * połączenia. Polecenia I, M i X nie są obsługiwane i powodują błąd.
+ * Wejście i wyjście połączeń obsługuje jeden wątek z pętlą epoll, a polecenia
+ * wykonuje stała pula wątków roboczych. Wszystkie polecenia jednego połączenia
+ * wykonuje ten sam wątek roboczy.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdint.h>
+
+
+/** @brief Obsługuje tryb serwera gier.
+ * Tworzy gniazdo o podanej ścieżce (zastępując pozostawione wcześniej
+ * gniazdo) i obsługuje połączenia aż do otrzymania sygnału SIGINT lub
+ * SIGTERM. Na koniec zamyka wszystkie połączenia i usuwa gniazdo.
+ * @param[in] path 		- ścieżka gniazda,
+ * @param[in] workers 	- liczba wątków roboczych, wartość 0 oznacza
+ * 						liczbę dostępnych procesorów.
+ * @return Wartość 0, jeśli serwer zakończył działanie prawidłowo lub 1, jeśli
+ * nie udało się go uruchomić.
+ */
+int server_mode(const char *path, uint32_t workers);
+
+#endif /* SERVER_H */
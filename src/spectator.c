@@ -0,0 +1,210 @@
+/** @file
+ * Implementacja klasy publikującej zmiany planszy dla obserwatorów.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include "spectator.h"
+#include "gamma.h"
+#include "input.h"
+#include "output.h"
+#include "interactive_mode.h"
+
+
+#define STREAM_BUFFER_SIZE (1 << 16) ///< rozmiar bufora publikowanych zmian
+
+#define STREAM_MAGIC "GAMMADLT" ///< napis rozpoczynający strumień zmian
+
+#define STREAM_MAGIC_LENGTH 8 ///< długość napisu rozpoczynającego strumień
+
+#define RECORD_LIMIT (4 * VARINT_LIMIT) ///< maksymalna długość jednego rekordu
+
+
+/**
+ * Stan publikowanego strumienia zmian.
+ */
+typedef struct spectator_stream {
+	int fd; 				///< deskryptor pliku lub potoku albo -1
+	uint64_t moves; 		///< liczba opublikowanych ruchów
+	size_t length; 			///< liczba zajętych bajtów bufora
+	char data[STREAM_BUFFER_SIZE]; ///< bufor z danymi do zapisania
+} spectator_stream_t;
+
+/**
+ * Stan gry odtwarzanej w trybie obserwatora.
+ */
+typedef struct watched_game {
+	gamma_t *g; 		///< odtwarzana gra
+	uint64_t moves; 	///< liczba odtworzonych ruchów
+	uint32_t player; 	///< gracz, który wykonał ostatni ruch lub 0
+	uint32_t x; 		///< współrzędna x ostatnio zmienionego pola
+	uint32_t y; 		///< współrzędna y ostatnio zmienionego pola
+} watched_game_t;
+
+
+static spectator_stream_t stream = {-1, 0, 0, {0}}; ///< publikowany strumień
+
+static watched_game_t watched = {NULL, 0, 0, 0, 0}; ///< obserwowana gra
+
+
+static void append_number(uint64_t value);
+
+static bool apply_change(uint32_t player, uint32_t x, uint32_t y);
+
+static void show_watched_game(void);
+
+
+/** @brief Dopisuje liczbę do bufora w kodowaniu varint.
+ * Wywołujący zapewnia, że w buforze jest miejsce.
+ * @param[in] value 	- zapisywana liczba.
+ */
+void append_number(uint64_t value) {
+	stream.length += format_varint(stream.data + stream.length, value);
+}
+
+/** @brief Odtwarza zmianę pola w obserwowanej grze.
+ * Wolne pole mogło zostać zajęte tylko zwykłym ruchem, a zajęte tylko złotym
+ * ruchem, więc rodzaj ruchu nie musi być zapisany w strumieniu.
+ * @param[in] player 	- numer gracza, który zajął pole,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola.
+ * @return Wartość @p true, jeśli ruch jest poprawny lub @p false
+ * w przeciwnym wypadku.
+ */
+bool apply_change(uint32_t player, uint32_t x, uint32_t y) {
+	if(gamma_field_owner(watched.g, x, y) == 0) {
+		return gamma_move(watched.g, player, x, y);
+	}
+	return gamma_golden_move(watched.g, player, x, y);
+}
+
+/** @brief Wyświetla obserwowaną grę.
+ * Wywoływana, zanim obserwator zacznie czekać na kolejne dane, więc klatka
+ * jest wyświetlana raz dla całego przeczytanego bloku zmian.
+ */
+void show_watched_game(void) {
+	flush_output();
+	show_spectator_frame(watched.g, watched.x, watched.y, watched.player,
+	                     watched.moves);
+}
+
+
+bool open_spectator_stream(const char *path, uint32_t width, uint32_t height,
+                           uint32_t players, uint32_t areas) {
+	signal(SIGPIPE, SIG_IGN);
+	stream.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(stream.fd < 0) {
+		return false;
+	}
+	stream.moves = 0;
+	memcpy(stream.data, STREAM_MAGIC, STREAM_MAGIC_LENGTH);
+	stream.length = STREAM_MAGIC_LENGTH;
+	append_number(width);
+	append_number(height);
+	append_number(players);
+	append_number(areas);
+	flush_spectator_stream();
+	return true;
+}
+
+void publish_move(char opcode, uint32_t player, uint32_t x, uint32_t y) {
+	if(stream.fd < 0 || (opcode != 'm' && opcode != 'g')) {
+		return;
+	}
+	if(stream.length + RECORD_LIMIT > STREAM_BUFFER_SIZE) {
+		flush_spectator_stream();
+	}
+	append_number(++stream.moves);
+	append_number(x);
+	append_number(y);
+	append_number(player);
+}
+
+void flush_spectator_stream(void) {
+	if(stream.fd >= 0 && !write_all(stream.fd, stream.data, stream.length)) {
+		close(stream.fd);
+		stream.fd = -1;
+	}
+	stream.length = 0;
+}
+
+void close_spectator_stream(void) {
+	if(stream.fd < 0) {
+		return;
+	}
+	flush_spectator_stream();
+	if(stream.fd >= 0) {
+		close(stream.fd);
+		stream.fd = -1;
+	}
+}
+
+int viewer_mode(const char *path) {
+	int fd = open(path, O_RDONLY);
+	input_t input;
+	if(fd < 0) {
+		print_error(0);
+		flush_output();
+		return 1;
+	}
+	if(!init_input(&input, fd)) {
+		close(fd);
+		return 1;
+	}
+	bool live = isatty(STDOUT_FILENO);
+	bool correct = true;
+	for(int i = 0; i < STREAM_MAGIC_LENGTH && correct; i++) {
+		correct = (next_char(&input) == STREAM_MAGIC[i]);
+	}
+	uint32_t width = 0, height = 0, players = 0, areas = 0;
+	correct = correct && next_uint32(&input, &width)
+	          && next_uint32(&input, &height) && next_uint32(&input, &players)
+	          && next_uint32(&input, &areas);
+	watched.g = correct ? gamma_new(width, height, players, areas) : NULL;
+	watched.moves = 0;
+	watched.player = watched.x = 0;
+	watched.y = height > 0 ? height - 1 : 0;
+	correct = (watched.g != NULL);
+	if(correct && live) {
+		input.before_read = show_watched_game;
+	}
+	uint64_t records = 0;
+	while(correct && !end_of_input(&input)) {
+		records++;
+		uint64_t number;
+		uint32_t x, y, player;
+		correct = next_varint(&input, &number) && number == watched.moves + 1
+		          && next_uint32(&input, &x) && next_uint32(&input, &y)
+		          && next_uint32(&input, &player) && apply_change(player, x, y);
+		if(correct) {
+			watched.moves = number;
+			watched.player = player;
+			watched.x = x;
+			watched.y = y;
+		}
+	}
+	if(watched.g != NULL && live) {
+		close_spectator_view(watched.g);
+	}
+	if(!correct) {
+		print_error(records > INT32_MAX ? INT32_MAX : (int)records);
+	}
+	else if(!live) {
+		char *board = gamma_board(watched.g);
+		if(board != NULL) {
+			print_text(board, strlen(board));
+			free(board);
+		}
+	}
+	flush_output();
+	gamma_delete(watched.g);
+	watched.g = NULL;
+	close_input(&input);
+	close(fd);
+	return !correct;
+}
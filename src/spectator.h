@@ -0,0 +1,74 @@
+/** @file
+ * Interfejs klasy publikującej zmiany planszy dla obserwatorów.
+ * Strumień zmian jest zapisywany do pliku lub potoku nazwanego (FIFO),
+ * z którego może go czytać program uruchomiony w trybie obserwatora.
+ * Koszt publikacji jest stały dla każdego ruchu, niezależnie od rozmiaru
+ * planszy. Strumień zaczyna się nagłówkiem: 8 bajtów "GAMMADLT", a po nich
+ * liczby width, height, players, areas. Dalej następują rekordy, po jednym na
+ * każdy przyjęty ruch, złożone z liczb: numer ruchu (od 1), współrzędne x i y
+ * zmienionego pola oraz numer gracza, który teraz je zajmuje. Liczby są
+ * zapisywane w kodowaniu varint.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef SPECTATOR_H
+#define SPECTATOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+
+/** @brief Rozpoczyna publikowanie zmian planszy.
+ * Otwiera plik lub potok nazwany (tworząc plik, jeśli nie istnieje)
+ * i zapisuje nagłówek. Otwarcie potoku czeka, aż obserwator otworzy go do
+ * czytania. Od tej chwili sygnał SIGPIPE jest ignorowany, a gdy obserwator
+ * zamknie potok, zmiany przestają być publikowane.
+ * @param[in] path 		- ścieżka pliku lub potoku,
+ * @param[in] width 	- szerokość planszy,
+ * @param[in] height 	- wysokość planszy,
+ * @param[in] players 	- liczba graczy,
+ * @param[in] areas 	- maksymalna liczba obszarów jednego gracza.
+ * @return Wartość @p true, jeśli udało się otworzyć plik lub @p false
+ * w przeciwnym wypadku.
+ */
+bool open_spectator_stream(const char *path, uint32_t width, uint32_t height,
+                           uint32_t players, uint32_t areas);
+
+/** @brief Publikuje zmianę pola po przyjętym ruchu.
+ * Rekord trafia do bufora, który jest zapisywany, gdy się zapełni lub
+ * po wywołaniu @ref flush_spectator_stream. Nie robi nic, jeśli zmiany nie są
+ * publikowane lub kod polecenia nie oznacza ruchu.
+ * @param[in] opcode 	- kod polecenia, m lub g,
+ * @param[in] player 	- numer gracza, który zajął pole,
+ * @param[in] x 		- współrzędna pozioma pola,
+ * @param[in] y 		- współrzędna pionowa pola.
+ */
+void publish_move(char opcode, uint32_t player, uint32_t x, uint32_t y);
+
+/** @brief Zapisuje opublikowane zmiany do pliku lub potoku.
+ * Wywoływana, zanim program zacznie czekać na kolejne polecenia, dzięki czemu
+ * obserwator widzi zmiany na bieżąco.
+ */
+void flush_spectator_stream(void);
+
+/** @brief Kończy publikowanie zmian planszy.
+ * Zapisuje zawartość bufora i zamyka plik. Nie robi nic, jeśli zmiany nie są
+ * publikowane.
+ */
+void close_spectator_stream(void);
+
+/** @brief Obsługuje tryb obserwatora.
+ * Czyta strumień zmian z pliku lub potoku i odtwarza z niego stan gry.
+ * Jeśli standardowe wyjście jest terminalem, wyświetla planszę na bieżąco,
+ * z oknem podążającym za ostatnio zmienionym polem, a na koniec podsumowanie
+ * gry. W przeciwnym wypadku na koniec wypisuje planszę w postaci zwracanej
+ * przez @ref gamma_board. Jeśli strumień jest uszkodzony, wypisuje komunikat
+ * "ERROR n", gdzie n to numer rekordu (nagłówek ma numer 0).
+ * @param[in] path 		- ścieżka pliku lub potoku.
+ * @return Wartość 0, jeśli odtworzono cały strumień lub 1 w przeciwnym
+ * wypadku.
+ */
+int viewer_mode(const char *path);
+
+#endif /* SPECTATOR_H */
@@ -0,0 +1,252 @@
+/** @file
+ * Implementacja klasy dzielącej argumenty poleceń tekstowych na liczby.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "tokenizer.h"
+
+
+#define WORD_SIZE 8 ///< liczba znaków w jednym słowie
+
+#define ONES 0x0101010101010101ULL ///< słowo z wartością 1 w każdym bajcie
+
+#define HIGH_BITS (ONES * 0x80) ///< słowo z najstarszymi bitami bajtów
+
+#define BYTE_BITS(c) (ONES * (uint64_t)(c)) ///< słowo z bajtem @p c na każdej pozycji
+
+#define GATHER_BITS 0x0102040810204080ULL /**< mnożnik zbierający najmłodsze
+ * bity bajtów w najstarszym bajcie, bit bajtu i na pozycji i */
+
+#define MAX_DIGITS 10 ///< liczba cyfr liczby UINT32_MAX
+
+#define EIGHT_DIGITS 100000000 ///< 10 do potęgi @ref WORD_SIZE
+
+#define BASIC_LIST_CAPACITY 16 ///< początkowy rozmiar tablicy liczb z listy
+
+
+/**
+ * Stan dzielenia argumentów na liczby.
+ */
+typedef struct tokenizer {
+	uint32_t *numbers; 		///< tablica, do której są zapisywane liczby
+	size_t length; 			///< liczba zapisanych liczb
+	size_t capacity; 		///< rozmiar tablicy
+	bool growing; 			/**< informacja czy tablica jest powiększana,
+ * 							gdy się zapełni, czy liczb jest już za dużo */
+	bool overflow; 			///< informacja czy liczba przekroczyła zakres
+} tokenizer_t;
+
+
+static uint64_t load_word(const char *position, const char *end);
+
+static uint32_t byte_mask(uint64_t high_bits);
+
+static void classify(uint64_t word, uint32_t *digits, uint32_t *valid);
+
+static uint64_t convert_digits(const char *digits, int length,
+                               const char *end);
+
+static bool add_number(tokenizer_t *tokenizer, const char *start,
+                       const char *stop, const char *end);
+
+static bool tokenize(const char *arguments, const char *end,
+                     tokenizer_t *tokenizer);
+
+
+/** @brief Wczytuje słowo zaczynające się od zadanego znaku.
+ * Znak wskazywany przez @p position trafia do najmłodszego bajtu słowa,
+ * niezależnie od kolejności bajtów procesora. Pozycje za @p end są
+ * wypełniane spacjami, więc nie tworzą ani nie przedłużają liczb, a pamięć
+ * za @p end nie jest czytana, bo linijka może kończyć zmapowany plik.
+ * @param[in] position 	- wskaźnik na pierwszy znak słowa,
+ * @param[in] end 		- wskaźnik za ostatnim znakiem linijki.
+ * @return Wczytane słowo.
+ */
+uint64_t load_word(const char *position, const char *end) {
+	uint64_t word;
+	if(end - position < WORD_SIZE) {
+		word = BYTE_BITS(' ');
+		for(const char *byte = end; byte != position; byte--) {
+			word = (word << 8) | (unsigned char)byte[-1];
+		}
+		return word;
+	}
+	memcpy(&word, position, WORD_SIZE);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	word = __builtin_bswap64(word);
+#endif
+	return word;
+}
+
+/** @brief Zamienia najstarsze bity bajtów słowa na maskę bitową.
+ * @param[in] high_bits - słowo, w którym ustawione mogą być tylko najstarsze
+ * 						bity bajtów.
+ * @return Maska, w której bit i jest ustawiony, jeśli ustawiony był
+ * najstarszy bit bajtu i.
+ */
+uint32_t byte_mask(uint64_t high_bits) {
+	return (uint32_t)(((high_bits >> 7) * GATHER_BITS) >> 56);
+}
+
+/** @brief Klasyfikuje 8 znaków naraz.
+ * Dla każdego bajtu sprawdza, czy jest cyfrą lub białym znakiem (spacją albo
+ * znakiem od '\\t' do '\\r', jak funkcja isspace). Porównania są wykonywane
+ * na 7 młodszych bitach bajtów, więc dodawania nie przenoszą się między
+ * bajtami, a bajty z ustawionym najstarszym bitem nie należą do żadnej klasy.
+ * @param[in] word 		- słowo z 8 znakami,
+ * @param[out] digits 	- maska bajtów będących cyframi,
+ * @param[out] valid 	- maska bajtów będących cyframi lub białymi znakami.
+ */
+void classify(uint64_t word, uint32_t *digits, uint32_t *valid) {
+	uint64_t ascii = ~word & HIGH_BITS;
+	uint64_t low = word & ~HIGH_BITS;
+	uint64_t digit = (low + BYTE_BITS(0x80 - '0'))
+	                 & ~(low + BYTE_BITS(0x80 - '9' - 1));
+	uint64_t space = ~((low ^ BYTE_BITS(' ')) + BYTE_BITS(0x7F));
+	uint64_t control = (low + BYTE_BITS(0x80 - '\t'))
+	                   & ~(low + BYTE_BITS(0x80 - '\r' - 1));
+	digit &= ascii;
+	*digits = byte_mask(digit);
+	*valid = byte_mask((digit | space | control) & ascii);
+}
+
+/** @brief Zamienia od 1 do 8 cyfr na liczbę.
+ * Cyfry są przesuwane do najstarszych bajtów słowa, a brakujące bajty
+ * stają się wiodącymi zerami. Następnie sąsiednie cyfry są łączone
+ * w liczby dwucyfrowe, czterocyfrowe i ośmiocyfrową, trzema mnożeniami.
+ * @param[in] digits 	- wskaźnik na pierwszą cyfrę,
+ * @param[in] length 	- liczba cyfr, od 1 do @ref WORD_SIZE,
+ * @param[in] end 		- wskaźnik za ostatnim znakiem linijki.
+ * @return Wartość liczby.
+ */
+uint64_t convert_digits(const char *digits, int length, const char *end) {
+	uint64_t word = load_word(digits, end) << (8 * (WORD_SIZE - length));
+	word = ((word & BYTE_BITS(0x0F)) * (1 + (10 << 8))) >> 8;
+	word = ((word & 0x00FF00FF00FF00FFULL) * (1 + (100 << 16))) >> 16;
+	return ((word & 0x0000FFFF0000FFFFULL) * (1 + (10000ULL << 32))) >> 32;
+}
+
+/** @brief Dodaje do polecenia kolejną liczbę.
+ * Pomija wiodące zera, po 8 naraz, i sprawdza, czy liczba mieści się
+ * w zakresie typu uint32_t, zanim ją skonwertuje.
+ * @param[in,out] tokenizer 	- stan dzielenia argumentów,
+ * @param[in] start 			- wskaźnik na pierwszą cyfrę liczby,
+ * @param[in] stop 				- wskaźnik za ostatnią cyfrą liczby,
+ * @param[in] end 				- wskaźnik za ostatnim znakiem linijki.
+ * @return Wartość @p false, jeśli liczb jest za dużo, liczba występuje
+ * po liczbie przekraczającej zakres lub zabrakło pamięci albo @p true
+ * w przeciwnym wypadku.
+ */
+bool add_number(tokenizer_t *tokenizer, const char *start, const char *stop,
+                const char *end) {
+	if(tokenizer->overflow) {
+		return false;
+	}
+	if(tokenizer->length == tokenizer->capacity) {
+		if(!tokenizer->growing) {
+			return false;
+		}
+		uint32_t *numbers = realloc(tokenizer->numbers,
+		                            2 * tokenizer->capacity * sizeof(uint32_t));
+		if(numbers == NULL) {
+			return false;
+		}
+		tokenizer->numbers = numbers;
+		tokenizer->capacity *= 2;
+	}
+	while(stop - start > WORD_SIZE
+	      && load_word(start, end) == BYTE_BITS('0')) {
+		start += WORD_SIZE;
+	}
+	while(stop - start > 1 && *start == '0') {
+		start++;
+	}
+
+	int length = (int)(stop - start);
+	uint64_t value;
+	if(length > MAX_DIGITS) {
+		tokenizer->overflow = true;
+		return true;
+	}
+	else if(length > WORD_SIZE) {
+		value = convert_digits(start, length - WORD_SIZE, end) * EIGHT_DIGITS
+		        + convert_digits(stop - WORD_SIZE, WORD_SIZE, end);
+	}
+	else {
+		value = convert_digits(start, length, end);
+	}
+	if(value > UINT32_MAX) {
+		tokenizer->overflow = true;
+	}
+	else {
+		tokenizer->numbers[tokenizer->length++] = (uint32_t)value;
+	}
+	return true;
+}
+
+/** @brief Dzieli argumenty na liczby.
+ * Klasyfikuje po 8 znaków naraz i wyznacza początki oraz końce ciągów cyfr
+ * z masek cyfr, bez sprawdzania znaków po kolei.
+ * @param[in] arguments 		- wskaźnik na pierwszy znak argumentów,
+ * @param[in] end 				- wskaźnik za ostatnim znakiem linijki,
+ * @param[in,out] tokenizer 	- stan dzielenia argumentów.
+ * @return Wartość @p true, jeśli wszystkie znaki są cyframi lub białymi
+ * znakami i wszystkie liczby zostały dodane (@ref add_number) lub @p false
+ * w przeciwnym wypadku.
+ */
+bool tokenize(const char *arguments, const char *end, tokenizer_t *tokenizer) {
+	const char *number = NULL;
+	uint32_t previous = 0;
+	for(const char *word = arguments; word < end; word += WORD_SIZE) {
+		uint32_t digits, valid;
+		classify(load_word(word, end), &digits, &valid);
+		if(valid != 0xFF) {
+			return false;
+		}
+		uint32_t shifted = ((digits << 1) | previous) & 0xFF;
+		uint32_t starts = digits & ~shifted;
+		uint32_t stops = ~digits & shifted;
+		uint32_t events = starts | stops;
+		while(events != 0) {
+			int i = __builtin_ctz(events);
+			if(starts & (1u << i)) {
+				number = word + i;
+			}
+			else if(!add_number(tokenizer, number, word + i, end)) {
+				return false;
+			}
+			events &= events - 1;
+		}
+		previous = digits >> 7;
+	}
+	if(previous && !add_number(tokenizer, number, end, end)) {
+		return false;
+	}
+	return true;
+}
+
+
+bool tokenize_arguments(const char *arguments, const char *end, int max_args,
+                        command_t *command) {
+	tokenizer_t tokenizer = {command->args, 0, (size_t)max_args, false, false};
+	bool correct = tokenize(arguments, end, &tokenizer);
+	command->args_length = (int)tokenizer.length;
+	return correct;
+}
+
+bool tokenize_list(const char *arguments, const char *end, uint32_t **list,
+                   size_t *length) {
+	tokenizer_t tokenizer = {malloc(BASIC_LIST_CAPACITY * sizeof(uint32_t)), 0,
+	                         BASIC_LIST_CAPACITY, true, false};
+	if(tokenizer.numbers == NULL || !tokenize(arguments, end, &tokenizer)
+	   || tokenizer.overflow) {
+		free(tokenizer.numbers);
+		return false;
+	}
+	*list = tokenizer.numbers;
+	*length = tokenizer.length;
+	return true;
+}
@@ -0,0 +1,55 @@
+/** @file
+ * Interfejs klasy dzielącej argumenty poleceń tekstowych na liczby.
+ * Znaki linijki są klasyfikowane po 8 naraz, na 64-bitowych słowach
+ * (SWAR - SIMD within a register), a ciągi cyfr są zamieniane na liczby
+ * także po 8 cyfr naraz. Wynik jest taki sam jak przy czytaniu linijki
+ * znak po znaku za pomocą @ref read_number.
+ *
+ * @author Michał Orzyłowski <mo418334@students.mimuw.edu.pl>
+ */
+
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <stdbool.h>
+#include "auxiliary_functions.h"
+
+
+/** @brief Konwertuje argumenty polecenia.
+ * Argumenty są prawidłowe, jeśli:
+ * a) wszystkie znaki są cyframi lub białymi znakami,
+ * b) liczb jest nie więcej niż @p max_args,
+ * c) jeśli któraś liczba nie mieści się w zakresie typu uint32_t, to jest
+ * ostatnią liczbą. Nie jest ona wtedy zapisywana do @p command, więc
+ * polecenie ma o jeden argument mniej.
+ * Argumenty są czytane bezpośrednio z bufora wejścia, więc nie muszą być
+ * zakończone znakiem '\0', a funkcja nie czyta pamięci za @p end.
+ * @param[in] arguments 		- wskaźnik na pierwszy znak za nazwą polecenia,
+ * @param[in] end 				- wskaźnik za ostatnim znakiem linijki,
+ * @param[in] max_args 			- maksymalna liczba argumentów, co najwyżej
+ * 								@ref MAX_COMMAND_ARGS,
+ * @param[in,out] command 		- wskaźnik na polecenie, do którego zostają
+ * 								zapisane argumenty i ich liczba.
+ * @return Wartość @p true, jeśli argumenty są prawidłowe lub @p false
+ * w przeciwnym wypadku.
+ */
+bool tokenize_arguments(const char *arguments, const char *end, int max_args,
+                        command_t *command);
+
+/** @brief Konwertuje argumenty polecenia o dowolnej liczbie argumentów.
+ * Argumenty są prawidłowe, jeśli wszystkie znaki są cyframi lub białymi
+ * znakami, a każda liczba mieści się w zakresie typu uint32_t.
+ * @param[in] arguments 		- wskaźnik na pierwszy znak za nazwą polecenia,
+ * @param[in] end 				- wskaźnik za ostatnim znakiem linijki,
+ * @param[out] list 			- wskaźnik, pod który zostaje zapisana
+ * 								zaalokowana tablica liczb, którą należy
+ * 								zwolnić,
+ * @param[out] length 			- wskaźnik, pod który zostaje zapisana liczba
+ * 								liczb.
+ * @return Wartość @p true, jeśli argumenty są prawidłowe lub @p false, jeśli
+ * są nieprawidłowe albo zabrakło pamięci (wtedy errno ma wartość ENOMEM).
+ */
+bool tokenize_list(const char *arguments, const char *end, uint32_t **list,
+                   size_t *length);
+
+#endif /* TOKENIZER_H */